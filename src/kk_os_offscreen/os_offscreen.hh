@@ -0,0 +1,82 @@
+#pragma once
+#include "KR_kids_render.hh"
+#include <functional>
+#include <span>
+#include <cstdint>
+
+// Window-less render target: KidsRender::draw() goes to an offscreen image
+// (FBO on EGL surfaceless/pbuffer context, VkImage, CPU memory for Software),
+// frames are read back to CPU memory asynchronously.
+//
+//     for (...)
+//     {
+//         if (OsOffscreen_PendingCount(state) == frames_in_flight)
+//             OsOffscreen_Readback(state, pixels); // Oldest frame.
+//         OsOffscreen_Render(state, clear_color, render_frame);
+//     }
+//     while (OsOffscreen_Readback(state, pixels)) {}
+
+using OsOffscreen_State = void;
+using OsOffscreen_FrameCallback = std::function<void (kr::FrameInfo& frame_info)>;
+
+// Up to `frames_in_flight` frames are rendered before one has to be read back.
+// Software: rasterizes on kk::ThreadPool of its own, see OsOffscreen_WorkersCount().
+// Vulkan: pipelines are cached in `pipeline_cache_file`, if any: loaded here
+// and saved on Destroy (see kr::PipelineCache_Load()). Ignored otherwise.
+OsOffscreen_State* OsOffscreen_Create(const kk::Size& size
+    , unsigned frames_in_flight = 3
+    , const char* pipeline_cache_file = nullptr);
+void OsOffscreen_Build(OsOffscreen_State* void_state, kr::KidsRender& render);
+// Clears, calls `render_frame_callback` (that calls KidsRender::draw()) and
+// queues readback of the result. Needs a free frame: see OsOffscreen_PendingCount().
+// Returns frame's number, starting from 0.
+std::uint64_t OsOffscreen_Render(OsOffscreen_State* void_state
+    , const kk::Color& clear_color
+    , OsOffscreen_FrameCallback render_frame_callback);
+// Frames rendered, but not read back yet.
+unsigned OsOffscreen_PendingCount(OsOffscreen_State* void_state);
+// Copies the oldest pending frame to `pixels`: RGBA8, size.width * size.height,
+// top row first. Returns false if there is no pending frame or, with `wait` == false,
+// when GPU is not done with it yet.
+bool OsOffscreen_Readback(OsOffscreen_State* void_state
+    , std::span<kk::Color> pixels
+    , bool wait = true
+    , std::uint64_t* frame_number = nullptr);
+kk::Size OsOffscreen_Size(OsOffscreen_State* void_state);
+// Worker threads that draw() uses besides the calling one: 0 for GPU backends.
+unsigned OsOffscreen_WorkersCount(OsOffscreen_State* void_state);
+// Waits for the GPU, pending frames are dropped. KidsRender built with
+// this state must be destroyed before: it uses its context/device.
+void OsOffscreen_Destroy(OsOffscreen_State* void_state);
+
+// Readback results (RGBA8, top row first) to files. Return false on I/O errors.
+// PPM is binary (P6), alpha is dropped. PNG is RGBA, not compressed.
+bool Image_WritePPM(const char* file_path, const kk::Size& size, std::span<const kk::Color> pixels);
+bool Image_WritePNG(const char* file_path, const kk::Size& size, std::span<const kk::Color> pixels);
+
+struct OsOffscreen
+{
+    OsOffscreen_State* state = nullptr;
+
+    explicit OsOffscreen(const kk::Size& size
+        , unsigned frames_in_flight = 3
+        , const char* pipeline_cache_file = nullptr)
+        : state{OsOffscreen_Create(size, frames_in_flight, pipeline_cache_file)}
+    {
+    }
+
+    ~OsOffscreen()
+    {
+        if (state)
+            OsOffscreen_Destroy(state);
+    }
+
+    OsOffscreen(const OsOffscreen&) noexcept = delete;
+    OsOffscreen& operator=(const OsOffscreen&) noexcept = delete;
+    OsOffscreen& operator=(OsOffscreen&&) noexcept = delete;
+    OsOffscreen(OsOffscreen&& rhs) noexcept
+        : state(rhs.state)
+    {
+        rhs.state = nullptr;
+    }
+};
@@ -0,0 +1,142 @@
+#include "os_offscreen.hh"
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using FileHandle = std::unique_ptr<std::FILE, decltype(&std::fclose)>;
+
+static FileHandle File_Open(const char* file_path)
+{
+    return FileHandle(std::fopen(file_path, "wb"), &std::fclose);
+}
+
+static bool Image_IsValid(const kk::Size& size, std::span<const kk::Color> pixels)
+{
+    return (size.width > 0)
+        && (size.height > 0)
+        && (pixels.size() >= (std::size_t(size.width) * std::size_t(size.height)));
+}
+
+bool Image_WritePPM(const char* file_path, const kk::Size& size, std::span<const kk::Color> pixels)
+{
+    KK_VERIFY(Image_IsValid(size, pixels));
+    FileHandle file = File_Open(file_path);
+    if (!file)
+        return false;
+    std::fprintf(file.get(), "P6\n%d %d\n255\n", size.width, size.height);
+    std::vector<std::uint8_t> row(std::size_t(size.width) * 3);
+    for (int y = 0; y < size.height; ++y)
+    {
+        const kk::Color* src = &pixels[std::size_t(y) * size.width];
+        for (int x = 0; x < size.width; ++x)
+        {
+            row[3 * x + 0] = src[x].r;
+            row[3 * x + 1] = src[x].g;
+            row[3 * x + 2] = src[x].b;
+        }
+        if (std::fwrite(row.data(), 1, row.size(), file.get()) != row.size())
+            return false;
+    }
+    return (std::fflush(file.get()) == 0);
+}
+
+static std::uint32_t PNG_Crc32(std::uint32_t crc, const std::uint8_t* data, std::size_t size)
+{
+    static const auto kTable = []
+    {
+        std::vector<std::uint32_t> table(256);
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? (0xedb88320u ^ (c >> 1)) : (c >> 1);
+            table[i] = c;
+        }
+        return table;
+    }();
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i)
+        crc = (kTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8));
+    return ~crc;
+}
+
+static void PNG_PushU32(std::vector<std::uint8_t>& out, std::uint32_t v)
+{
+    out.push_back(std::uint8_t(v >> 24));
+    out.push_back(std::uint8_t(v >> 16));
+    out.push_back(std::uint8_t(v >> 8));
+    out.push_back(std::uint8_t(v));
+}
+
+static void PNG_PushChunk(std::vector<std::uint8_t>& out, const char type[4], const std::vector<std::uint8_t>& data)
+{
+    PNG_PushU32(out, std::uint32_t(data.size()));
+    const std::size_t type_offset = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    PNG_PushU32(out, PNG_Crc32(0, &out[type_offset], data.size() + 4));
+}
+
+bool Image_WritePNG(const char* file_path, const kk::Size& size, std::span<const kk::Color> pixels)
+{
+    KK_VERIFY(Image_IsValid(size, pixels));
+    // Scanlines: filter type 0 (None), followed by RGBA8 row.
+    const std::size_t row_size = (1 + std::size_t(size.width) * sizeof(kk::Color));
+    std::vector<std::uint8_t> raw(row_size * size.height);
+    for (int y = 0; y < size.height; ++y)
+    {
+        std::uint8_t* row = &raw[row_size * y];
+        row[0] = 0;
+        std::memcpy(row + 1, &pixels[std::size_t(y) * size.width], row_size - 1);
+    }
+
+    // zlib stream of "stored" (not compressed) deflate blocks.
+    static constexpr std::size_t kMaxBlock = 65535;
+    std::vector<std::uint8_t> idat;
+    idat.reserve(raw.size() + (raw.size() / kMaxBlock + 1) * 5 + 6);
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    std::uint32_t adler_a = 1;
+    std::uint32_t adler_b = 0;
+    for (std::size_t offset = 0; offset < raw.size(); offset += kMaxBlock)
+    {
+        const std::size_t block = (std::min)(kMaxBlock, raw.size() - offset);
+        const bool is_last = ((offset + block) == raw.size());
+        idat.push_back(is_last ? 1 : 0);
+        idat.push_back(std::uint8_t(block));
+        idat.push_back(std::uint8_t(block >> 8));
+        idat.push_back(std::uint8_t(~block));
+        idat.push_back(std::uint8_t(~block >> 8));
+        idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + block);
+        for (std::size_t i = offset; i < (offset + block); ++i)
+        {
+            adler_a = ((adler_a + raw[i]) % 65521);
+            adler_b = ((adler_b + adler_a) % 65521);
+        }
+    }
+    PNG_PushU32(idat, (adler_b << 16) | adler_a);
+
+    std::vector<std::uint8_t> ihdr;
+    PNG_PushU32(ihdr, std::uint32_t(size.width));
+    PNG_PushU32(ihdr, std::uint32_t(size.height));
+    ihdr.push_back(8); // Bit depth.
+    ihdr.push_back(6); // RGBA.
+    ihdr.push_back(0); // Compression.
+    ihdr.push_back(0); // Filter.
+    ihdr.push_back(0); // No interlace.
+
+    static const std::uint8_t kSignature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    std::vector<std::uint8_t> png(std::begin(kSignature), std::end(kSignature));
+    PNG_PushChunk(png, "IHDR", ihdr);
+    PNG_PushChunk(png, "IDAT", idat);
+    PNG_PushChunk(png, "IEND", {});
+
+    FileHandle file = File_Open(file_path);
+    if (!file)
+        return false;
+    return (std::fwrite(png.data(), 1, png.size(), file.get()) == png.size())
+        && (std::fflush(file.get()) == 0);
+}
@@ -0,0 +1,292 @@
+#include "os_offscreen.hh"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstring>
+
+#if (!KK_RENDER_OPENGL())
+#  error OpenGL Offscreen requires OpenGL Render (KK_RENDER_OPENGL() == 1).
+#endif
+
+static float N_(std::uint8_t c)
+{
+    return (c / 255.f);
+}
+
+static bool EGL_HasExtension(const char* extensions, const char* name)
+{
+    if (!extensions)
+        return false;
+    const std::size_t length = std::strlen(name);
+    for (const char* it = std::strstr(extensions, name); it; it = std::strstr(it + length, name))
+    {
+        const bool starts = ((it == extensions) || (it[-1] == ' '));
+        const bool ends = ((it[length] == ' ') || (it[length] == '\0'));
+        if (starts && ends)
+            return true;
+    }
+    return false;
+}
+
+// Mesa's surfaceless platform needs no window system (or GPU: llvmpipe),
+// default display is used otherwise.
+static EGLDisplay EGL_OpenDisplay()
+{
+    const char* client_extensions = ::eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (EGL_HasExtension(client_extensions, "EGL_MESA_platform_surfaceless"))
+    {
+        auto eglGetPlatformDisplayEXT_ = PFNEGLGETPLATFORMDISPLAYEXTPROC(
+            ::eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (eglGetPlatformDisplayEXT_)
+        {
+            EGLDisplay display = eglGetPlatformDisplayEXT_(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if ((display != EGL_NO_DISPLAY) && ::eglInitialize(display, nullptr, nullptr))
+                return display;
+        }
+    }
+    EGLDisplay display = ::eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    KK_VERIFY(display != EGL_NO_DISPLAY);
+    KK_VERIFY(::eglInitialize(display, nullptr, nullptr));
+    return display;
+}
+
+struct OpenGLOffscreen
+{
+    struct Frame
+    {
+        unsigned pixel_buffer = 0; // GL_PIXEL_PACK_BUFFER, filled by glReadPixels().
+        GLsync fence{};
+    };
+
+    kk::Size size_{};
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+    EGLContext context_ = EGL_NO_CONTEXT;
+    EGLSurface surface_ = EGL_NO_SURFACE; // 1x1 pbuffer, when surfaceless context is not supported.
+    // Drawn to MSAA renderbuffer, resolved to the single-sampled one to read from.
+    unsigned msaa_framebuffer_ = 0;
+    unsigned msaa_renderbuffer_ = 0;
+    unsigned resolve_framebuffer_ = 0;
+    unsigned resolve_renderbuffer_ = 0;
+    std::vector<Frame> frame_list_{};
+    std::deque<std::size_t> pending_{}; // Oldest first.
+    std::uint64_t frame_number_ = 0;
+
+    void make_current()
+    {
+        KK_VERIFY(::eglMakeCurrent(display_, surface_, surface_, context_));
+    }
+};
+
+static unsigned GL_CreateFramebuffer(unsigned& renderbuffer, const kk::Size& size, int samples)
+{
+    unsigned framebuffer = 0;
+    ::glGenRenderbuffers(1, &renderbuffer);
+    ::glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    if (samples > 1)
+        ::glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, size.width, size.height);
+    else
+        ::glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.width, size.height);
+    ::glGenFramebuffers(1, &framebuffer);
+    ::glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    ::glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+    KK_VERIFY(::glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    ::glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    return framebuffer;
+}
+
+OsOffscreen_State* OsOffscreen_Create(const kk::Size& size
+    , unsigned frames_in_flight
+    , const char* /*pipeline_cache_file*/)
+{
+    KK_VERIFY((size.width > 0) && (size.height > 0));
+    KK_VERIFY(frames_in_flight > 0);
+    OpenGLOffscreen* state = new OpenGLOffscreen{};
+    state->size_ = size;
+
+    state->display_ = EGL_OpenDisplay();
+    KK_VERIFY(::eglBindAPI(EGL_OPENGL_API));
+    const EGLint config_attributes[] =
+    {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE,
+    };
+    EGLConfig config{};
+    EGLint config_count = 0;
+    KK_VERIFY(::eglChooseConfig(state->display_, config_attributes, &config, 1, &config_count));
+    KK_VERIFY(config_count > 0);
+
+    // Same as the window's context, see OsWindow.
+    const EGLint context_attributes[] =
+    {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+    state->context_ = ::eglCreateContext(state->display_, config, EGL_NO_CONTEXT, context_attributes);
+    KK_VERIFY(state->context_ != EGL_NO_CONTEXT);
+    if (!EGL_HasExtension(::eglQueryString(state->display_, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        const EGLint pbuffer_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        state->surface_ = ::eglCreatePbufferSurface(state->display_, config, pbuffer_attributes);
+        KK_VERIFY(state->surface_ != EGL_NO_SURFACE);
+    }
+    state->make_current();
+    KK_VERIFY(::gladLoadGLLoader(GLADloadproc(::eglGetProcAddress)));
+
+    int max_samples = 0;
+    ::glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    const int samples = std::clamp(max_samples, 1, 4); // MSAA, as the window has.
+    state->msaa_framebuffer_ = GL_CreateFramebuffer(state->msaa_renderbuffer_, size, samples);
+    state->resolve_framebuffer_ = GL_CreateFramebuffer(state->resolve_renderbuffer_, size, 1);
+    ::glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    const std::size_t frame_size = (std::size_t(size.width) * std::size_t(size.height) * sizeof(kk::Color));
+    state->frame_list_.resize(frames_in_flight);
+    for (OpenGLOffscreen::Frame& frame : state->frame_list_)
+    {
+        ::glGenBuffers(1, &frame.pixel_buffer);
+        ::glBindBuffer(GL_PIXEL_PACK_BUFFER, frame.pixel_buffer);
+        ::glBufferData(GL_PIXEL_PACK_BUFFER, GLsizeiptr(frame_size), nullptr, GL_STREAM_READ);
+    }
+    ::glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    ::glEnable(GL_BLEND);
+    // Alpha as color, but source alpha is not squared: same as Software.
+    ::glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    ::glEnable(GL_MULTISAMPLE);
+    return state;
+}
+
+void OsOffscreen_Build(OsOffscreen_State* void_state, kr::KidsRender& render)
+{
+    OpenGLOffscreen& state = *static_cast<OpenGLOffscreen*>(void_state);
+    state.make_current();
+    kr::RenderData render_data{};
+    kr::KidsRender::Build(render_data, render);
+}
+
+std::uint64_t OsOffscreen_Render(OsOffscreen_State* void_state
+    , const kk::Color& clear_color
+    , OsOffscreen_FrameCallback render_frame_callback)
+{
+    OpenGLOffscreen& state = *static_cast<OpenGLOffscreen*>(void_state);
+    KK_VERIFY(state.pending_.size() < state.frame_list_.size());
+    const std::size_t slot = std::size_t(state.frame_number_ % state.frame_list_.size());
+    OpenGLOffscreen::Frame& frame = state.frame_list_[slot];
+    KK_VERIFY(!frame.fence);
+    state.make_current();
+
+    ::glBindFramebuffer(GL_FRAMEBUFFER, state.msaa_framebuffer_);
+    ::glViewport(0, 0, state.size_.width, state.size_.height);
+    ::glClearColor(N_(clear_color.r), N_(clear_color.g), N_(clear_color.b), N_(clear_color.a));
+    ::glClear(GL_COLOR_BUFFER_BIT);
+
+    kr::FrameInfo frame_info{};
+    frame_info.screen_size = state.size_;
+    render_frame_callback(frame_info);
+
+    ::glBindFramebuffer(GL_READ_FRAMEBUFFER, state.msaa_framebuffer_);
+    ::glBindFramebuffer(GL_DRAW_FRAMEBUFFER, state.resolve_framebuffer_);
+    ::glBlitFramebuffer(0, 0, state.size_.width, state.size_.height
+        , 0, 0, state.size_.width, state.size_.height
+        , GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    // Into the buffer, not client memory: returns without waiting for the GPU.
+    ::glBindFramebuffer(GL_READ_FRAMEBUFFER, state.resolve_framebuffer_);
+    ::glBindBuffer(GL_PIXEL_PACK_BUFFER, frame.pixel_buffer);
+    ::glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    ::glReadPixels(0, 0, state.size_.width, state.size_.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    ::glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    ::glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    frame.fence = ::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ::glFlush();
+
+    state.pending_.push_back(slot);
+    return state.frame_number_++;
+}
+
+unsigned OsOffscreen_PendingCount(OsOffscreen_State* void_state)
+{
+    OpenGLOffscreen& state = *static_cast<OpenGLOffscreen*>(void_state);
+    return unsigned(state.pending_.size());
+}
+
+bool OsOffscreen_Readback(OsOffscreen_State* void_state
+    , std::span<kk::Color> pixels
+    , bool wait
+    , std::uint64_t* frame_number)
+{
+    OpenGLOffscreen& state = *static_cast<OpenGLOffscreen*>(void_state);
+    if (state.pending_.empty())
+        return false;
+    const std::size_t width = std::size_t(state.size_.width);
+    const std::size_t height = std::size_t(state.size_.height);
+    KK_VERIFY(pixels.size() >= (width * height));
+    state.make_current();
+
+    OpenGLOffscreen::Frame& frame = state.frame_list_[state.pending_.front()];
+    const GLenum status = ::glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? UINT64_MAX : 0);
+    KK_VERIFY(status != GL_WAIT_FAILED);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false;
+    ::glDeleteSync(frame.fence);
+    frame.fence = {};
+
+    ::glBindBuffer(GL_PIXEL_PACK_BUFFER, frame.pixel_buffer);
+    const kk::Color* mapped = static_cast<const kk::Color*>(::glMapBufferRange(GL_PIXEL_PACK_BUFFER
+        , 0, GLsizeiptr(width * height * sizeof(kk::Color)), GL_MAP_READ_BIT));
+    KK_VERIFY(mapped);
+    for (std::size_t y = 0; y < height; ++y) // Bottom row first in GL.
+        std::memcpy(&pixels[y * width], &mapped[(height - 1 - y) * width], width * sizeof(kk::Color));
+    ::glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    ::glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (frame_number)
+        *frame_number = (state.frame_number_ - state.pending_.size());
+    state.pending_.pop_front();
+    return true;
+}
+
+kk::Size OsOffscreen_Size(OsOffscreen_State* void_state)
+{
+    return static_cast<OpenGLOffscreen*>(void_state)->size_;
+}
+
+unsigned OsOffscreen_WorkersCount(OsOffscreen_State*)
+{
+    return 0;
+}
+
+void OsOffscreen_Destroy(OsOffscreen_State* void_state)
+{
+    OpenGLOffscreen* state = static_cast<OpenGLOffscreen*>(void_state);
+    state->make_current();
+    ::glFinish();
+    for (OpenGLOffscreen::Frame& frame : state->frame_list_)
+    {
+        if (frame.fence)
+            ::glDeleteSync(frame.fence);
+        ::glDeleteBuffers(1, &frame.pixel_buffer);
+    }
+    ::glDeleteFramebuffers(1, &state->msaa_framebuffer_);
+    ::glDeleteFramebuffers(1, &state->resolve_framebuffer_);
+    ::glDeleteRenderbuffers(1, &state->msaa_renderbuffer_);
+    ::glDeleteRenderbuffers(1, &state->resolve_renderbuffer_);
+
+    ::eglMakeCurrent(state->display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (state->surface_ != EGL_NO_SURFACE)
+        ::eglDestroySurface(state->display_, state->surface_);
+    ::eglDestroyContext(state->display_, state->context_);
+    ::eglTerminate(state->display_);
+    delete state;
+}
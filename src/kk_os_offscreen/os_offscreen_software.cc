@@ -0,0 +1,103 @@
+#include "os_offscreen.hh"
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstring>
+
+#if (!KK_RENDER_SOFTWARE())
+#  error Software Offscreen requires Software Render (KK_RENDER_SOFTWARE() == 1).
+#endif
+
+// Frames are drawn to memory right away: readback is a copy.
+struct SoftwareOffscreen
+{
+    kk::Size size_{};
+    unsigned frames_in_flight_ = 0;
+    std::vector<std::vector<kk::Color>> frame_list_{};
+    std::deque<std::size_t> pending_{}; // Oldest first.
+    std::uint64_t frame_number_ = 0;
+    // Setup, binning and tiles, see kr::RenderData.
+    kk::ThreadPool thread_pool_{};
+};
+
+OsOffscreen_State* OsOffscreen_Create(const kk::Size& size
+    , unsigned frames_in_flight
+    , const char* /*pipeline_cache_file*/)
+{
+    KK_VERIFY((size.width > 0) && (size.height > 0));
+    KK_VERIFY(frames_in_flight > 0);
+    SoftwareOffscreen* state = new SoftwareOffscreen{};
+    state->size_ = size;
+    state->frames_in_flight_ = frames_in_flight;
+    state->frame_list_.resize(frames_in_flight);
+    for (std::vector<kk::Color>& pixels : state->frame_list_)
+        pixels.resize(std::size_t(size.width) * std::size_t(size.height));
+    return state;
+}
+
+void OsOffscreen_Build(OsOffscreen_State* void_state, kr::KidsRender& render)
+{
+    SoftwareOffscreen& state = *static_cast<SoftwareOffscreen*>(void_state);
+    kr::RenderData render_data{};
+    render_data.thread_pool = &state.thread_pool_;
+    kr::KidsRender::Build(render_data, render);
+}
+
+std::uint64_t OsOffscreen_Render(OsOffscreen_State* void_state
+    , const kk::Color& clear_color
+    , OsOffscreen_FrameCallback render_frame_callback)
+{
+    SoftwareOffscreen& state = *static_cast<SoftwareOffscreen*>(void_state);
+    KK_VERIFY(state.pending_.size() < state.frames_in_flight_);
+    const std::size_t slot = std::size_t(state.frame_number_ % state.frames_in_flight_);
+    std::vector<kk::Color>& pixels = state.frame_list_[slot];
+    std::fill(pixels.begin(), pixels.end(), clear_color);
+
+    kr::FrameInfo frame_info{};
+    frame_info.screen_size = state.size_;
+    frame_info.pixels = pixels.data();
+    frame_info.stride = std::size_t(state.size_.width);
+    render_frame_callback(frame_info);
+
+    state.pending_.push_back(slot);
+    return state.frame_number_++;
+}
+
+unsigned OsOffscreen_PendingCount(OsOffscreen_State* void_state)
+{
+    SoftwareOffscreen& state = *static_cast<SoftwareOffscreen*>(void_state);
+    return unsigned(state.pending_.size());
+}
+
+bool OsOffscreen_Readback(OsOffscreen_State* void_state
+    , std::span<kk::Color> pixels
+    , bool /*wait*/
+    , std::uint64_t* frame_number)
+{
+    SoftwareOffscreen& state = *static_cast<SoftwareOffscreen*>(void_state);
+    if (state.pending_.empty())
+        return false;
+    const std::vector<kk::Color>& frame = state.frame_list_[state.pending_.front()];
+    KK_VERIFY(pixels.size() >= frame.size());
+    std::memcpy(pixels.data(), frame.data(), frame.size() * sizeof(kk::Color));
+    if (frame_number)
+        *frame_number = (state.frame_number_ - state.pending_.size());
+    state.pending_.pop_front();
+    return true;
+}
+
+kk::Size OsOffscreen_Size(OsOffscreen_State* void_state)
+{
+    return static_cast<SoftwareOffscreen*>(void_state)->size_;
+}
+
+unsigned OsOffscreen_WorkersCount(OsOffscreen_State* void_state)
+{
+    return static_cast<SoftwareOffscreen*>(void_state)->thread_pool_.workers_count();
+}
+
+void OsOffscreen_Destroy(OsOffscreen_State* void_state)
+{
+    delete static_cast<SoftwareOffscreen*>(void_state);
+}
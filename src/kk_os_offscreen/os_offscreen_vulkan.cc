@@ -0,0 +1,669 @@
+#include "os_offscreen.hh"
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <algorithm>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <vulkan/vulkan.h>
+
+#if (!KK_RENDER_VULKAN())
+#  error Vulkan Offscreen requires Vulkan Render (KK_RENDER_VULKAN() == 1).
+#endif
+
+static float N_(std::uint8_t c)
+{
+    return (c / 255.f);
+}
+
+static VkBool32 vkDebugUtilsMessengerCallbackEXT_(
+    VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+    VkDebugUtilsMessageTypeFlagsEXT /*messageTypes*/,
+    const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+    void* /*pUserData*/)
+{
+    if ((messageSeverity == VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT)
+        || (messageSeverity == VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT))
+        return VK_FALSE;
+    fprintf(stderr, "[%s]: %s\n"
+        , (messageSeverity == VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) ? "Error" : "Warning"
+        , pCallbackData->pMessage);
+    fflush(stderr);
+    return VK_FALSE;
+}
+
+static void Panic_(bool condition, const char* file, unsigned line)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "Panic. %s,%u.\n", file, line);
+        fflush(stderr);
+        abort();
+    }
+}
+
+static void Panic_(VkResult vk, const char* file, unsigned line)
+{
+    if (vk != VK_SUCCESS)
+    {
+        fprintf(stderr, "Panic. VK: %#x. %s,%u.\n", unsigned(vk), file, line);
+        fflush(stderr);
+        abort();
+    }
+}
+
+#define Panic(X) Panic_((X), __FILE__, __LINE__)
+
+static const char* const kValidationLayer = "VK_LAYER_KHRONOS_validation";
+
+// Both are optional for headless runs (CI, software ICDs): used when installed.
+static bool Vulkan_HasLayer(const char* name)
+{
+    uint32_t count = 0;
+    Panic(vkEnumerateInstanceLayerProperties(&count, nullptr));
+    std::vector<VkLayerProperties> layers{std::size_t(count)};
+    Panic(vkEnumerateInstanceLayerProperties(&count, layers.data()));
+    return std::any_of(layers.begin(), layers.end()
+        , [name](const VkLayerProperties& layer) { return (strcmp(layer.layerName, name) == 0); });
+}
+
+static bool Vulkan_HasInstanceExtension(const char* name)
+{
+    uint32_t count = 0;
+    Panic(vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr));
+    std::vector<VkExtensionProperties> extensions{std::size_t(count)};
+    Panic(vkEnumerateInstanceExtensionProperties(nullptr, &count, extensions.data()));
+    return std::any_of(extensions.begin(), extensions.end()
+        , [name](const VkExtensionProperties& extension) { return (strcmp(extension.extensionName, name) == 0); });
+}
+
+static uint32_t Vulkan_FindMemory(VkPhysicalDevice physical_device
+    , uint32_t type_bits
+    , VkMemoryPropertyFlags properties)
+{
+    VkPhysicalDeviceMemoryProperties mem_properties{};
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
+    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; ++i)
+    {
+        if ((type_bits & (1 << i))
+            && ((mem_properties.memoryTypes[i].propertyFlags & properties) == properties))
+            return i;
+    }
+    Panic(false);
+    return uint32_t(-1);
+}
+
+static VkDeviceMemory Vulkan_AllocateMemory(VkPhysicalDevice physical_device
+    , VkDevice device
+    , const VkMemoryRequirements& mem_requirements
+    , VkMemoryPropertyFlags properties)
+{
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_requirements.size;
+    alloc_info.memoryTypeIndex = Vulkan_FindMemory(physical_device, mem_requirements.memoryTypeBits, properties);
+    VkDeviceMemory memory{};
+    Panic(vkAllocateMemory(device, &alloc_info, nullptr, &memory));
+    return memory;
+}
+
+static const VkFormat kImageFormat = VK_FORMAT_R8G8B8A8_UNORM; // Same as kk::Color.
+
+struct VulkanOffscreen
+{
+    // Rendered image is resolved to `image_` and copied to `readback_buffer_`
+    // by the same command buffer; `fence_` is signaled when the copy is done.
+    struct Frame
+    {
+        VkImage image_{};
+        VkDeviceMemory image_memory_{};
+        VkImageView image_view_{};
+        VkFramebuffer framebuffer_{};
+        VkBuffer readback_buffer_{};
+        VkDeviceMemory readback_memory_{};
+        const kk::Color* readback_pixels_ = nullptr; // Persistently mapped.
+        VkCommandBuffer command_buffer_{};
+        VkFence fence_{};
+    };
+
+    kk::Size size_{};
+    VkInstance vk_instance_{};
+    VkDebugUtilsMessengerEXT vk_debug_msg_{};
+    VkPhysicalDevice physical_device_{};
+    uint32_t graphics_family_index_{uint32_t(-1)};
+    VkDevice device_{};
+    VkQueue graphics_queue_{};
+    bool gpu_timestamps_ = false;
+    VkCommandPool command_pool_{};
+    VkDescriptorPool descriptor_pool_{};
+    VkPipelineCache pipeline_cache_{};
+    std::string pipeline_cache_file_{}; // Empty: not saved.
+    VkRenderPass render_pass_{};
+    VkSampleCountFlagBits msaa_samples_ = VK_SAMPLE_COUNT_1_BIT;
+    // Shared by all frames: only used inside the render pass.
+    VkImage msaa_image_{};
+    VkDeviceMemory msaa_image_memory_{};
+    VkImageView msaa_image_view_{};
+    std::vector<Frame> frame_list_{};
+    std::deque<uint32_t> pending_{}; // Oldest first.
+    std::uint64_t frame_number_ = 0;
+    uint32_t current_frame_ = 0;
+
+    void create_instance()
+    {
+        VkApplicationInfo app_info{};
+        app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        app_info.pApplicationName = "offscreen";
+        app_info.applicationVersion = VK_MAKE_VERSION(0, 0, 1);
+        app_info.pEngineName = "playground";
+        app_info.engineVersion = VK_MAKE_VERSION(0, 0, 1);
+        app_info.apiVersion = VK_API_VERSION_1_3;
+
+        VkDebugUtilsMessengerCreateInfoEXT debug_info{};
+        debug_info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+        debug_info.messageSeverity =
+              VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT
+            | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+        debug_info.messageType =
+              VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT
+            | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT
+            | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+        debug_info.pfnUserCallback = &vkDebugUtilsMessengerCallbackEXT_;
+
+        const bool debug = Vulkan_HasInstanceExtension(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        const bool validation = Vulkan_HasLayer(kValidationLayer);
+        const char* const debug_extension = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
+
+        VkInstanceCreateInfo create_info{};
+        create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        create_info.pNext = debug ? &debug_info : nullptr;
+        create_info.pApplicationInfo = &app_info;
+        create_info.enabledLayerCount = validation ? 1 : 0;
+        create_info.ppEnabledLayerNames = &kValidationLayer;
+        create_info.enabledExtensionCount = debug ? 1 : 0;
+        create_info.ppEnabledExtensionNames = &debug_extension;
+        Panic(vkCreateInstance(&create_info, nullptr/*Allocator*/, &vk_instance_));
+
+        if (debug)
+        {
+            auto vkCreateDebugUtilsMessengerEXT_ = PFN_vkCreateDebugUtilsMessengerEXT(vkGetInstanceProcAddr(
+                vk_instance_, "vkCreateDebugUtilsMessengerEXT"));
+            Panic(vkCreateDebugUtilsMessengerEXT_(vk_instance_, &debug_info, nullptr/*Allocator*/, &vk_debug_msg_));
+        }
+    }
+
+    // Discrete, integrated, anything else (CPU implementations).
+    void pick_GPU()
+    {
+        uint32_t device_count = 0;
+        Panic(vkEnumeratePhysicalDevices(vk_instance_, &device_count, nullptr));
+        Panic(device_count > 0);
+        std::vector<VkPhysicalDevice> devices{std::size_t(device_count)};
+        Panic(vkEnumeratePhysicalDevices(vk_instance_, &device_count, devices.data()));
+
+        auto device_rank = [](VkPhysicalDevice physical_device)
+        {
+            VkPhysicalDeviceProperties properties{};
+            vkGetPhysicalDeviceProperties(physical_device, &properties);
+            switch (properties.deviceType)
+            {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 0;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 1;
+            default: return 2;
+            }
+        };
+        physical_device_ = *std::min_element(devices.begin(), devices.end()
+            , [&](VkPhysicalDevice lhs, VkPhysicalDevice rhs) { return (device_rank(lhs) < device_rank(rhs)); });
+    }
+
+    void create_logical_device()
+    {
+        uint32_t family_count = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &family_count, nullptr);
+        std::vector<VkQueueFamilyProperties> families{std::size_t(family_count)};
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &family_count, families.data());
+        auto graphics_it = std::find_if(std::begin(families), std::end(families)
+            , [](const VkQueueFamilyProperties& family_info)
+        {
+            return (family_info.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+        });
+        Panic(graphics_it != std::end(families));
+        graphics_family_index_ = uint32_t(std::distance(std::begin(families), graphics_it));
+
+        VkDeviceQueueCreateInfo queue_info{};
+        queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queue_info.queueFamilyIndex = graphics_family_index_;
+        queue_info.queueCount = 1;
+        const float priority = 1.f;
+        queue_info.pQueuePriorities = &priority;
+
+        VkPhysicalDeviceFeatures device_features{};
+        // Timestamp queries are reset from host since KidsRender
+        // records them inside the render pass.
+        VkPhysicalDeviceHostQueryResetFeatures host_query_reset{};
+        host_query_reset.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES;
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &host_query_reset;
+        vkGetPhysicalDeviceFeatures2(physical_device_, &features2);
+        gpu_timestamps_ = (host_query_reset.hostQueryReset == VK_TRUE)
+            && (graphics_it->timestampValidBits > 0);
+        host_query_reset.hostQueryReset = (gpu_timestamps_ ? VK_TRUE : VK_FALSE);
+        VkDeviceCreateInfo device_info{};
+        device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        device_info.pNext = &host_query_reset;
+        device_info.queueCreateInfoCount = 1;
+        device_info.pQueueCreateInfos = &queue_info;
+        device_info.pEnabledFeatures = &device_features; // No swapchain.
+        Panic(vkCreateDevice(physical_device_, &device_info, nullptr/*Allocator*/, &device_));
+
+        vkGetDeviceQueue(device_, graphics_family_index_, 0, &graphics_queue_);
+    }
+
+    void create_pools()
+    {
+        VkCommandPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        pool_info.queueFamilyIndex = graphics_family_index_;
+        Panic(vkCreateCommandPool(device_, &pool_info, nullptr, &command_pool_));
+
+        VkDescriptorPoolSize descriptor_pool_size[] =
+        {
+            {VK_DESCRIPTOR_TYPE_SAMPLER, 1024},
+            {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1024},
+        };
+        VkDescriptorPoolCreateInfo descriptor_pool_info{};
+        descriptor_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptor_pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        descriptor_pool_info.poolSizeCount = static_cast<uint32_t>(std::size(descriptor_pool_size));
+        descriptor_pool_info.maxSets = 1024;
+        descriptor_pool_info.pPoolSizes = descriptor_pool_size;
+        Panic(vkCreateDescriptorPool(device_, &descriptor_pool_info, nullptr, &descriptor_pool_));
+    }
+
+    // As OsRender's window, but capped to 4x: that is what GL backend gets, too.
+    VkSampleCountFlagBits sample_count() const
+    {
+        VkPhysicalDeviceProperties p{};
+        vkGetPhysicalDeviceProperties(physical_device_, &p);
+        const VkSampleCountFlags counts = p.limits.framebufferColorSampleCounts;
+        if (counts & VK_SAMPLE_COUNT_4_BIT) { return VK_SAMPLE_COUNT_4_BIT; }
+        if (counts & VK_SAMPLE_COUNT_2_BIT) { return VK_SAMPLE_COUNT_2_BIT; }
+        return VK_SAMPLE_COUNT_1_BIT;
+    }
+
+    bool has_msaa() const
+    {
+        return (msaa_samples_ != VK_SAMPLE_COUNT_1_BIT);
+    }
+
+    // Single-sampled attachment ends up in TRANSFER_SRC_OPTIMAL, ready for the copy.
+    void create_render_pass()
+    {
+        VkAttachmentDescription color_attachment{};
+        color_attachment.format = kImageFormat;
+        color_attachment.samples = msaa_samples_;
+        color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        color_attachment.storeOp = has_msaa() ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+        color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        color_attachment.finalLayout = has_msaa()
+            ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+            : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        VkAttachmentDescription color_attachment_resolve{};
+        color_attachment_resolve.format = kImageFormat;
+        color_attachment_resolve.samples = VK_SAMPLE_COUNT_1_BIT;
+        color_attachment_resolve.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        color_attachment_resolve.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        color_attachment_resolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        color_attachment_resolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        color_attachment_resolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        color_attachment_resolve.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        VkAttachmentReference color_attachment_ref{};
+        color_attachment_ref.attachment = 0;
+        color_attachment_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        VkAttachmentReference color_attachment_resolve_ref{};
+        color_attachment_resolve_ref.attachment = 1;
+        color_attachment_resolve_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &color_attachment_ref;
+        subpass.pResolveAttachments = has_msaa() ? &color_attachment_resolve_ref : nullptr;
+
+        VkSubpassDependency dependencies[2]{};
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass = 0;
+        // Previous frames: the shared MSAA image and a copy from the same image.
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[1].srcSubpass = 0;
+        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        VkAttachmentDescription attachments[] = {color_attachment, color_attachment_resolve};
+        VkRenderPassCreateInfo render_pass_info{};
+        render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        render_pass_info.attachmentCount = has_msaa() ? 2 : 1;
+        render_pass_info.pAttachments = attachments;
+        render_pass_info.subpassCount = 1;
+        render_pass_info.pSubpasses = &subpass;
+        render_pass_info.dependencyCount = uint32_t(std::size(dependencies));
+        render_pass_info.pDependencies = dependencies;
+        Panic(vkCreateRenderPass(device_, &render_pass_info, nullptr/*Allocator*/, &render_pass_));
+    }
+
+    void create_image(VkSampleCountFlagBits samples, VkImageUsageFlags usage
+        , VkImage& image, VkDeviceMemory& memory, VkImageView& view)
+    {
+        VkImageCreateInfo image_info{};
+        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_info.imageType = VK_IMAGE_TYPE_2D;
+        image_info.extent.width = uint32_t(size_.width);
+        image_info.extent.height = uint32_t(size_.height);
+        image_info.extent.depth = 1;
+        image_info.mipLevels = 1;
+        image_info.arrayLayers = 1;
+        image_info.format = kImageFormat;
+        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        image_info.usage = usage;
+        image_info.samples = samples;
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        Panic(vkCreateImage(device_, &image_info, nullptr, &image));
+
+        VkMemoryRequirements mem_requirements{};
+        vkGetImageMemoryRequirements(device_, image, &mem_requirements);
+        memory = Vulkan_AllocateMemory(physical_device_, device_, mem_requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        Panic(vkBindImageMemory(device_, image, memory, 0));
+
+        VkImageViewCreateInfo view_info{};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.image = image;
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = kImageFormat;
+        view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        view_info.subresourceRange.baseMipLevel = 0;
+        view_info.subresourceRange.levelCount = 1;
+        view_info.subresourceRange.baseArrayLayer = 0;
+        view_info.subresourceRange.layerCount = 1;
+        Panic(vkCreateImageView(device_, &view_info, nullptr, &view));
+    }
+
+    void create_frame(Frame& frame)
+    {
+        create_image(VK_SAMPLE_COUNT_1_BIT
+            , VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+            , frame.image_, frame.image_memory_, frame.image_view_);
+
+        const VkImageView attachments[] = {has_msaa() ? msaa_image_view_ : frame.image_view_, frame.image_view_};
+        VkFramebufferCreateInfo framebuffer_info{};
+        framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebuffer_info.renderPass = render_pass_;
+        framebuffer_info.attachmentCount = has_msaa() ? 2 : 1;
+        framebuffer_info.pAttachments = attachments;
+        framebuffer_info.width = uint32_t(size_.width);
+        framebuffer_info.height = uint32_t(size_.height);
+        framebuffer_info.layers = 1;
+        Panic(vkCreateFramebuffer(device_, &framebuffer_info, nullptr, &frame.framebuffer_));
+
+        VkBufferCreateInfo buffer_info{};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = VkDeviceSize(size_.width) * VkDeviceSize(size_.height) * sizeof(kk::Color);
+        buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        Panic(vkCreateBuffer(device_, &buffer_info, nullptr, &frame.readback_buffer_));
+        VkMemoryRequirements mem_requirements{};
+        vkGetBufferMemoryRequirements(device_, frame.readback_buffer_, &mem_requirements);
+        frame.readback_memory_ = Vulkan_AllocateMemory(physical_device_, device_, mem_requirements
+            , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        Panic(vkBindBufferMemory(device_, frame.readback_buffer_, frame.readback_memory_, 0));
+        void* mapped = nullptr;
+        Panic(vkMapMemory(device_, frame.readback_memory_, 0, VK_WHOLE_SIZE, 0, &mapped));
+        frame.readback_pixels_ = static_cast<const kk::Color*>(mapped);
+
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = command_pool_;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+        Panic(vkAllocateCommandBuffers(device_, &alloc_info, &frame.command_buffer_));
+
+        VkFenceCreateInfo fence_info{};
+        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        Panic(vkCreateFence(device_, &fence_info, nullptr, &frame.fence_));
+    }
+
+    void destroy_frame(Frame& frame)
+    {
+        vkDestroyFence(device_, frame.fence_, nullptr);
+        vkFreeCommandBuffers(device_, command_pool_, 1, &frame.command_buffer_);
+        vkUnmapMemory(device_, frame.readback_memory_);
+        vkDestroyBuffer(device_, frame.readback_buffer_, nullptr);
+        vkFreeMemory(device_, frame.readback_memory_, nullptr);
+        vkDestroyFramebuffer(device_, frame.framebuffer_, nullptr);
+        vkDestroyImageView(device_, frame.image_view_, nullptr);
+        vkDestroyImage(device_, frame.image_, nullptr);
+        vkFreeMemory(device_, frame.image_memory_, nullptr);
+    }
+};
+
+OsOffscreen_State* OsOffscreen_Create(const kk::Size& size
+    , unsigned frames_in_flight
+    , const char* pipeline_cache_file)
+{
+    KK_VERIFY((size.width > 0) && (size.height > 0));
+    KK_VERIFY(frames_in_flight > 0);
+    VulkanOffscreen* state = new VulkanOffscreen{};
+    state->size_ = size;
+    state->create_instance();
+    state->pick_GPU();
+    state->create_logical_device();
+    state->create_pools();
+    state->pipeline_cache_file_ = (pipeline_cache_file ? pipeline_cache_file : "");
+    state->pipeline_cache_ = kr::PipelineCache_Load(state->physical_device_, state->device_, pipeline_cache_file);
+
+    state->msaa_samples_ = state->sample_count();
+    state->create_render_pass();
+    if (state->has_msaa())
+    {
+        state->create_image(state->msaa_samples_
+            , VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+            , state->msaa_image_, state->msaa_image_memory_, state->msaa_image_view_);
+    }
+    state->frame_list_.resize(frames_in_flight);
+    for (VulkanOffscreen::Frame& frame : state->frame_list_)
+        state->create_frame(frame);
+    return state;
+}
+
+void OsOffscreen_Build(OsOffscreen_State* void_state, kr::KidsRender& render)
+{
+    VulkanOffscreen& state = *static_cast<VulkanOffscreen*>(void_state);
+    kr::RenderData render_data;
+    render_data.physical_device = state.physical_device_;
+    render_data.device = state.device_;
+    render_data.render_pass = state.render_pass_;
+    render_data.frames_in_flight = std::uint32_t(state.frame_list_.size());
+    render_data.msaa_samples = state.msaa_samples_;
+    render_data.gpu_timestamps = state.gpu_timestamps_;
+    render_data.pipeline_cache = state.pipeline_cache_;
+    render_data.work_queue = state.graphics_queue_;
+    render_data.work_command_pool = state.command_pool_;
+    render_data.descriptor_pool = state.descriptor_pool_;
+    render_data.current_frame_ = [void_state]()
+    {
+        return static_cast<VulkanOffscreen*>(void_state)->current_frame_;
+    };
+    kr::KidsRender::Build(render_data, render);
+}
+
+std::uint64_t OsOffscreen_Render(OsOffscreen_State* void_state
+    , const kk::Color& clear_color
+    , OsOffscreen_FrameCallback render_frame_callback)
+{
+    VulkanOffscreen& state = *static_cast<VulkanOffscreen*>(void_state);
+    KK_VERIFY(state.pending_.size() < state.frame_list_.size());
+    state.current_frame_ = uint32_t(state.frame_number_ % state.frame_list_.size());
+    VulkanOffscreen::Frame& frame = state.frame_list_[state.current_frame_];
+    // Free slot was read back already; the fence is signaled.
+    Panic(vkResetFences(state.device_, 1, &frame.fence_));
+
+    VkCommandBuffer cmd_buffer = frame.command_buffer_;
+    Panic(vkResetCommandBuffer(cmd_buffer, 0));
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    Panic(vkBeginCommandBuffer(cmd_buffer, &begin_info));
+
+    VkRenderPassBeginInfo render_pass_begin_info{};
+    render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    render_pass_begin_info.renderPass = state.render_pass_;
+    render_pass_begin_info.framebuffer = frame.framebuffer_;
+    render_pass_begin_info.renderArea.extent = VkExtent2D{uint32_t(state.size_.width), uint32_t(state.size_.height)};
+    render_pass_begin_info.renderArea.offset = VkOffset2D{0, 0};
+    VkClearValue vk_clear_color{{{N_(clear_color.r), N_(clear_color.g), N_(clear_color.b), N_(clear_color.a)}}};
+    render_pass_begin_info.clearValueCount = 1;
+    render_pass_begin_info.pClearValues = &vk_clear_color;
+    vkCmdBeginRenderPass(cmd_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+    kr::FrameInfo frame_info;
+    frame_info.screen_size = state.size_;
+    frame_info.command_buffer = cmd_buffer;
+    frame_info.frame_index = state.current_frame_;
+    render_frame_callback(frame_info);
+
+    vkCmdEndRenderPass(cmd_buffer);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0; // Tightly packed, top row first.
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {uint32_t(state.size_.width), uint32_t(state.size_.height), 1};
+    vkCmdCopyImageToBuffer(cmd_buffer, frame.image_, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+        , frame.readback_buffer_, 1, &region);
+
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = frame.readback_buffer_;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(cmd_buffer
+        , VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT
+        , 0, 0, nullptr, 1, &barrier, 0, nullptr);
+    Panic(vkEndCommandBuffer(cmd_buffer));
+
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &cmd_buffer;
+    Panic(vkQueueSubmit(state.graphics_queue_, 1, &submit_info, frame.fence_));
+
+    state.pending_.push_back(state.current_frame_);
+    return state.frame_number_++;
+}
+
+unsigned OsOffscreen_PendingCount(OsOffscreen_State* void_state)
+{
+    VulkanOffscreen& state = *static_cast<VulkanOffscreen*>(void_state);
+    return unsigned(state.pending_.size());
+}
+
+bool OsOffscreen_Readback(OsOffscreen_State* void_state
+    , std::span<kk::Color> pixels
+    , bool wait
+    , std::uint64_t* frame_number)
+{
+    VulkanOffscreen& state = *static_cast<VulkanOffscreen*>(void_state);
+    if (state.pending_.empty())
+        return false;
+    const std::size_t pixels_count = (std::size_t(state.size_.width) * std::size_t(state.size_.height));
+    KK_VERIFY(pixels.size() >= pixels_count);
+
+    VulkanOffscreen::Frame& frame = state.frame_list_[state.pending_.front()];
+    if (wait)
+    {
+        Panic(vkWaitForFences(state.device_, 1, &frame.fence_, VK_TRUE, UINT64_MAX));
+    }
+    else
+    {
+        const VkResult status = vkGetFenceStatus(state.device_, frame.fence_);
+        if (status == VK_NOT_READY)
+            return false;
+        Panic(status);
+    }
+    std::memcpy(pixels.data(), frame.readback_pixels_, pixels_count * sizeof(kk::Color));
+
+    if (frame_number)
+        *frame_number = (state.frame_number_ - state.pending_.size());
+    state.pending_.pop_front();
+    return true;
+}
+
+kk::Size OsOffscreen_Size(OsOffscreen_State* void_state)
+{
+    return static_cast<VulkanOffscreen*>(void_state)->size_;
+}
+
+unsigned OsOffscreen_WorkersCount(OsOffscreen_State*)
+{
+    return 0;
+}
+
+void OsOffscreen_Destroy(OsOffscreen_State* void_state)
+{
+    VulkanOffscreen& state = *static_cast<VulkanOffscreen*>(void_state);
+    Panic(vkDeviceWaitIdle(state.device_));
+
+    for (VulkanOffscreen::Frame& frame : state.frame_list_)
+        state.destroy_frame(frame);
+    state.frame_list_.clear();
+    if (state.has_msaa())
+    {
+        vkDestroyImageView(state.device_, state.msaa_image_view_, nullptr);
+        vkDestroyImage(state.device_, state.msaa_image_, nullptr);
+        vkFreeMemory(state.device_, state.msaa_image_memory_, nullptr);
+    }
+    vkDestroyRenderPass(state.device_, state.render_pass_, nullptr);
+    if (!state.pipeline_cache_file_.empty()
+        && !kr::PipelineCache_Save(state.device_, state.pipeline_cache_, state.pipeline_cache_file_.c_str()))
+    {
+        fprintf(stderr, "Failed to save pipeline cache to '%s'.\n", state.pipeline_cache_file_.c_str());
+    }
+    vkDestroyPipelineCache(state.device_, state.pipeline_cache_, nullptr);
+    vkDestroyDescriptorPool(state.device_, state.descriptor_pool_, nullptr);
+    vkDestroyCommandPool(state.device_, state.command_pool_, nullptr);
+    vkDestroyDevice(state.device_, nullptr);
+    if (state.vk_debug_msg_)
+    {
+        auto vkDestroyDebugUtilsMessengerEXT_ = PFN_vkDestroyDebugUtilsMessengerEXT(vkGetInstanceProcAddr(
+            state.vk_instance_, "vkDestroyDebugUtilsMessengerEXT"));
+        vkDestroyDebugUtilsMessengerEXT_(state.vk_instance_, state.vk_debug_msg_, nullptr);
+    }
+    vkDestroyInstance(state.vk_instance_, nullptr);
+    delete &state;
+}
@@ -15,7 +15,11 @@ class OsWindow;
 using OsRender_State = void;
 using OsRender_NewFrameCallback = std::function<void (OsWindow& window, kr::FrameInfo& frame_info)>;
 
-OsRender_State* OsRender_Create();
+// Frames CPU may record ahead of GPU (Vulkan; OpenGL driver decides itself).
+// More hide GPU stalls, fewer give lower input-to-screen latency.
+inline constexpr unsigned kOsRender_DefaultFramesInFlight = 2;
+
+OsRender_State* OsRender_Create(unsigned frames_in_flight = kOsRender_DefaultFramesInFlight);
 void OsRender_WindowCreate(OsRender_State* void_state, OsWindow& window);
 void OsRender_Build(OsRender_State* void_state, OsWindow& window, kr::KidsRender& render);
 void OsRender_NewFrame(OsRender_State* void_state
@@ -31,8 +35,8 @@ struct OsRender
 {
     OsRender_State* state = nullptr;
 
-    OsRender()
-        : state{OsRender_Create()}
+    explicit OsRender(unsigned frames_in_flight = kOsRender_DefaultFramesInFlight)
+        : state{OsRender_Create(frames_in_flight)}
     {
     }
 
@@ -107,7 +107,7 @@ static void GL_SetContext(OsWindow& window)
 #endif
 }
 
-OsRender_State* OsRender_Create()
+OsRender_State* OsRender_Create(unsigned /*frames_in_flight*/)
 {
     static int no_state;
     return &no_state;
@@ -127,7 +127,8 @@ void OsRender_WindowCreate(OsRender_State*, OsWindow& window)
     }
 
     ::glEnable(GL_BLEND);
-    ::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Alpha as color, but source alpha is not squared: same as Software.
+    ::glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     ::glEnable(GL_MULTISAMPLE);
 }
 
@@ -105,6 +105,9 @@ static const char* const kEnabledLogicalExtensions[] =
     VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 };
 
+// Next to the executable's working directory; see kr::PipelineCache_Load().
+static const char* const kPipelineCacheFile = "kr_pipeline_cache.bin";
+
 static const char* const kEnabledLayers[] =
 {
     "VK_LAYER_KHRONOS_validation",
@@ -121,8 +124,6 @@ static const char* const kEnabledPhysExtensions[] =
 
 #define KK_REQUIRE(C) Panic(C)
 
-const std::size_t k_MaxFramesInFlight = 2;
-
 struct VulkanWindow
 {
     VkSurfaceKHR surface_{};
@@ -138,8 +139,11 @@ struct VulkanWindow
     std::vector<VkSemaphore> semaphores_image_available{};
     std::vector<VkSemaphore> semaphores_render_finished{};
     std::vector<VkFence> in_flight_fences{};
+    // Per swapchain image: fence of the in-flight slot that renders to it.
+    std::vector<VkFence> image_fences_{};
 
-    uint32_t current_frame = 0;
+    uint32_t frames_in_flight_ = 0;
+    uint32_t current_frame = 0; // In-flight slot, [0, frames_in_flight_).
     uint32_t image_index = 0;
     int old_width = 0;
     int old_height = 0;
@@ -423,6 +427,7 @@ struct VulkanWindow
                 , nullptr
                 , &framebuffers_.back()));
         }
+        image_fences_.assign(framebuffers_.size(), VK_NULL_HANDLE);
     }
 
     void cleanup_swap_chain(VkDevice device)
@@ -444,6 +449,7 @@ struct VulkanWindow
         image_format_ = VK_FORMAT_UNDEFINED;
         image_extent_.width = uint32_t(-1);
         framebuffers_.clear();
+        image_fences_.clear();
         render_pass_ = {};
         swapchain_image_views_.clear();
         swapchain_images_.clear();
@@ -484,10 +490,13 @@ struct VulkanWindow
         , VkInstance vk_instance
         , VkPhysicalDevice physical_device
         , VkDevice device
-        , VkCommandPool command_pool)
+        , VkCommandPool command_pool
+        , uint32_t frames_in_flight)
     {
         Panic(!window_);
+        Panic(frames_in_flight > 0);
         window_ = &window;
+        frames_in_flight_ = frames_in_flight;
 
 #if (KK_WINDOW_WIN32())
         VkWin32SurfaceCreateInfoKHR surface_info{};
@@ -509,7 +518,7 @@ struct VulkanWindow
         create_color_resources(physical_device, device);
         create_frame_buffers(device);
 
-        command_buffers.resize(framebuffers_.size());
+        command_buffers.resize(frames_in_flight_);
 
         VkCommandBufferAllocateInfo alloc_info{};
         alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -529,10 +538,10 @@ struct VulkanWindow
         fence_info.pNext = nullptr;
         fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-        semaphores_image_available.resize(k_MaxFramesInFlight);
-        semaphores_render_finished.resize(k_MaxFramesInFlight);
-        in_flight_fences.resize(k_MaxFramesInFlight);
-        for (std::size_t i = 0; i < k_MaxFramesInFlight; ++i)
+        semaphores_image_available.resize(frames_in_flight_);
+        semaphores_render_finished.resize(frames_in_flight_);
+        in_flight_fences.resize(frames_in_flight_);
+        for (std::size_t i = 0; i < frames_in_flight_; ++i)
         {
             Panic(vkCreateSemaphore(device, &semaphore_info, nullptr, &semaphores_image_available[i]));
             Panic(vkCreateSemaphore(device, &semaphore_info, nullptr, &semaphores_render_finished[i]));
@@ -568,9 +577,13 @@ struct VulkanState
     uint32_t graphics_family_index_{uint32_t(-1)};
     VkDevice device_{};
     VkQueue graphics_queue_{};
+    bool gpu_timestamps_ = false;
+    uint32_t frames_in_flight_ = 0; // Of every window.
 
     VkDescriptorPool descriptor_pool{};
     VkCommandPool command_pool{};
+    // Shared by all windows.
+    VkPipelineCache pipeline_cache{};
     VkDebugUtilsMessengerEXT vk_debug_msg{};
 
     void pick_GPU()
@@ -633,10 +646,21 @@ struct VulkanState
         queue_info.pQueuePriorities = &priority;
 
         VkPhysicalDeviceFeatures device_features{};
+        // Timestamp queries are reset from host since KidsRender
+        // records them inside the render pass.
+        VkPhysicalDeviceHostQueryResetFeatures host_query_reset{};
+        host_query_reset.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES;
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &host_query_reset;
+        vkGetPhysicalDeviceFeatures2(physical_device_, &features2);
+        gpu_timestamps_ = (host_query_reset.hostQueryReset == VK_TRUE)
+            && (graphics_it->timestampValidBits > 0);
+        host_query_reset.hostQueryReset = (gpu_timestamps_ ? VK_TRUE : VK_FALSE);
 
         VkDeviceCreateInfo device_info{};
         device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        device_info.pNext = nullptr;
+        device_info.pNext = &host_query_reset;
         device_info.flags = 0;
         device_info.queueCreateInfoCount = 1;
         device_info.pQueueCreateInfos = &queue_info;
@@ -664,10 +688,12 @@ struct VulkanState
     }
 };
 
-OsRender_State* OsRender_Create()
+OsRender_State* OsRender_Create(unsigned frames_in_flight)
 {
+    Panic(frames_in_flight > 0);
     OsRender_State* void_state = new VulkanState{};
     VulkanState& vulkan_app = *static_cast<VulkanState*>(void_state);
+    vulkan_app.frames_in_flight_ = uint32_t(frames_in_flight);
 
     VkApplicationInfo app_info{};
     app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -762,6 +788,9 @@ OsRender_State* OsRender_Create()
     descriptor_pool_info.pPoolSizes = descriptor_pool_size;
     Panic(vkCreateDescriptorPool(vulkan_app.device_, &descriptor_pool_info, nullptr, &vulkan_app.descriptor_pool));
 
+    vulkan_app.pipeline_cache = kr::PipelineCache_Load(vulkan_app.physical_device_
+        , vulkan_app.device_
+        , kPipelineCacheFile);
     return void_state;
 }
 
@@ -774,7 +803,8 @@ void OsRender_WindowCreate(OsRender_State* void_state, OsWindow& window)
         , vulkan_app.vk_instance_
         , vulkan_app.physical_device_
         , vulkan_app.device_
-        , vulkan_app.command_pool);
+        , vulkan_app.command_pool
+        , vulkan_app.frames_in_flight_);
 }
 
 void OsRender_WindowDestroy(OsRender_State* void_state, OsWindow& window)
@@ -803,8 +833,10 @@ void OsRender_Build(OsRender_State* void_state, OsWindow& window, kr::KidsRender
     render_data.physical_device = vulkan_app.physical_device_;
     render_data.device = vulkan_app.device_;
     render_data.render_pass = vulkan_w.render_pass_;
-    render_data.image_count = std::uint32_t(vulkan_w.framebuffers_.size());
+    render_data.frames_in_flight = vulkan_w.frames_in_flight_;
     render_data.msaa_samples = vulkan_w.msaa_samples_;
+    render_data.gpu_timestamps = vulkan_app.gpu_timestamps_;
+    render_data.pipeline_cache = vulkan_app.pipeline_cache;
     render_data.work_queue = vulkan_app.graphics_queue_;
     render_data.work_command_pool = vulkan_app.command_pool;
     render_data.descriptor_pool = vulkan_app.descriptor_pool;
@@ -845,6 +877,12 @@ void OsRender_NewFrame(OsRender_State* void_state
     default:
         Panic(ok);
     }
+    // Image may still be rendered to by other slot: with more frames
+    // in flight than swapchain images or when acquired out of order.
+    VkFence& image_fence = vulkan_w.image_fences_[vulkan_w.image_index];
+    if (image_fence)
+        Panic(vkWaitForFences(vulkan_app.device_, 1, &image_fence, VK_TRUE, UINT64_MAX));
+    image_fence = vulkan_w.in_flight_fences[vulkan_w.current_frame];
     Panic(vkResetFences(vulkan_app.device_, 1, &vulkan_w.in_flight_fences[vulkan_w.current_frame]));
 
     // Record command buffer.
@@ -931,7 +969,7 @@ void OsRender_Present(OsRender_State* void_state, OsWindow& window)
     if (recreate)
         vulkan_w.recreate_swap_chain(window, vulkan_app.physical_device_, vulkan_app.device_);
 
-    vulkan_w.current_frame = ((vulkan_w.current_frame + 1) % k_MaxFramesInFlight);
+    vulkan_w.current_frame = ((vulkan_w.current_frame + 1) % vulkan_w.frames_in_flight_);
 }
 
 void OsRender_Finish(OsRender_State* void_state)
@@ -947,6 +985,9 @@ void OsRender_Destroy(OsRender_State* void_state)
     for (VulkanWindow& vulkan_w : vulkan_app.all_windows_)
         vulkan_w.cleanup(vulkan_app.vk_instance_, vulkan_app.device_);
     vulkan_app.all_windows_.clear();
+    if (!kr::PipelineCache_Save(vulkan_app.device_, vulkan_app.pipeline_cache, kPipelineCacheFile))
+        fprintf(stderr, "Failed to save pipeline cache to '%s'.\n", kPipelineCacheFile);
+    vkDestroyPipelineCache(vulkan_app.device_, vulkan_app.pipeline_cache, nullptr);
     vkDestroyDescriptorPool(vulkan_app.device_, vulkan_app.descriptor_pool, nullptr);
     vkDestroyCommandPool(vulkan_app.device_, vulkan_app.command_pool, nullptr);
     vkDestroyDevice(vulkan_app.device_, nullptr);
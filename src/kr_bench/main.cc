@@ -0,0 +1,886 @@
+#include "KR_vertex_kernels.hh"
+#include "KR_kids_UTF8_text.hh"
+#include "KR_kids_font.hh"
+#include "KR_kids_font_fallback.hh"
+#include "KR_kids_render.hh"
+#include "KR_text_shaper.hh"
+
+#if (KR_BENCH_BUILD_HEADLESS == 1)
+#  define KR_BENCH_HEADLESS() 1
+#  include "os_offscreen.hh"
+#else
+#  define KR_BENCH_HEADLESS() 0
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Repeatable benchmarks of the text and render pipeline:
+//
+//     kr_bench [--format=text|json|csv] [--out=<file>] [--filter=<substring>]
+//              [--min-time-ms=200] [--repetitions=5]
+//              [--font=<ttf>] [--font-cjk=<ttf>] [--size=<width>x<height>]
+//              [--pipeline-cache=kr_bench_pipeline.cache] [--frames-in-flight=3]
+//
+// Every benchmark runs `repetitions` times, each for at least `min-time-ms`;
+// median is reported. Exceptions are measured once: render_build is startup,
+// cold (pipeline cache file removed first) and warm (file of the cold run);
+// only Vulkan has a pipeline cache. frame_throughput and frame_latency sweep
+// 1..4 frames in flight; other render benchmarks use `frames-in-flight`.
+// Inputs are generated with fixed seeds. Benchmarks that
+// need KidsRender::Build() run on a headless context (see kk_os_offscreen)
+// and are not compiled in when there is none. The run fails (exit code 1)
+// when FrameStats of a known frame are not exact, see Bench_CheckFrameStats(),
+// clip culling of merged DrawCmds is wrong, see Bench_CheckMergeClip(),
+// or texture batching allocates per frame, see Bench_CheckTextureBatching().
+
+enum class Bench_Format
+{
+    Text,
+    JSON,
+    CSV,
+};
+
+struct Bench_Options
+{
+    Bench_Format format = Bench_Format::Text;
+    const char* output_path = nullptr; // stdout when null.
+    const char* filter = nullptr;
+    int min_time_ms = 200;
+    int repetitions = 5;
+    const char* font_path = nullptr;
+    const char* font_cjk_path = nullptr;
+    kk::Size size{1280, 720};
+    const char* pipeline_cache_path = "kr_bench_pipeline.cache";
+    unsigned frames_in_flight = 3;
+};
+
+struct Bench_Result
+{
+    std::string name;
+    std::string params;
+    std::size_t items = 0; // Per run.
+    std::size_t runs = 0;  // Of the median repetition.
+    double ns_per_run = 0;
+    double items_per_second = 0;
+};
+
+// Keeps results of the benchmarked code alive.
+static volatile std::uint64_t g_Bench_Sink = 0;
+
+static void Bench_Sink(std::uint64_t value)
+{
+    g_Bench_Sink = (g_Bench_Sink + value);
+}
+
+struct Bench_Suite
+{
+    Bench_Options options;
+    std::vector<Bench_Result> results;
+    // Render's worker threads, see OsOffscreen_WorkersCount().
+    unsigned workers_count = 0;
+
+    bool is_enabled(const std::string& name, const std::string& params) const
+    {
+        if (!options.filter)
+            return true;
+        return ((name + "/" + params).find(options.filter) != std::string::npos);
+    }
+
+    template<typename F>
+    void run(const std::string& name, const std::string& params, std::size_t items, F&& f)
+    {
+        if (!is_enabled(name, params))
+            return;
+        using Clock = std::chrono::steady_clock;
+        f(); // Warm-up: caches, font pages, GPU buffers.
+
+        struct Repetition
+        {
+            double ns_per_run = 0;
+            std::size_t runs = 0;
+        };
+        std::vector<Repetition> repetitions;
+        for (int i = 0; i < (std::max)(options.repetitions, 1); ++i)
+        {
+            std::size_t runs = 0;
+            const Clock::time_point start = Clock::now();
+            Clock::duration elapsed{};
+            do
+            {
+                f();
+                ++runs;
+                elapsed = (Clock::now() - start);
+            }
+            while (elapsed < std::chrono::milliseconds(options.min_time_ms));
+            const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+            repetitions.push_back(Repetition{ns / double(runs), runs});
+        }
+        std::sort(repetitions.begin(), repetitions.end()
+            , [](const Repetition& lhs, const Repetition& rhs) { return (lhs.ns_per_run < rhs.ns_per_run); });
+        const Repetition& median = repetitions[repetitions.size() / 2];
+
+        add(name, params, items, median.runs, median.ns_per_run);
+    }
+
+    void add(const std::string& name, const std::string& params, std::size_t items, std::size_t runs, double ns_per_run)
+    {
+        Bench_Result result;
+        result.name = name;
+        result.params = params;
+        result.items = items;
+        result.runs = runs;
+        result.ns_per_run = ns_per_run;
+        result.items_per_second = (double(items) * 1e9 / ns_per_run);
+        // Progress goes to stderr: stdout may be JSON/CSV.
+        std::fprintf(stderr, "%s/%s: %.0f ns\n", name.c_str(), params.c_str(), result.ns_per_run);
+        results.push_back(std::move(result));
+    }
+};
+
+static const char* Bench_BackendName()
+{
+#if (KK_RENDER_OPENGL())
+    return "OpenGL";
+#elif (KK_RENDER_VULKAN())
+    return "Vulkan";
+#else
+    return "Software";
+#endif
+}
+
+// Names and params are identifiers: no escaping needed.
+static void Bench_WriteJSON(std::FILE* file, const Bench_Suite& suite)
+{
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"context\": {\"backend\": \"%s\", \"simd\": \"%s\", \"workers\": %u, \"repetitions\": %d, \"min_time_ms\": %d},\n"
+        , Bench_BackendName()
+        , kr::Simd_LevelName(kr::Simd_BestLevel())
+        , suite.workers_count
+        , suite.options.repetitions
+        , suite.options.min_time_ms);
+    std::fprintf(file, "  \"benchmarks\": [\n");
+    for (std::size_t i = 0; i < suite.results.size(); ++i)
+    {
+        const Bench_Result& r = suite.results[i];
+        std::fprintf(file, "    {\"name\": \"%s\", \"params\": \"%s\", \"items\": %zu, \"runs\": %zu"
+            ", \"ns_per_run\": %.1f, \"items_per_second\": %.1f}%s\n"
+            , r.name.c_str(), r.params.c_str(), r.items, r.runs
+            , r.ns_per_run, r.items_per_second
+            , ((i + 1) < suite.results.size()) ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+}
+
+static void Bench_WriteCSV(std::FILE* file, const Bench_Suite& suite)
+{
+    std::fprintf(file, "name,params,items,runs,ns_per_run,items_per_second\n");
+    for (const Bench_Result& r : suite.results)
+    {
+        std::fprintf(file, "%s,%s,%zu,%zu,%.1f,%.1f\n"
+            , r.name.c_str(), r.params.c_str(), r.items, r.runs
+            , r.ns_per_run, r.items_per_second);
+    }
+}
+
+static void Bench_WriteText(std::FILE* file, const Bench_Suite& suite)
+{
+    std::fprintf(file, "Backend: %s, SIMD: %s, Workers: %u\n"
+        , Bench_BackendName(), kr::Simd_LevelName(kr::Simd_BestLevel()), suite.workers_count);
+    std::fprintf(file, "%-40s %14s %14s %10s\n", "Benchmark", "ns/run", "M items/s", "items");
+    for (const Bench_Result& r : suite.results)
+    {
+        const std::string name = (r.name + "/" + r.params);
+        std::fprintf(file, "%-40s %14.0f %14.3f %10zu\n"
+            , name.c_str(), r.ns_per_run, r.items_per_second / 1e6, r.items);
+    }
+}
+
+// Corpora.
+
+struct Bench_Corpus
+{
+    const char* name = nullptr;
+    std::string text;
+};
+
+static void UTF8_Append(std::string& text, std::uint32_t code_point)
+{
+    if (code_point < 0x80)
+    {
+        text.push_back(char(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        text.push_back(char(0xc0 | (code_point >> 6)));
+        text.push_back(char(0x80 | (code_point & 0x3f)));
+    }
+    else if (code_point < 0x10000)
+    {
+        text.push_back(char(0xe0 | (code_point >> 12)));
+        text.push_back(char(0x80 | ((code_point >> 6) & 0x3f)));
+        text.push_back(char(0x80 | (code_point & 0x3f)));
+    }
+    else
+    {
+        text.push_back(char(0xf0 | (code_point >> 18)));
+        text.push_back(char(0x80 | ((code_point >> 12) & 0x3f)));
+        text.push_back(char(0x80 | ((code_point >> 6) & 0x3f)));
+        text.push_back(char(0x80 | (code_point & 0x3f)));
+    }
+}
+
+// Words of [min, max] code points from `ranges`, ~80 bytes lines.
+static std::string Corpus_Generate(std::size_t bytes
+    , std::initializer_list<std::pair<std::uint32_t, std::uint32_t>> ranges
+    , std::uint32_t seed)
+{
+    std::mt19937 rng{seed};
+    const std::vector<std::pair<std::uint32_t, std::uint32_t>> range_list{ranges};
+    std::string text;
+    std::size_t line_start = 0;
+    while (text.size() < bytes)
+    {
+        const auto& range = range_list[rng() % range_list.size()];
+        const std::size_t word_length = (2 + rng() % 8);
+        for (std::size_t i = 0; i < word_length; ++i)
+            UTF8_Append(text, range.first + std::uint32_t(rng() % (range.second - range.first + 1)));
+        if ((text.size() - line_start) > 80)
+        {
+            text.push_back('\n');
+            line_start = text.size();
+        }
+        else
+        {
+            text.push_back(' ');
+        }
+    }
+    return text;
+}
+
+static std::vector<Bench_Corpus> Corpus_All(std::size_t bytes)
+{
+    const std::pair<std::uint32_t, std::uint32_t> kLatin{'a', 'z'};
+    const std::pair<std::uint32_t, std::uint32_t> kCyrillic{0x430, 0x44f};
+    const std::pair<std::uint32_t, std::uint32_t> kCJK{0x4e00, 0x4fff};
+    std::vector<Bench_Corpus> corpora;
+    corpora.push_back({"ascii", Corpus_Generate(bytes, {kLatin}, 1)});
+    corpora.push_back({"cjk", Corpus_Generate(bytes, {kCJK}, 2)});
+    corpora.push_back({"mixed", Corpus_Generate(bytes, {kLatin, kCyrillic, kCJK}, 3)});
+    return corpora;
+}
+
+static kr::Text_UTF8 Corpus_UTF8(const Bench_Corpus& corpus)
+{
+    return kr::Text_UTF8{corpus.text.data(), corpus.text.data() + corpus.text.size()};
+}
+
+static const char* File_FirstExisting(std::initializer_list<const char*> paths)
+{
+    for (const char* path : paths)
+    {
+        if (std::FILE* file = std::fopen(path, "rb"))
+        {
+            std::fclose(file);
+            return path;
+        }
+    }
+    return nullptr;
+}
+
+// Benchmarks.
+
+static void Bench_UTF8(Bench_Suite& suite)
+{
+    for (const Bench_Corpus& corpus : Corpus_All(256 * 1024))
+    {
+        suite.run("utf8_decode", corpus.name, corpus.text.size(), [&]()
+        {
+            const char* it = corpus.text.data();
+            const char* const end = (it + corpus.text.size());
+            std::uint64_t sum = 0;
+            while (it < end)
+            {
+                std::uint32_t code_point = 0;
+                it += kr::UTF8_Decode(&code_point, it, end);
+                sum += code_point;
+            }
+            Bench_Sink(sum);
+        });
+        suite.run("utf8_iterate_lines", corpus.name, corpus.text.size(), [&]()
+        {
+            std::uint64_t sum = 0;
+            kr::UTF8_IterateLines(Corpus_UTF8(corpus), [&](const kr::LineCodepointMeta& meta)
+            {
+                sum += meta.codepoint;
+            }
+            , false/*use_crlf*/);
+            Bench_Sink(sum);
+        });
+    }
+}
+
+static void Bench_VertexKernels(Bench_Suite& suite)
+{
+    // Typical text block: a few thousands of glyph quads.
+    constexpr std::size_t kVertices = 16 * 1024;
+    constexpr std::size_t kIndices = (kVertices / 4) * 6;
+
+    std::vector<kr::Vertex> src_vertices(kVertices);
+    std::vector<kr::Vertex> dst_vertices(kVertices);
+    for (std::size_t i = 0; i < kVertices; ++i)
+    {
+        src_vertices[i].p_ = kk::Vec2f{float(i % 1024), float(i / 1024)};
+        src_vertices[i].c_ = kk::Color_White();
+    }
+    std::vector<kr::Index> src_indices(kIndices);
+    std::vector<kr::Index> dst_indices(kIndices);
+    for (std::size_t i = 0; i < kIndices; ++i)
+        src_indices[i] = kr::Index(i);
+
+    const kr::SimdLevel best = kr::Simd_BestLevel();
+    for (kr::SimdLevel level : {kr::SimdLevel::Scalar, kr::SimdLevel::SSE2, kr::SimdLevel::AVX2})
+    {
+        if (level > best)
+            continue;
+        suite.run("vertices_translate", kr::Simd_LevelName(level), kVertices, [&]()
+        {
+            kr::Vertices_Translate(dst_vertices.data(), src_vertices.data(), kVertices
+                , kk::Vec2f{1.5f, -2.5f}, level);
+        });
+        suite.run("indices_rebase", kr::Simd_LevelName(level), kIndices, [&]()
+        {
+            kr::Indices_Rebase(dst_indices.data(), src_indices.data(), kIndices
+                , kr::Index(17), level);
+        });
+    }
+}
+
+// Glyph rasterization and atlas fill: no textures are created.
+static void Bench_FontPages(Bench_Suite& suite, kr::Font_FreeTypeLibrary& font_lib, const char* font_path)
+{
+    if (!font_path)
+        return;
+    const kr::ImageFactory_RGBA no_image = [](int, int, const void*) { return kr::ImageRef{}; };
+    kr::Font font = kr::Font::FromFile(font_lib, no_image, font_path, kr::Font_Size::Pixels(16));
+    // ASCII page is created by set_size(); plus Latin-1, Greek, Cyrillic.
+    const std::uint32_t kPageCodePoints[] = {0xe0, 0x3b1, 0x430};
+    int size_px = 16;
+    suite.run("font_pages", "16px_x4", 1 + std::size(kPageCodePoints), [&]()
+    {
+        size_px = ((size_px == 16) ? 17 : 16); // Same size is a no-op.
+        font.set_size(kr::Font_Size::Pixels(size_px));
+        for (std::uint32_t code_point : kPageCodePoints)
+            Bench_Sink(font.glyph_info(code_point).glyph_index);
+    });
+}
+
+#if (KR_BENCH_HEADLESS())
+// Self-check of what draw() records, before anything is measured: a frame
+// of known DrawCmds must give exact FrameStats counters.
+// The same retained image (clip, scale, texture) is drawn kRepeats times,
+// then one image with other clip, scale and texture.
+// Returns false (and prints why) on mismatch.
+static bool Bench_CheckFrameStats()
+{
+    const kk::Size size{64, 64};
+    OsOffscreen offscreen{size, 1};
+    kr::KidsRender render; // Destroyed before `offscreen`.
+    OsOffscreen_Build(offscreen.state, render);
+    std::vector<kk::Color> pixels(std::size_t(size.width) * std::size_t(size.height));
+
+    const unsigned red = 0xff0000ff;
+    const unsigned green = 0xff00ff00;
+    const kr::ImageRef texture_a = kr::ImageRef::FromMemory(render, kr::ImageRef::Format::RGBA, 1, 1, &red);
+    const kr::ImageRef texture_b = kr::ImageRef::FromMemory(render, kr::ImageRef::Format::RGBA, 1, 1, &green);
+    kr::CmdList cmd_list;
+    render.image(texture_a, kk::Point2f{4.f, 4.f}, kk::Point2f{20.f, 20.f}
+        , kk::Vec2f{0.f, 0.f}, kk::Vec2f{1.f, 1.f}, kk::Color_White()
+        , kk::Vec2f{1.f, 1.f}, {}, &cmd_list);
+    kr::RetainedCmdList retained{render};
+    retained.set(std::move(cmd_list));
+
+    constexpr std::size_t kRepeats = 8;
+    render.clear();
+    for (std::size_t i = 0; i < kRepeats; ++i)
+        render.draw_retained(retained);
+    render.image(texture_b, kk::Point2f{4.f, 4.f}, kk::Point2f{12.f, 12.f}
+        , kk::Vec2f{0.f, 0.f}, kk::Vec2f{1.f, 1.f}, kk::Color_White()
+        , kk::Vec2f{2.f, 2.f}, kr::ClipRect{kk::Rect2f{0.f, 0.f, 16.f, 16.f}});
+    OsOffscreen_Render(offscreen.state, kk::Color{0, 0, 0, 255}, [&](kr::FrameInfo& frame_info)
+    {
+        render.draw(frame_info);
+    });
+    while (OsOffscreen_Readback(offscreen.state, pixels)) {}
+    const kr::FrameStats& stats = render.frame_stats();
+
+    // Every counter is bumped once by the 1st DrawCmd and once by the last.
+    kr::FrameStats expected;
+    expected.draw_cmds = (kRepeats + 1);
+#if (KK_RENDER_VULKAN())
+    // Pipeline, viewport, push constants and retained vertex buffer;
+    // then push constants (scale) and stream vertex buffer.
+    expected.state_changes = 6;
+    expected.scissor_changes = 2;
+    expected.texture_binds = 2;
+#elif (KK_RENDER_OPENGL())
+    expected.scissor_changes = 2;
+    expected.texture_binds = 2;
+#endif
+
+    struct Counter
+    {
+        const char* name;
+        std::size_t value;
+        std::size_t expected;
+    };
+    const Counter counter_list[] =
+    {
+        {"draw_cmds", stats.draw_cmds, expected.draw_cmds},
+        {"state_changes", stats.state_changes, expected.state_changes},
+        {"scissor_changes", stats.scissor_changes, expected.scissor_changes},
+        {"texture_binds", stats.texture_binds, expected.texture_binds},
+    };
+    bool ok = true;
+    for (const Counter& counter : counter_list)
+    {
+        if (counter.value == counter.expected)
+            continue;
+        std::fprintf(stderr, "Self-check failed: FrameStats::%s is %zu, expected %zu.\n"
+            , counter.name, counter.value, counter.expected);
+        ok = false;
+    }
+    return ok;
+}
+
+// Self-check of clip culling in merge_cmd_lists*() for DrawCmds made by hand,
+// without DrawCmd::bounds_: the one within its clip stays, the one outside
+// is culled. Returns false (and prints why) on mismatch.
+static bool Bench_CheckMergeClip()
+{
+    OsOffscreen offscreen{kk::Size{64, 64}, 1};
+    kr::KidsRender render; // Destroyed before `offscreen`.
+    OsOffscreen_Build(offscreen.state, render);
+
+    const kr::ClipRect clip_rect{kk::Rect2f{0.f, 0.f, 16.f, 16.f}};
+    kr::CmdList hand_made;
+    auto add_rect = [&](float x, float y)
+    {
+        kr::DrawCmd& cmd = hand_made.draw_list_.emplace_back();
+        cmd.texture_ = render.white_1x1_;
+        cmd.clip_rect_ = clip_rect;
+        cmd.vertex_offset_ = unsigned(hand_made.vertex_list_.size());
+        cmd.vertex_count_ = 4;
+        cmd.index_offset_ = unsigned(hand_made.index_list_.size());
+        cmd.index_count_ = 6;
+        const kk::Point2f corners[] = {{x, y}, {x, y + 8.f}, {x + 8.f, y + 8.f}, {x + 8.f, y}};
+        for (const kk::Point2f& p : corners)
+            hand_made.vertex_list_.push_back(kr::Vertex{p, kk::Vec2f{}, kk::Color_White()});
+        for (kr::Index i : {0, 1, 2, 2, 3, 0})
+            hand_made.index_list_.push_back(i);
+    };
+    add_rect(4.f, 4.f);   // Within the clip.
+    add_rect(40.f, 40.f); // Outside.
+
+    kk::ThreadPool thread_pool{1};
+    kr::CmdList merged;
+    kr::CmdList merged_parallel;
+    const kr::CmdList* const cmd_lists[] = {&hand_made};
+    render.merge_cmd_lists(hand_made, nullptr, nullptr, &merged);
+    render.merge_cmd_lists_parallel(cmd_lists, thread_pool, nullptr, nullptr, &merged_parallel);
+
+    bool ok = true;
+    for (const kr::CmdList* cmd_list : {&merged, &merged_parallel})
+    {
+        const char* name = (cmd_list == &merged) ? "merge_cmd_lists" : "merge_cmd_lists_parallel";
+        if ((cmd_list->draw_list_.size() != 1) || (cmd_list->culled_.draw_cmds != 1))
+        {
+            std::fprintf(stderr, "Self-check failed: %s() kept %zu and culled %zu DrawCmds, expected 1 and 1.\n"
+                , name, cmd_list->draw_list_.size(), cmd_list->culled_.draw_cmds);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Self-check of set_texture_batching(): two images with other textures are
+// one DrawCmd (but on Software). Vulkan allocates the batch descriptor set
+// in the 1st frame only, together with sets of textures (and white_1x1);
+// the next frames reuse it. Returns false (and prints why) on mismatch.
+static bool Bench_CheckTextureBatching()
+{
+    const kk::Size size{64, 64};
+    OsOffscreen offscreen{size, 1};
+    kr::KidsRender render; // Destroyed before `offscreen`.
+    OsOffscreen_Build(offscreen.state, render);
+    render.set_texture_batching(true);
+    std::vector<kk::Color> pixels(std::size_t(size.width) * std::size_t(size.height));
+
+    const unsigned red = 0xff0000ff;
+    const unsigned green = 0xff00ff00;
+    const kr::ImageRef texture_a = kr::ImageRef::FromMemory(render, kr::ImageRef::Format::RGBA, 1, 1, &red);
+    const kr::ImageRef texture_b = kr::ImageRef::FromMemory(render, kr::ImageRef::Format::RGBA, 1, 1, &green);
+
+#if (KK_RENDER_SOFTWARE())
+    const std::size_t expected_draw_cmds = 2;
+#else
+    const std::size_t expected_draw_cmds = 1;
+#endif
+#if (KK_RENDER_VULKAN())
+    const std::size_t expected_allocated = 4; // white_1x1, 2 textures, batch.
+#else
+    const std::size_t expected_allocated = 0;
+#endif
+    bool ok = true;
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        render.clear();
+        render.image(texture_a, kk::Point2f{4.f, 4.f}, kk::Point2f{12.f, 12.f}
+            , kk::Vec2f{0.f, 0.f}, kk::Vec2f{1.f, 1.f}, kk::Color_White());
+        render.image(texture_b, kk::Point2f{20.f, 4.f}, kk::Point2f{28.f, 12.f}
+            , kk::Vec2f{0.f, 0.f}, kk::Vec2f{1.f, 1.f}, kk::Color_White());
+        OsOffscreen_Render(offscreen.state, kk::Color{0, 0, 0, 255}, [&](kr::FrameInfo& frame_info)
+        {
+            render.draw(frame_info);
+        });
+        while (OsOffscreen_Readback(offscreen.state, pixels)) {}
+        const kr::FrameStats& stats = render.frame_stats();
+        const std::size_t allocated = ((frame == 0) ? expected_allocated : 0);
+        if ((stats.draw_cmds != expected_draw_cmds) || (stats.descriptor_sets_allocated != allocated))
+        {
+            std::fprintf(stderr, "Self-check failed: frame %d with texture batching has %zu DrawCmds"
+                " and %zu descriptor sets allocated, expected %zu and %zu.\n"
+                , frame, stats.draw_cmds, stats.descriptor_sets_allocated, expected_draw_cmds, allocated);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// KidsRender::Build() on a new context: shaders and pipelines are compiled.
+static void Bench_RenderBuild(Bench_Suite& suite)
+{
+    using Clock = std::chrono::steady_clock;
+    const char* const cache_path = suite.options.pipeline_cache_path;
+    for (const char* params : {"cold", "warm"})
+    {
+        if (!suite.is_enabled("render_build", params))
+            continue;
+        if (std::strcmp(params, "cold") == 0)
+            std::remove(cache_path);
+        OsOffscreen offscreen{kk::Size{64, 64}, 1, cache_path}; // Saves the cache.
+        kr::KidsRender render;
+        const Clock::time_point start = Clock::now();
+        OsOffscreen_Build(offscreen.state, render);
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        suite.add("render_build", params, 1, 1, ns);
+    }
+}
+
+// Same frame (10k rects) with 1..4 frames in flight: frame_throughput is
+// ns per frame, frame_latency is median ns from OsOffscreen_Render()
+// to readback of that very frame.
+static void Bench_FramesInFlight(Bench_Suite& suite)
+{
+    using Clock = std::chrono::steady_clock;
+    const kk::Size size = suite.options.size;
+    const std::string size_str = (std::to_string(size.width) + "x" + std::to_string(size.height));
+    for (unsigned frames_in_flight = 1; frames_in_flight <= 4; ++frames_in_flight)
+    {
+        const std::string params = ("fif" + std::to_string(frames_in_flight) + "_" + size_str);
+        if (!suite.is_enabled("frame_throughput", params) && !suite.is_enabled("frame_latency", params))
+            continue;
+        OsOffscreen offscreen{size, frames_in_flight};
+        kr::KidsRender render; // Destroyed before `offscreen`.
+        OsOffscreen_Build(offscreen.state, render);
+        std::vector<kk::Color> pixels(std::size_t(size.width) * std::size_t(size.height));
+
+        std::mt19937 rng{4};
+        for (std::size_t i = 0; i < 10'000; ++i)
+        {
+            const kk::Point2f p_min{float(rng() % size.width), float(rng() % size.height)};
+            const kk::Point2f p_max{p_min.x + float(4 + rng() % 64), p_min.y + float(4 + rng() % 64)};
+            render.rect_fill(p_min, p_max, kk::Color{std::uint8_t(rng()), std::uint8_t(rng()), std::uint8_t(rng()), 255});
+        }
+
+        std::vector<Clock::time_point> start_list; // By frame number.
+        std::vector<double> latency_list;
+        auto read_oldest = [&]()
+        {
+            std::uint64_t frame_number = 0;
+            KK_VERIFY(OsOffscreen_Readback(offscreen.state, pixels, true/*wait*/, &frame_number));
+            latency_list.push_back(std::chrono::duration<double, std::nano>(
+                Clock::now() - start_list[std::size_t(frame_number)]).count());
+        };
+        auto draw_frame = [&]()
+        {
+            if (OsOffscreen_PendingCount(offscreen.state) == frames_in_flight)
+                read_oldest();
+            start_list.push_back(Clock::now());
+            OsOffscreen_Render(offscreen.state, kk::Color{0, 0, 0, 255}, [&](kr::FrameInfo& frame_info)
+            {
+                render.draw(frame_info);
+            });
+        };
+        auto read_all = [&]()
+        {
+            while (OsOffscreen_PendingCount(offscreen.state) > 0)
+                read_oldest();
+        };
+
+        // Warm-up: GPU buffers of every slot.
+        for (unsigned i = 0; i < (2 * frames_in_flight); ++i)
+            draw_frame();
+        read_all();
+        latency_list.clear();
+
+        std::size_t frames = 0;
+        const Clock::time_point start = Clock::now();
+        do
+        {
+            draw_frame();
+            ++frames;
+        }
+        while ((Clock::now() - start) < std::chrono::milliseconds(suite.options.min_time_ms));
+        read_all();
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        std::sort(latency_list.begin(), latency_list.end());
+        suite.add("frame_throughput", params, 1, frames, (ns / double(frames)));
+        suite.add("frame_latency", params, 1, latency_list.size(), latency_list[latency_list.size() / 2]);
+        Bench_Sink(pixels[0].r);
+    }
+}
+
+static void Bench_Render(Bench_Suite& suite
+    , kr::Font_FreeTypeLibrary& font_lib
+    , const char* font_path
+    , const char* font_cjk_path)
+{
+    const kk::Size size = suite.options.size;
+    const unsigned frames_in_flight = suite.options.frames_in_flight;
+    OsOffscreen offscreen{size, frames_in_flight};
+    suite.workers_count = OsOffscreen_WorkersCount(offscreen.state);
+    kr::KidsRender render; // Destroyed before `offscreen`.
+    OsOffscreen_Build(offscreen.state, render);
+    std::vector<kk::Color> pixels(std::size_t(size.width) * std::size_t(size.height));
+    const std::string size_str = (std::to_string(size.width) + "x" + std::to_string(size.height));
+
+    std::mt19937 rng{4};
+    auto random_rect = [&](kk::Point2f& p_min, kk::Point2f& p_max, kk::Color& color)
+    {
+        p_min = kk::Point2f{float(rng() % size.width), float(rng() % size.height)};
+        p_max = kk::Point2f{p_min.x + float(4 + rng() % 64), p_min.y + float(4 + rng() % 64)};
+        color = kk::Color{std::uint8_t(rng()), std::uint8_t(rng()), std::uint8_t(rng()), std::uint8_t(64 + rng() % 192)};
+    };
+
+    // AddVertices() through the public API.
+    constexpr std::size_t kRects = 10'000;
+    std::vector<std::pair<kk::Point2f, kk::Point2f>> rect_list(kRects);
+    std::vector<kk::Color> color_list(kRects);
+    for (std::size_t i = 0; i < kRects; ++i)
+        random_rect(rect_list[i].first, rect_list[i].second, color_list[i]);
+    suite.run("cmd_list_rect_fill", "10k", kRects, [&]()
+    {
+        render.clear();
+        for (std::size_t i = 0; i < kRects; ++i)
+            render.rect_fill(rect_list[i].first, rect_list[i].second, color_list[i]);
+        Bench_Sink(render.cmd_list_.vertex_list_.size());
+    });
+
+    // 16 widgets worth of CmdLists into the frame.
+    std::vector<kr::CmdList> widget_list(16);
+    for (std::size_t i = 0; i < kRects; ++i)
+    {
+        render.rect_fill(rect_list[i].first, rect_list[i].second, color_list[i]
+            , kk::Vec2f{1.f, 1.f}, {}, &widget_list[i % widget_list.size()]);
+    }
+    std::size_t widget_vertices = 0;
+    for (const kr::CmdList& widget : widget_list)
+        widget_vertices += widget.vertex_list_.size();
+    const kk::Point2f translate_by{3.f, 5.f};
+    suite.run("merge_cmd_lists", "16x625", widget_vertices, [&]()
+    {
+        render.clear();
+        for (const kr::CmdList& widget : widget_list)
+            render.merge_cmd_lists(widget, &translate_by);
+        Bench_Sink(render.cmd_list_.vertex_list_.size());
+    });
+
+    auto draw_frame = [&]()
+    {
+        if (OsOffscreen_PendingCount(offscreen.state) == frames_in_flight)
+            OsOffscreen_Readback(offscreen.state, pixels);
+        OsOffscreen_Render(offscreen.state, kk::Color{0, 0, 0, 255}, [&](kr::FrameInfo& frame_info)
+        {
+            render.draw(frame_info);
+        });
+    };
+
+    render.clear();
+    for (std::size_t i = 0; i < kRects; ++i)
+        render.rect_fill(rect_list[i].first, rect_list[i].second, color_list[i]);
+    suite.run("draw_rects", "10k_" + size_str, kRects, draw_frame);
+    while (OsOffscreen_Readback(offscreen.state, pixels)) {}
+
+    if (!font_path)
+        return;
+    kr::Font_Fallback font_fallback;
+    font_fallback.set_main_font(kr::Font_FromFile(font_lib, render, font_path, kr::Font_Size::Pixels(16)));
+    if (font_cjk_path)
+        font_fallback.add_font_as_fallback(kr::Font_FromFile(font_lib, render, font_cjk_path, kr::Font_Size::Pixels(16)));
+    kr::Text_Markup markup;
+    markup.font_fallback_ = &font_fallback;
+    const char* const fallback_str = (font_cjk_path ? "" : "_no_fallback");
+
+    for (const Bench_Corpus& corpus : Corpus_All(16 * 1024))
+    {
+        suite.run("text_shape", std::string(corpus.name) + fallback_str, corpus.text.size(), [&]()
+        {
+            kr::Text_Shaper shaper;
+            shaper.render_ = &render;
+            shaper.wrap_width_ = size.width;
+            shaper.text_add(Corpus_UTF8(corpus), markup);
+            shaper.finish();
+            Bench_Sink(shaper.glyph_cmd_list_.vertex_list_.size());
+        });
+    }
+
+    // A screen of text.
+    kr::Text_Shaper shaper;
+    shaper.render_ = &render;
+    shaper.wrap_width_ = size.width;
+    const std::vector<Bench_Corpus> corpora = Corpus_All(4 * 1024);
+    shaper.text_add(Corpus_UTF8(corpora[0]), markup);
+    shaper.finish();
+    render.clear();
+    shaper.draw();
+    suite.run("draw_text", std::string("ascii_") + size_str, corpora[0].text.size(), draw_frame);
+    while (OsOffscreen_Readback(offscreen.state, pixels)) {}
+}
+#endif
+
+static bool Option_Parse(const char* arg, const char* name, const char*& value)
+{
+    const std::size_t length = std::strlen(name);
+    if ((std::strncmp(arg, name, length) != 0) || (arg[length] != '='))
+        return false;
+    value = (arg + length + 1);
+    return true;
+}
+
+static bool Options_Parse(int argc, char* argv[], Bench_Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* value = nullptr;
+        if (Option_Parse(argv[i], "--format", value))
+        {
+            if (std::strcmp(value, "json") == 0)
+                options.format = Bench_Format::JSON;
+            else if (std::strcmp(value, "csv") == 0)
+                options.format = Bench_Format::CSV;
+            else if (std::strcmp(value, "text") == 0)
+                options.format = Bench_Format::Text;
+            else
+                return false;
+        }
+        else if (Option_Parse(argv[i], "--out", value))
+            options.output_path = value;
+        else if (Option_Parse(argv[i], "--filter", value))
+            options.filter = value;
+        else if (Option_Parse(argv[i], "--min-time-ms", value))
+            options.min_time_ms = std::atoi(value);
+        else if (Option_Parse(argv[i], "--repetitions", value))
+            options.repetitions = std::atoi(value);
+        else if (Option_Parse(argv[i], "--font", value))
+            options.font_path = value;
+        else if (Option_Parse(argv[i], "--font-cjk", value))
+            options.font_cjk_path = value;
+        else if (Option_Parse(argv[i], "--pipeline-cache", value))
+            options.pipeline_cache_path = value;
+        else if (Option_Parse(argv[i], "--frames-in-flight", value))
+        {
+            const int frames_in_flight = std::atoi(value);
+            if (frames_in_flight <= 0)
+                return false;
+            options.frames_in_flight = unsigned(frames_in_flight);
+        }
+        else if (Option_Parse(argv[i], "--size", value))
+        {
+            if ((std::sscanf(value, "%dx%d", &options.size.width, &options.size.height) != 2)
+                || (options.size.width <= 0) || (options.size.height <= 0))
+                return false;
+        }
+        else
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    Bench_Suite suite;
+    if (!Options_Parse(argc, argv, suite.options))
+    {
+        std::fprintf(stderr, "Usage: kr_bench [--format=text|json|csv] [--out=<file>] [--filter=<substring>]\n"
+            "    [--min-time-ms=200] [--repetitions=5] [--font=<ttf>] [--font-cjk=<ttf>] [--size=<width>x<height>]\n"
+            "    [--pipeline-cache=<file>] [--frames-in-flight=3]\n");
+        return 1;
+    }
+    Bench_Options& options = suite.options;
+    if (!options.font_path)
+    {
+        options.font_path = File_FirstExisting({"C:/Windows/Fonts/arial.ttf"
+            , "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf"
+            , "/System/Library/Fonts/Supplemental/Arial.ttf"});
+    }
+    if (!options.font_cjk_path)
+    {
+        options.font_cjk_path = File_FirstExisting({"C:/Windows/Fonts/msyh.ttc"
+            , "/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc"
+            , "/System/Library/Fonts/PingFang.ttc"});
+    }
+    if (!options.font_path)
+        std::fprintf(stderr, "No font found (--font): font and text benchmarks are skipped.\n");
+
+    kr::Font_FreeTypeLibrary font_lib;
+    Bench_UTF8(suite);
+    Bench_VertexKernels(suite);
+    Bench_FontPages(suite, font_lib, options.font_path);
+#if (KR_BENCH_HEADLESS())
+    if (!Bench_CheckFrameStats() || !Bench_CheckMergeClip() || !Bench_CheckTextureBatching())
+        return 1;
+    Bench_RenderBuild(suite);
+    Bench_FramesInFlight(suite);
+    Bench_Render(suite, font_lib, options.font_path, options.font_cjk_path);
+#else
+    std::fprintf(stderr, "No headless context (kk_os_offscreen): render benchmarks are skipped.\n");
+#endif
+
+    std::FILE* file = stdout;
+    if (options.output_path)
+    {
+        file = std::fopen(options.output_path, "w");
+        if (!file)
+        {
+            std::fprintf(stderr, "Failed to open '%s'.\n", options.output_path);
+            return 1;
+        }
+    }
+    switch (options.format)
+    {
+    case Bench_Format::Text: Bench_WriteText(file, suite); break;
+    case Bench_Format::JSON: Bench_WriteJSON(file, suite); break;
+    case Bench_Format::CSV: Bench_WriteCSV(file, suite); break;
+    }
+    if (file != stdout)
+        std::fclose(file);
+    return 0;
+}
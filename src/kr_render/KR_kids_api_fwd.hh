@@ -6,6 +6,7 @@ namespace kr
 struct RenderData;
 struct KidsRender;
 struct CmdList;
+struct RetainedCmdList;
 struct Text_UTF8;
 struct GlyphInfo;
 class Font;
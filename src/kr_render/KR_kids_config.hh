@@ -12,10 +12,16 @@
 #else
 #  define KK_RENDER_VULKAN() 0
 #endif
+#if defined(KK_BUILD_RENDER_SOFTWARE) && (KK_BUILD_RENDER_SOFTWARE == 1)
+#  define KK_RENDER_SOFTWARE() 1
+#else
+#  define KK_RENDER_SOFTWARE() 0
+#endif
 
 static_assert(0
     + int(KK_RENDER_OPENGL())
     + int(KK_RENDER_VULKAN())
+    + int(KK_RENDER_SOFTWARE())
     == 1
     , "KK_RENDER_*: only one backend should be selected.");
 
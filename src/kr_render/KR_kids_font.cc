@@ -454,6 +454,7 @@ Font Font_FromFile(Font_FreeTypeLibrary& font_init
 {
     auto image_factory = [&render](int width_px, int height_px, const void* data)
     {
+        ++render.font_pages_created_; // One image per Font_Page.
         return ImageRef::FromMemory(render
             , ImageRef::Format::RGBA
             , width_px
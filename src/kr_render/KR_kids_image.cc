@@ -2,6 +2,7 @@
 #include "KR_kids_render.hh"
 
 #include <utility>
+#include <vector>
 
 #include <cstdio>
 #include <cstdlib>
@@ -21,10 +22,19 @@ struct ImageRef::ImageState
 #endif
 #if (KK_RENDER_VULKAN())
     VkDevice device_{};
+    std::shared_ptr<VulkanMemory> allocator_;
     // Owns.
-    VkDeviceMemory memory_{};
+    VulkanMemory_Allocation memory_{};
     VkImage image_{};
     VkImageView image_view_{};
+    std::shared_ptr<KidsRender::Vulkan_DescriptorPools> descriptor_pools_;
+    VkDescriptorPool descriptor_pool_{};
+    VkDescriptorSet descriptor_set_{};
+    // Of the upload batch, see KidsRender::flush_uploads().
+    std::shared_ptr<const bool> uploaded_;
+#endif
+#if (KK_RENDER_SOFTWARE())
+    std::vector<kk::Color> pixels_;
 #endif
 
     static std::shared_ptr<ImageState> New()
@@ -52,6 +62,16 @@ int ImageRef::height() const
     return ref_->height_;
 }
 
+bool ImageRef::is_ready() const
+{
+    KK_VERIFY(ref_);
+#if (KK_RENDER_VULKAN())
+    return (!ref_->uploaded_ || *ref_->uploaded_);
+#else
+    return true;
+#endif
+}
+
 #if (KK_RENDER_OPENGL())
 /*static*/ ImageRef ImageRef::FromMemory(KidsRender&
     , Format format
@@ -103,39 +123,37 @@ VkImageView ImageRef::image_view() const
     return ref_->image_view_;
 }
 
+VkDescriptorSet ImageRef::descriptor_set() const
+{
+    KK_VERIFY(ref_);
+    return ref_->descriptor_set_;
+}
+
 // Mostly from ImGUI. See:
 // https://github.com/ocornut/imgui/blob/26f817807cb9edfa2057a2b07a700f8e53b923fb/backends/imgui_impl_vulkan.cpp
 // 
 
-static uint32_t Vulkan_MemoryType(
-    VkPhysicalDevice physical_device
-    , VkMemoryPropertyFlags properties
-    , uint32_t type_bits)
-{
-    VkPhysicalDeviceMemoryProperties prop;
-    vkGetPhysicalDeviceMemoryProperties(physical_device, &prop);
-    for (uint32_t i = 0; i < prop.memoryTypeCount; ++i)
-    {
-        if ((prop.memoryTypes[i].propertyFlags & properties) == properties && type_bits & (1 << i))
-            return i;
-    }
-    KK_VERIFY(false);
-    return 0xffffffff;
-}
-
 struct VulkanImage
 {
-    VkDeviceMemory memory_{};
+    VulkanMemory_Allocation memory_{};
     VkImage image_{};
     VkImageView image_view_{};
 };
 
+static std::size_t Vulkan_UploadSize(ImageRef::Format format, int width, int height)
+{
+    std::size_t upload_size = (std::size_t(width) * std::size_t(height));
+    switch (format)
+    {
+    case ImageRef::Format::RGBA: upload_size *= 4; break;
+    }
+    return upload_size;
+}
+
 static VulkanImage Vulkan_CreateImage_RecordCmds(
-      VkCommandBuffer command_buffer
-    , VkBuffer* upload_buffer
-    , VkDeviceMemory* upload_buffer_memory
+      const KidsRender::Vulkan_UploadSpace& upload_space
     , VkDevice device
-    , VkPhysicalDevice physical_device
+    , VulkanMemory& memory
     , ImageRef::Format format
     , int width
     , int height
@@ -144,15 +162,12 @@ static VulkanImage Vulkan_CreateImage_RecordCmds(
     VulkanImage vk_image;
     VkResult err{};
 
-    const unsigned char* pixels = static_cast<const unsigned char*>(ptr);
-    size_t upload_size = width * height;
+    const VkCommandBuffer command_buffer = upload_space.command_buffer;
+    const std::size_t upload_size = Vulkan_UploadSize(format, width, height);
     VkFormat vk_format = VK_FORMAT_R8G8B8A8_UNORM;
     switch (format)
     {
-    case ImageRef::Format::RGBA:
-        upload_size *= 4;
-        vk_format = VK_FORMAT_R8G8B8A8_UNORM;
-        break;
+    case ImageRef::Format::RGBA: vk_format = VK_FORMAT_R8G8B8A8_UNORM; break;
     }
 
     // Create the Image:
@@ -175,14 +190,9 @@ static VulkanImage Vulkan_CreateImage_RecordCmds(
         KK_VERIFY(err == VK_SUCCESS);
         VkMemoryRequirements req;
         vkGetImageMemoryRequirements(device, vk_image.image_, &req);
-        VkMemoryAllocateInfo alloc_info = {};
-        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        alloc_info.allocationSize = req.size;
-        alloc_info.memoryTypeIndex = Vulkan_MemoryType(physical_device
-            , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, req.memoryTypeBits);
-        err = vkAllocateMemory(device, &alloc_info, nullptr, &vk_image.memory_);
-        KK_VERIFY(err == VK_SUCCESS);
-        err = vkBindImageMemory(device, vk_image.image_, vk_image.memory_, 0);
+        vk_image.memory_ = memory.allocate(req
+            , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VulkanMemory_Kind::Image);
+        err = vkBindImageMemory(device, vk_image.image_, vk_image.memory_.memory, vk_image.memory_.offset);
         KK_VERIFY(err == VK_SUCCESS);
     }
 
@@ -200,42 +210,8 @@ static VulkanImage Vulkan_CreateImage_RecordCmds(
         KK_VERIFY(err == VK_SUCCESS);
     }
 
-    // Create the Upload Buffer:
-    {
-        VkBufferCreateInfo buffer_info = {};
-        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        buffer_info.size = upload_size;
-        buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        err = vkCreateBuffer(device, &buffer_info, nullptr, upload_buffer);
-        KK_VERIFY(err == VK_SUCCESS);
-        VkMemoryRequirements req;
-        vkGetBufferMemoryRequirements(device, *upload_buffer, &req);
-        // bd->BufferMemoryAlignment = (bd->BufferMemoryAlignment > req.alignment) ? bd->BufferMemoryAlignment : req.alignment;
-        VkMemoryAllocateInfo alloc_info = {};
-        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        alloc_info.allocationSize = req.size;
-        alloc_info.memoryTypeIndex = Vulkan_MemoryType(physical_device, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, req.memoryTypeBits);
-        err = vkAllocateMemory(device, &alloc_info, nullptr, upload_buffer_memory);
-        KK_VERIFY(err == VK_SUCCESS);
-        err = vkBindBufferMemory(device, *upload_buffer, *upload_buffer_memory, 0);
-        KK_VERIFY(err == VK_SUCCESS);
-    }
-
-    // Upload to Buffer:
-    {
-        void* map = nullptr;
-        err = vkMapMemory(device, *upload_buffer_memory, 0, VK_WHOLE_SIZE, 0, &map);
-        KK_VERIFY(err == VK_SUCCESS);
-        memcpy(map, pixels, upload_size);
-        VkMappedMemoryRange range[1] = {};
-        range[0].sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        range[0].memory = *upload_buffer_memory;
-        range[0].size = VK_WHOLE_SIZE;
-        err = vkFlushMappedMemoryRanges(device, 1, range);
-        KK_VERIFY(err == VK_SUCCESS);
-        vkUnmapMemory(device, *upload_buffer_memory);
-    }
+    // Upload to staging (coherent) memory:
+    memcpy(upload_space.mapped, ptr, upload_size);
 
     // Copy to Image:
     {
@@ -253,13 +229,14 @@ static VulkanImage Vulkan_CreateImage_RecordCmds(
         vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, copy_barrier);
 
         VkBufferImageCopy region = {};
+        region.bufferOffset = upload_space.offset;
         region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         region.imageSubresource.layerCount = 1;
         region.imageExtent.width = width;
         region.imageExtent.height = height;
         region.imageExtent.depth = 1;
         vkCmdCopyBufferToImage(command_buffer
-            , *upload_buffer
+            , upload_space.buffer
             , vk_image.image_
             , VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
             , 1
@@ -282,62 +259,6 @@ static VulkanImage Vulkan_CreateImage_RecordCmds(
     return vk_image;
 }
 
-static VulkanImage Vulkan_CreateImageTexture(
-      const ImageRef& ref // Only to extend lifetime.
-    , KidsRender& render
-    , ImageRef::Format format
-    , int width
-    , int height
-    , const void* ptr)
-{
-    VkDevice device = render.render_data_.device;
-    VkDeviceMemory upload_buffer_memory{};
-    VkBuffer upload_buffer{};
-    VkCommandBuffer command_buffer{};
-
-    VkCommandBufferAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    alloc_info.pNext = nullptr;
-    alloc_info.commandPool = render.render_data_.work_command_pool;
-    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    alloc_info.commandBufferCount = 1;
-    KK_VERIFY(vkAllocateCommandBuffers(device, &alloc_info, &command_buffer) == VK_SUCCESS);
-
-    VkCommandBufferBeginInfo begin_info = {};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    KK_VERIFY(vkBeginCommandBuffer(command_buffer, &begin_info) == VK_SUCCESS);
-
-    VulkanImage vk_image = Vulkan_CreateImage_RecordCmds(
-          command_buffer
-        , &upload_buffer
-        , &upload_buffer_memory
-        , device
-        , render.render_data_.physical_device
-        , format
-        , width
-        , height
-        , ptr);
-
-    KK_VERIFY(vkEndCommandBuffer(command_buffer) == VK_SUCCESS);
-
-    VkSubmitInfo end_info = {};
-    end_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    end_info.commandBufferCount = 1;
-    end_info.pCommandBuffers = &command_buffer;
-    KK_VERIFY(vkQueueSubmit(render.render_data_.work_queue, 1, &end_info, VK_NULL_HANDLE) == VK_SUCCESS);
-
-    render.defer_clean_up([=, &render, image_ref = ref]() mutable
-    {
-        vkFreeMemory(device, upload_buffer_memory, nullptr);
-        vkDestroyBuffer(device, upload_buffer, nullptr);
-        vkFreeCommandBuffers(device, render.render_data_.work_command_pool, 1, &command_buffer);
-        image_ref = ImageRef();
-    });
-
-    return vk_image;
-}
-
 /*static*/ ImageRef ImageRef::FromMemory(KidsRender& render
     , Format format
     , int width
@@ -350,25 +271,83 @@ static VulkanImage Vulkan_CreateImageTexture(
     image_ref.ref_->height_ = height;
     image_ref.ref_->device_ = render.render_data_.device;
 
-    VulkanImage vk_image = Vulkan_CreateImageTexture(image_ref
-        , render
+    // Recorded to the current upload batch; submitted by KidsRender::draw().
+    const KidsRender::Vulkan_UploadSpace upload_space = render.upload_begin(
+        VkDeviceSize(Vulkan_UploadSize(format, width, height)));
+    VulkanImage vk_image = Vulkan_CreateImage_RecordCmds(upload_space
+        , render.render_data_.device
+        , *render.memory_
         , format
         , width
         , height
         , data);
 
+    image_ref.ref_->allocator_ = render.memory_;
     image_ref.ref_->memory_ = vk_image.memory_;
     image_ref.ref_->image_ = vk_image.image_;
     image_ref.ref_->image_view_ = vk_image.image_view_;
+    image_ref.ref_->descriptor_pools_ = render.descriptor_pools_;
+    image_ref.ref_->descriptor_set_ = render.create_descriptor_set(vk_image.image_view_
+        , image_ref.ref_->descriptor_pool_);
+    image_ref.ref_->uploaded_ = upload_space.done;
+    render.upload_end(image_ref);
 
     return image_ref;
 }
 
 ImageRef::ImageState::~ImageState() noexcept
 {
-    vkFreeMemory(device_, memory_, nullptr);
-    vkDestroyImage(device_, image_, nullptr);
+    // Not in use by GPU: frames that draw a batch set keep all of its images.
+    if (descriptor_pools_)
+        descriptor_pools_->free_batch_sets(image_view_);
+    if (descriptor_set_)
+        KK_VERIFY(vkFreeDescriptorSets(device_, descriptor_pool_, 1, &descriptor_set_) == VK_SUCCESS);
     vkDestroyImageView(device_, image_view_, nullptr);
+    vkDestroyImage(device_, image_, nullptr);
+    if (allocator_)
+        allocator_->free(memory_);
+}
+#endif
+
+#if (KK_RENDER_SOFTWARE())
+/*static*/ ImageRef ImageRef::FromMemory(KidsRender&
+    , Format format
+    , int width
+    , int height
+    , const void* data)
+{
+    KK_VERIFY((width > 0) && (height > 0));
+    KK_VERIFY(data);
+    ImageRef image_ref;
+    image_ref.ref_ = ImageState::New();
+    image_ref.ref_->width_ = width;
+    image_ref.ref_->height_ = height;
+
+    std::vector<kk::Color>& pixels = image_ref.ref_->pixels_;
+    pixels.resize(std::size_t(width) * std::size_t(height));
+    const unsigned char* src = static_cast<const unsigned char*>(data);
+    switch (format)
+    {
+    case Format::RGB:
+        for (kk::Color& pixel : pixels)
+        {
+            pixel = kk::Color{src[0], src[1], src[2], 0xff};
+            src += 3;
+        }
+        break;
+    case Format::RGBA:
+        std::memcpy(pixels.data(), src, pixels.size() * sizeof(kk::Color));
+        break;
+    }
+    return image_ref;
+}
+
+ImageRef::ImageState::~ImageState() noexcept = default;
+
+const kk::Color* ImageRef::pixels() const
+{
+    KK_VERIFY(ref_);
+    return ref_->pixels_.data();
 }
 #endif
 } // namespace kr
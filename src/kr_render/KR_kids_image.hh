@@ -34,9 +34,18 @@ public:
 #endif
 #if (KK_RENDER_VULKAN())
     VkImageView image_view() const;
+    // Image + KidsRender::texture_sampler_; allocated once, with the image.
+    VkDescriptorSet descriptor_set() const;
+#endif
+#if (KK_RENDER_SOFTWARE())
+    // RGBA8, width() * height(), top row first.
+    const kk::Color* pixels() const;
 #endif
 
     bool is_valid() const { return !!ref_; }
+    // Pixels are on the GPU. Vulkan uploads are batched and submitted
+    // by KidsRender::draw(); other backends upload in FromMemory().
+    bool is_ready() const;
 
     friend bool operator==(const ImageRef& lhs, const ImageRef& rhs) noexcept;
     friend bool operator!=(const ImageRef& lhs, const ImageRef& rhs) noexcept;
@@ -1,29 +1,26 @@
 #include "KR_kids_render.hh"
 #include "KR_kids_font.hh"
+#include "KR_vertex_kernels.hh"
+#include "KR_software_raster.hh"
 
+#include <algorithm>
 #include <utility>
 #include <cstring>
+#include <cstdio>
 #include <cstddef>
 #include <cmath>
+#include <cfloat>
 
 namespace kr
 {
 
-static float Normal_U8(std::uint8_t c)
-{
-    return (c / 255.f);
-}
-
 static Vertex Vertex_Make(float x, float y, const kk::Color& color)
 {
     Vertex v{};
     v.uv_ = kk::Vec2f{};
     v.p_.x = float(x);
     v.p_.y = float(y);
-    v.c_.r = Normal_U8(color.r);
-    v.c_.g = Normal_U8(color.g);
-    v.c_.b = Normal_U8(color.b);
-    v.c_.a = Normal_U8(color.a);
+    v.c_ = color;
     return v;
 }
 
@@ -61,6 +58,48 @@ static kk::Point2f ImBezierQuadraticCalc(const kk::Point2f& p1
     };
 }
 
+// Bounds for auto-detected segments count; circle is at least a square.
+static constexpr int kTessellate_MinSegments = 4;
+static constexpr int kTessellate_MaxSegments = 512;
+
+static int Tessellate_Clamp(double segments_count)
+{
+    if (!(segments_count < kTessellate_MaxSegments)) // NaN, too.
+        return kTessellate_MaxSegments;
+    return (std::max)(int(std::ceil(segments_count)), 1);
+}
+
+// Segments so that arc of `angle` (radians) deviates from its chords
+// no more than `tolerance` px: r * (1 - cos(a / (2n))) <= tolerance.
+static int Tessellate_ArcSegments(float radius
+    , double angle
+    , const kk::Vec2f& scale
+    , float tolerance)
+{
+    const double radius_px = (double(radius) * (std::max)(scale.x, scale.y));
+    if (radius_px <= tolerance)
+        return 1;
+    const double max_step = (2.0 * std::acos(1.0 - double(tolerance) / radius_px));
+    return Tessellate_Clamp(angle / max_step);
+}
+
+// Wang's formula: n = sqrt(d(d-1)/(8 tolerance) * max|P[i] - 2P[i+1] + P[i+2]|),
+// in scaled (screen) coordinates.
+static int Tessellate_BezierSegments(std::span<const kk::Point2f> points
+    , const kk::Vec2f& scale
+    , float tolerance)
+{
+    const double degree = double(points.size() - 1);
+    double max_dd = 0;
+    for (std::size_t i = 0; (i + 2) < points.size(); ++i)
+    {
+        const double ddx = (points[i].x - 2.0 * points[i + 1].x + points[i + 2].x) * scale.x;
+        const double ddy = (points[i].y - 2.0 * points[i + 1].y + points[i + 2].y) * scale.y;
+        max_dd = (std::max)(max_dd, std::sqrt(ddx * ddx + ddy * ddy));
+    }
+    return Tessellate_Clamp(std::sqrt(degree * (degree - 1) * max_dd / (8.0 * tolerance)));
+}
+
 static ImageRef Texture_White_1x1(KidsRender& render)
 {
     unsigned data = 0xffffffff;
@@ -70,13 +109,134 @@ static ImageRef Texture_White_1x1(KidsRender& render)
 static bool DrawCmd_CanMerge(const DrawCmd& prev_cmd
     , const ImageRef& texture
     , const ClipRect& clip_rect
-    , const kk::Vec2f& scale)
+    , const kk::Vec2f& scale
+    , Primitive primitive)
 {
-    return (prev_cmd.texture_ == texture)
+    return !prev_cmd.retained_
+        && (prev_cmd.primitive_ == primitive)
+        && (prev_cmd.texture_ == texture)
         && (prev_cmd.clip_rect_ == clip_rect)
         && (prev_cmd.scale_ == scale);
 }
 
+// Vertices must be contiguous with the ones `cmd` already has
+// and all of them must be addressable with `Index` relative to cmd's base vertex.
+static bool DrawCmd_CanAppendVertices(const DrawCmd& cmd
+    , unsigned vertex_offset
+    , std::size_t vertex_count)
+{
+    return ((cmd.vertex_offset_ + cmd.vertex_count_) == vertex_offset)
+        && ((std::size_t(vertex_offset - cmd.vertex_offset_) + vertex_count) <= kMaxDrawCmdVertices);
+}
+
+// Vertex slots per single vertex the indices refer to.
+static unsigned DrawCmd_VertexStride(const DrawCmd& cmd)
+{
+    return (cmd.primitive_ == Primitive::Triangles) ? 1 : 2;
+}
+
+static void DrawCmd_BoundsAdd(DrawCmd_Bounds& bounds, const DrawCmd_Bounds& other)
+{
+    bounds.x0 = (std::min)(bounds.x0, other.x0);
+    bounds.y0 = (std::min)(bounds.y0, other.y0);
+    bounds.x1 = (std::max)(bounds.x1, other.x1);
+    bounds.y1 = (std::max)(bounds.y1, other.y1);
+}
+
+static DrawCmd_Bounds DrawCmd_BoundsTranslate(const DrawCmd_Bounds& bounds, const kk::Point2f* translate_by)
+{
+    if (!translate_by)
+        return bounds;
+    return DrawCmd_Bounds
+    {
+        .x0 = bounds.x0 + translate_by->x,
+        .y0 = bounds.y0 + translate_by->y,
+        .x1 = bounds.x1 + translate_by->x,
+        .y1 = bounds.y1 + translate_by->y,
+    };
+}
+
+static DrawCmd_Bounds Vertices_Bounds(std::span<const Vertex> vertices)
+{
+    DrawCmd_Bounds bounds;
+    for (const Vertex& v : vertices)
+    {
+        bounds.x0 = (std::min)(bounds.x0, v.p_.x);
+        bounds.y0 = (std::min)(bounds.y0, v.p_.y);
+        bounds.x1 = (std::max)(bounds.x1, v.p_.x);
+        bounds.y1 = (std::max)(bounds.y1, v.p_.y);
+    }
+    return bounds;
+}
+
+// DrawCmds made by hand (not by AddVertices()) have no bounds.
+static bool DrawCmd_BoundsIsEmpty(const DrawCmd_Bounds& bounds)
+{
+    return (bounds.x0 > bounds.x1) || (bounds.y0 > bounds.y1);
+}
+
+// Of cmd's vertices in `cmd_list`; computed when the DrawCmd has none.
+static DrawCmd_Bounds DrawCmd_BoundsOf(const CmdList& cmd_list, const DrawCmd& cmd)
+{
+    if (!DrawCmd_BoundsIsEmpty(cmd.bounds_))
+        return cmd.bounds_;
+    KK_VERIFY((std::size_t(cmd.vertex_offset_) + cmd.vertex_count_) <= cmd_list.vertex_list_.size());
+    return Vertices_Bounds(std::span<const Vertex>(cmd_list.vertex_list_.data() + cmd.vertex_offset_
+        , cmd.vertex_count_));
+}
+
+// Nothing of `bounds` can be visible within `clip_rect`.
+// Exact (unscaled) compare, scissor is rounded outwards anyway.
+// Empty bounds are unknown: never culled.
+static bool DrawCmd_IsClippedOut(const DrawCmd_Bounds& bounds, const ClipRect& clip_rect)
+{
+    if (clip_rect == ClipRect{})
+        return false; // No clip.
+    if (DrawCmd_BoundsIsEmpty(bounds))
+        return false;
+    return (bounds.x1 < clip_rect.x)
+        || (bounds.y1 < clip_rect.y)
+        || (bounds.x0 > (clip_rect.x + clip_rect.width))
+        || (bounds.y0 > (clip_rect.y + clip_rect.height));
+}
+
+static void CullStats_Add(CullStats& stats, const CullStats& other)
+{
+    stats.primitives += other.primitives;
+    stats.draw_cmds += other.draw_cmds;
+    stats.vertices += other.vertices;
+    stats.indices += other.indices;
+}
+
+static void CullStats_AddDrawCmd(CullStats& stats, const DrawCmd& cmd)
+{
+    stats.draw_cmds += 1;
+    stats.vertices += cmd.vertex_count_;
+    stats.indices += cmd.index_count_;
+}
+
+// One of retained commands as it should be drawn
+// by the `retained_cmd` that references it.
+static DrawCmd DrawCmd_FromRetained(const DrawCmd& retained_cmd, const DrawCmd& cmd)
+{
+    DrawCmd draw_cmd = cmd;
+    if (retained_cmd.retained_clip_)
+        draw_cmd.clip_rect_ = retained_cmd.clip_rect_;
+    return draw_cmd;
+}
+
+static bool CmdList_SameGeometry(const CmdList& lhs, const CmdList& rhs)
+{
+    static_assert(sizeof(Vertex) == (sizeof(Vertex::p_) + sizeof(Vertex::uv_) + sizeof(Vertex::c_))
+        , "memcmp() of Vertex with padding");
+    return (lhs.vertex_list_.size() == rhs.vertex_list_.size())
+        && (lhs.index_list_.size() == rhs.index_list_.size())
+        && (std::memcmp(lhs.vertex_list_.data(), rhs.vertex_list_.data()
+            , lhs.vertex_list_.size() * sizeof(Vertex)) == 0)
+        && (std::memcmp(lhs.index_list_.data(), rhs.index_list_.data()
+            , lhs.index_list_.size() * sizeof(Index)) == 0);
+}
+
 static float Scale(float v, float scale)
 {
     return (v * scale);
@@ -121,18 +281,29 @@ static kk::Rect ClipRect_Transform(const ClipRect& clip_rect, const kk::Vec2f& s
     , const std::span<const Index>& new_indices
     , const ClipRect& clip_rect
     , const kk::Vec2f& scale
+    , Primitive primitive // = Primitive::Triangles
     )
 {
     std::vector<DrawCmd>& draw_list = cmd_list.draw_list_;
     std::vector<Vertex>& vertex_list = cmd_list.vertex_list_;
     std::vector<Index>& index_list = cmd_list.index_list_;
 
+    KK_VERIFY(new_vertices.size() <= kMaxDrawCmdVertices);
+    const DrawCmd_Bounds bounds = Vertices_Bounds(new_vertices);
+    if (DrawCmd_IsClippedOut(bounds, clip_rect))
+    {
+        cmd_list.culled_.primitives += 1;
+        cmd_list.culled_.vertices += new_vertices.size();
+        cmd_list.culled_.indices += new_indices.size();
+        return;
+    }
     const unsigned vertex_base = unsigned(vertex_list.size());
     const unsigned index_base = unsigned(index_list.size());
 
     DrawCmd* cmd = nullptr;
     if ((draw_list.size() > 0)
-        && DrawCmd_CanMerge(draw_list.back(), texture, clip_rect, scale))
+        && DrawCmd_CanMerge(draw_list.back(), texture, clip_rect, scale, primitive)
+        && DrawCmd_CanAppendVertices(draw_list.back(), vertex_base, new_vertices.size()))
         cmd = &draw_list.back();
     if (!cmd)
     {
@@ -143,15 +314,96 @@ static kk::Rect ClipRect_Transform(const ClipRect& clip_rect, const kk::Vec2f& s
         cmd->texture_ = texture;
         cmd->clip_rect_ = clip_rect;
         cmd->scale_ = scale;
+        cmd->primitive_ = primitive;
     }
+    DrawCmd_BoundsAdd(cmd->bounds_, bounds);
     cmd->index_count_ += unsigned(new_indices.size());
     cmd->vertex_count_ += unsigned(new_vertices.size());
 
     vertex_list.insert(vertex_list.end()
         , new_vertices.begin(), new_vertices.end());
+    const unsigned rebase = ((vertex_base - cmd->vertex_offset_) / DrawCmd_VertexStride(*cmd));
     index_list.resize(index_list.size() + new_indices.size());
-    for (std::size_t i = 0; i < new_indices.size(); ++i)
-        index_list[index_base + i] = Index(new_indices[i] + vertex_base);
+    Indices_Rebase(index_list.data() + index_base, new_indices.data(), new_indices.size(), Index(rebase));
+}
+
+static void Vertices_Copy(Vertex* dst
+    , const Vertex* src
+    , std::size_t count
+    , const kk::Point2f* translate_by)
+{
+    if (!translate_by)
+    {
+        std::memcpy(dst, src, count * sizeof(Vertex));
+        return;
+    }
+    Vertices_Translate(dst, src, count, *translate_by);
+}
+
+static void Indices_Copy(Index* dst
+    , const Index* src
+    , std::size_t count
+    , unsigned rebase)
+{
+    if (count == 0) // Instanced quads only.
+        return;
+    if (rebase == 0)
+    {
+        std::memcpy(dst, src, count * sizeof(Index));
+        return;
+    }
+    Indices_Rebase(dst, src, count, Index(rebase));
+}
+
+static void DrawCmd_AppendRetained(std::vector<DrawCmd>& draw_list
+    , const DrawCmd& new_cmd
+    , const kk::Point2f* translate_by
+    , const ClipRect* override_clip_rect)
+{
+    DrawCmd& cmd = draw_list.emplace_back(new_cmd);
+    if (translate_by)
+    {
+        cmd.retained_translate_.x += translate_by->x;
+        cmd.retained_translate_.y += translate_by->y;
+    }
+    if (override_clip_rect)
+    {
+        cmd.clip_rect_ = *override_clip_rect;
+        cmd.retained_clip_ = true;
+    }
+}
+
+// Appends `new_cmd` (whose vertices/indices land at given offsets) to
+// draw_list.back() or as a new command. Returns how much new_cmd's indices
+// should be shifted: they are relative to DrawCmd's base vertex.
+static unsigned DrawCmd_Append(std::vector<DrawCmd>& draw_list
+    , const DrawCmd& new_cmd
+    , const ClipRect& clip_rect
+    , const DrawCmd_Bounds& bounds
+    , unsigned vertex_offset
+    , unsigned index_offset)
+{
+    DrawCmd* cmd = nullptr;
+    if ((draw_list.size() > 0)
+        && DrawCmd_CanMerge(draw_list.back(), new_cmd.texture_, clip_rect, new_cmd.scale_, new_cmd.primitive_)
+        && DrawCmd_CanAppendVertices(draw_list.back(), vertex_offset, new_cmd.vertex_count_)
+        && ((draw_list.back().index_offset_ + draw_list.back().index_count_) == index_offset))
+        cmd = &draw_list.back();
+    if (!cmd)
+    {
+        draw_list.push_back({});
+        cmd = &draw_list.back();
+        cmd->index_offset_ = index_offset;
+        cmd->vertex_offset_ = vertex_offset;
+        cmd->texture_ = new_cmd.texture_;
+        cmd->clip_rect_ = clip_rect;
+        cmd->scale_ = new_cmd.scale_;
+        cmd->primitive_ = new_cmd.primitive_;
+    }
+    DrawCmd_BoundsAdd(cmd->bounds_, bounds);
+    cmd->index_count_ += unsigned(new_cmd.index_count_);
+    cmd->vertex_count_ += unsigned(new_cmd.vertex_count_);
+    return ((vertex_offset - cmd->vertex_offset_) / DrawCmd_VertexStride(*cmd));
 }
 
 // Lowest-level API: push whatever makes sense.
@@ -161,6 +413,7 @@ void KidsRender::merge_cmd_lists(const CmdList& new_cmd_list
     , CmdList* append_to_cmd_list // = nullptr
     )
 {
+    ProfileScope profile_scope{this, ProfileStage::Build};
     // #TODO: merge with AddVertices().
     CmdList& cmd_list = append_to_cmd_list
         ? *append_to_cmd_list
@@ -170,52 +423,296 @@ void KidsRender::merge_cmd_lists(const CmdList& new_cmd_list
     std::vector<Vertex>& vertex_list = cmd_list.vertex_list_;
     std::vector<Index>& index_list = cmd_list.index_list_;
 
-    const unsigned vertex_base = unsigned(vertex_list.size());
-    const unsigned index_base = unsigned(index_list.size());
-
     const std::vector<Vertex>& new_vertex_list = new_cmd_list.vertex_list_;
     const std::vector<Index>& new_index_list = new_cmd_list.index_list_;
 
-    if (!translate_by)
-        vertex_list.insert(vertex_list.end(), new_vertex_list.begin(), new_vertex_list.end());
-    else
-    {
-        const std::size_t count = vertex_list.size();
-        vertex_list.resize(count + new_vertex_list.size());
-        for (std::size_t i = 0, new_count = new_vertex_list.size(); i < new_count; ++i)
-        {
-            Vertex& v = vertex_list[i + count];
-            v = new_vertex_list[i];
-            v.p_.x += translate_by->x;
-            v.p_.y += translate_by->y;
-        }
-    }
-    index_list.resize(index_list.size() + new_index_list.size());
-    for (std::size_t i = 0; i < new_index_list.size(); ++i)
-        index_list[index_base + i] = Index(new_index_list[i] + vertex_base);
+    // Commands outside of their clip are dropped, so the rest
+    // is copied command by command, packed.
+    unsigned vertex_offset = unsigned(vertex_list.size());
+    unsigned index_offset = unsigned(index_list.size());
+    vertex_list.resize(vertex_offset + new_vertex_list.size());
+    index_list.resize(index_offset + new_index_list.size());
 
     for (const DrawCmd& new_cmd : new_cmd_list.draw_list_)
     {
+        if (new_cmd.retained_)
+        {
+            DrawCmd_AppendRetained(draw_list, new_cmd, translate_by, override_clip_rect);
+            continue;
+        }
         const ClipRect clip_rect = override_clip_rect
             ? *override_clip_rect
             : new_cmd.clip_rect_;
-        DrawCmd* cmd = nullptr;
-        if ((draw_list.size() > 0)
-            && DrawCmd_CanMerge(draw_list.back(), new_cmd.texture_, clip_rect, new_cmd.scale_))
-            cmd = &draw_list.back();
-        if (!cmd)
+        const DrawCmd_Bounds bounds = DrawCmd_BoundsTranslate(DrawCmd_BoundsOf(new_cmd_list, new_cmd)
+            , translate_by);
+        if (DrawCmd_IsClippedOut(bounds, clip_rect))
+        {
+            CullStats_AddDrawCmd(cmd_list.culled_, new_cmd);
+            continue;
+        }
+        const unsigned rebase = DrawCmd_Append(draw_list
+            , new_cmd
+            , clip_rect
+            , bounds
+            , vertex_offset
+            , index_offset);
+        Vertices_Copy(vertex_list.data() + vertex_offset
+            , new_vertex_list.data() + new_cmd.vertex_offset_
+            , new_cmd.vertex_count_
+            , translate_by);
+        Indices_Copy(index_list.data() + index_offset
+            , new_index_list.data() + new_cmd.index_offset_
+            , new_cmd.index_count_
+            , rebase);
+        vertex_offset += new_cmd.vertex_count_;
+        index_offset += new_cmd.index_count_;
+    }
+    vertex_list.resize(vertex_offset);
+    index_list.resize(index_offset);
+    CullStats_Add(cmd_list.culled_, new_cmd_list.culled_);
+}
+
+void KidsRender::merge_cmd_lists_parallel(std::span<const CmdList* const> new_cmd_lists
+    , kk::ThreadPool& thread_pool
+    , const kk::Point2f* translate_by // = nullptr
+    , const ClipRect* override_clip_rect // = nullptr
+    , CmdList* append_to_cmd_list // = nullptr
+    )
+{
+    ProfileScope profile_scope{this, ProfileStage::Build};
+    CmdList& cmd_list = append_to_cmd_list
+        ? *append_to_cmd_list
+        : cmd_list_;
+    std::vector<DrawCmd>& draw_list = cmd_list.draw_list_;
+
+    // Where commands of every list start in `copy_list`.
+    const std::size_t lists_count = new_cmd_lists.size();
+    std::vector<std::size_t> cmd_base(lists_count);
+    std::size_t cmd_count = 0;
+    for (std::size_t i = 0; i < lists_count; ++i)
+    {
+        cmd_base[i] = cmd_count;
+        cmd_count += new_cmd_lists[i]->draw_list_.size();
+    }
+
+    // Draw commands are merged serially (it's cheap), remembering
+    // where every new command goes for the parallel copy below.
+    struct CopyInfo
+    {
+        unsigned vertex_offset = 0;
+        unsigned index_offset = 0;
+        unsigned rebase = 0;
+        bool skip = true; // Retained or culled.
+    };
+    std::vector<CopyInfo> copy_list(cmd_count);
+    unsigned vertex_offset = unsigned(cmd_list.vertex_list_.size());
+    unsigned index_offset = unsigned(cmd_list.index_list_.size());
+    for (std::size_t i = 0; i < lists_count; ++i)
+    {
+        const CmdList& new_cmd_list = *new_cmd_lists[i];
+        for (std::size_t j = 0; j < new_cmd_list.draw_list_.size(); ++j)
+        {
+            const DrawCmd& new_cmd = new_cmd_list.draw_list_[j];
+            if (new_cmd.retained_)
+            {
+                DrawCmd_AppendRetained(draw_list, new_cmd, translate_by, override_clip_rect);
+                continue;
+            }
+            const ClipRect clip_rect = override_clip_rect
+                ? *override_clip_rect
+                : new_cmd.clip_rect_;
+            const DrawCmd_Bounds bounds = DrawCmd_BoundsTranslate(DrawCmd_BoundsOf(new_cmd_list, new_cmd)
+                , translate_by);
+            if (DrawCmd_IsClippedOut(bounds, clip_rect))
+            {
+                CullStats_AddDrawCmd(cmd_list.culled_, new_cmd);
+                continue;
+            }
+            CopyInfo& copy = copy_list[cmd_base[i] + j];
+            copy.vertex_offset = vertex_offset;
+            copy.index_offset = index_offset;
+            copy.skip = false;
+            copy.rebase = DrawCmd_Append(draw_list
+                , new_cmd
+                , clip_rect
+                , bounds
+                , vertex_offset
+                , index_offset);
+            vertex_offset += new_cmd.vertex_count_;
+            index_offset += new_cmd.index_count_;
+        }
+        CullStats_Add(cmd_list.culled_, new_cmd_list.culled_);
+    }
+
+    cmd_list.vertex_list_.resize(vertex_offset);
+    cmd_list.index_list_.resize(index_offset);
+    thread_pool.parallel_for(lists_count, [&](std::size_t i)
+    {
+        const CmdList& new_cmd_list = *new_cmd_lists[i];
+        for (std::size_t j = 0; j < new_cmd_list.draw_list_.size(); ++j)
+        {
+            const DrawCmd& new_cmd = new_cmd_list.draw_list_[j];
+            const CopyInfo& copy = copy_list[cmd_base[i] + j];
+            if (copy.skip)
+                continue;
+            Vertices_Copy(cmd_list.vertex_list_.data() + copy.vertex_offset
+                , new_cmd_list.vertex_list_.data() + new_cmd.vertex_offset_
+                , new_cmd.vertex_count_
+                , translate_by);
+            Indices_Copy(cmd_list.index_list_.data() + copy.index_offset
+                , new_cmd_list.index_list_.data() + new_cmd.index_offset_
+                , new_cmd.index_count_
+                , copy.rebase);
+        }
+    });
+}
+
+void KidsRender::draw_retained(RetainedCmdList& retained
+    , const kk::Point2f* translate_by // = nullptr
+    , const ClipRect* override_clip_rect // = nullptr
+    , CmdList* append_to_cmd_list // = nullptr
+    )
+{
+    KK_VERIFY(retained.render_ == this);
+    if (retained.cmd_list_.draw_list_.empty())
+        return;
+    ProfileScope profile_scope{this, ProfileStage::Build};
+    CmdList& cmd_list = append_to_cmd_list
+        ? *append_to_cmd_list
+        : cmd_list_;
+    DrawCmd& cmd = cmd_list.draw_list_.emplace_back();
+    cmd.retained_ = &retained;
+    if (translate_by)
+        cmd.retained_translate_ = *translate_by;
+    if (override_clip_rect)
+    {
+        cmd.clip_rect_ = *override_clip_rect;
+        cmd.retained_clip_ = true;
+    }
+}
+
+namespace
+{
+struct DrawCmd_Batch
+{
+    DrawCmd cmd; // First command; batch key.
+    DrawCmd_Bounds bounds;
+    std::size_t vertex_count = 0;
+    std::vector<std::size_t> cmd_indices;
+};
+} // namespace
+
+// Screen-space (scaled) bounding box of cmd's vertices.
+static DrawCmd_Bounds DrawCmd_ScreenBounds(const DrawCmd& cmd)
+{
+    DrawCmd_Bounds bounds = cmd.bounds_;
+    bounds.x0 *= cmd.scale_.x;
+    bounds.x1 *= cmd.scale_.x;
+    bounds.y0 *= cmd.scale_.y;
+    bounds.y1 *= cmd.scale_.y;
+    return bounds;
+}
+
+static bool DrawCmd_BoundsOverlap(const DrawCmd_Bounds& lhs, const DrawCmd_Bounds& rhs)
+{
+    return (lhs.x0 <= rhs.x1) && (rhs.x0 <= lhs.x1)
+        && (lhs.y0 <= rhs.y1) && (rhs.y0 <= lhs.y1);
+}
+
+/*static*/ std::size_t KidsRender::ReorderDrawCmds(CmdList& cmd_list)
+{
+    // How far back to look for a batch to join; keeps it O(N).
+    constexpr std::size_t kMaxLookBack = 32;
+    const std::size_t count = cmd_list.draw_list_.size();
+    if (count < 2)
+        return 0;
+
+    std::vector<DrawCmd_Batch> batches;
+    batches.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const DrawCmd& cmd = cmd_list.draw_list_[i];
+        // Retained lists and DrawCmds made by hand have unknown bounds:
+        // nothing crosses them.
+        const bool unknown_bounds = (cmd.retained_ || DrawCmd_BoundsIsEmpty(cmd.bounds_));
+        const DrawCmd_Bounds bounds = unknown_bounds
+            ? DrawCmd_Bounds{-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX}
+            : DrawCmd_ScreenBounds(cmd);
+
+        DrawCmd_Batch* join = nullptr;
+        const std::size_t look_back = (std::min)(batches.size(), kMaxLookBack);
+        for (std::size_t k = 0; !cmd.retained_ && (k < look_back); ++k)
+        {
+            DrawCmd_Batch& batch = batches[batches.size() - 1 - k];
+            if (DrawCmd_CanMerge(batch.cmd, cmd.texture_, cmd.clip_rect_, cmd.scale_, cmd.primitive_)
+                && ((batch.vertex_count + cmd.vertex_count_) <= kMaxDrawCmdVertices))
+            {
+                join = &batch;
+                break;
+            }
+            if (DrawCmd_BoundsOverlap(batch.bounds, bounds))
+                break;
+        }
+        if (!join)
+        {
+            join = &batches.emplace_back();
+            join->cmd = cmd;
+        }
+        DrawCmd_BoundsAdd(join->bounds, bounds);
+        join->vertex_count += cmd.vertex_count_;
+        join->cmd_indices.push_back(i);
+    }
+
+    if (batches.size() == count)
+        return 0;
+
+    // Rebuild: vertices of a batch become contiguous, indices are rebased
+    // to the batch's first vertex.
+    CmdList new_cmd_list;
+    new_cmd_list.draw_list_.reserve(batches.size());
+    new_cmd_list.vertex_list_.reserve(cmd_list.vertex_list_.size());
+    new_cmd_list.index_list_.reserve(cmd_list.index_list_.size());
+    for (const DrawCmd_Batch& batch : batches)
+    {
+        DrawCmd& new_cmd = new_cmd_list.draw_list_.emplace_back(batch.cmd);
+        if (new_cmd.retained_)
+            continue;
+        new_cmd.vertex_offset_ = unsigned(new_cmd_list.vertex_list_.size());
+        new_cmd.index_offset_ = unsigned(new_cmd_list.index_list_.size());
+        new_cmd.vertex_count_ = 0;
+        new_cmd.index_count_ = 0;
+        new_cmd.bounds_ = {};
+        for (const std::size_t i : batch.cmd_indices)
         {
-            draw_list.push_back({});
-            cmd = &draw_list.back();
-            cmd->index_offset_ = index_base + new_cmd.index_offset_;
-            cmd->vertex_offset_ = vertex_base + new_cmd.vertex_offset_;
-            cmd->texture_ = new_cmd.texture_;
-            cmd->clip_rect_ = clip_rect;
-            cmd->scale_ = new_cmd.scale_;
+            const DrawCmd& cmd = cmd_list.draw_list_[i];
+            DrawCmd_BoundsAdd(new_cmd.bounds_, cmd.bounds_);
+            const Vertex* vertices = cmd_list.vertex_list_.data() + cmd.vertex_offset_;
+            const Index* indices = cmd_list.index_list_.data() + cmd.index_offset_;
+            const Index rebase = Index(new_cmd.vertex_count_ / DrawCmd_VertexStride(new_cmd));
+            new_cmd_list.vertex_list_.insert(new_cmd_list.vertex_list_.end()
+                , vertices, vertices + cmd.vertex_count_);
+            const std::size_t index_base = new_cmd_list.index_list_.size();
+            new_cmd_list.index_list_.resize(index_base + cmd.index_count_);
+            Indices_Rebase(new_cmd_list.index_list_.data() + index_base, indices, cmd.index_count_, rebase);
+            new_cmd.vertex_count_ += cmd.vertex_count_;
+            new_cmd.index_count_ += cmd.index_count_;
         }
-        cmd->index_count_ += unsigned(new_cmd.index_count_);
-        cmd->vertex_count_ += unsigned(new_cmd.vertex_count_);
     }
+
+    const std::size_t saved = (count - batches.size());
+    new_cmd_list.culled_ = cmd_list.culled_;
+    cmd_list = std::move(new_cmd_list);
+    return saved;
+}
+
+void RetainedCmdList::set(CmdList cmd_list)
+{
+    for (const DrawCmd& cmd : cmd_list.draw_list_)
+        KK_VERIFY(!cmd.retained_); // Nested retained lists are not supported.
+    // Callers may rebuild the same content every frame: upload only on real change.
+    const bool same = CmdList_SameGeometry(cmd_list_, cmd_list);
+    cmd_list_ = std::move(cmd_list);
+    dirty_ = (dirty_ || !same);
 }
 
 void KidsRender::line(const kk::Point2f& p1
@@ -290,9 +787,9 @@ void KidsRender::triangle(const kk::Point2f& p1
     , CmdList* cmd_list         // = nullptr
     )
 {
-    line(p1, p2, color, width, scale, clip_rect, cmd_list);
-    line(p2, p3, color, width, scale, clip_rect, cmd_list);
-    line(p3, p1, color, width, scale, clip_rect, cmd_list);
+    const kk::Point2f points[] = {p1, p2, p3};
+    const bool closed = true;
+    polyline(points, color, width, closed, LineJoin::Miter, LineCap::Butt, scale, clip_rect, cmd_list);
 }
 
 void KidsRender::triangle_fill(const kk::Point2f& p1
@@ -340,10 +837,15 @@ void KidsRender::rect(const kk::Point2f& p_min_
     const kk::Point2f p_min = (p_min_ + delta);
     const kk::Point2f p_max = (p_max_ - delta);
 
-    line(p_min, {p_max.x, p_min.y}, color, width, scale, clip_rect, cmd_list);
-    line({p_max.x, p_min.y}, p_max, color, width, scale, clip_rect, cmd_list);
-    line(p_max, {p_min.x, p_max.y}, color, width, scale, clip_rect, cmd_list);
-    line({p_min.x, p_max.y}, p_min, color, width, scale, clip_rect, cmd_list);
+    const kk::Point2f points[] =
+    {
+        p_min,
+        {p_max.x, p_min.y},
+        p_max,
+        {p_min.x, p_max.y},
+    };
+    const bool closed = true;
+    polyline(points, color, width, closed, LineJoin::Miter, LineCap::Butt, scale, clip_rect, cmd_list);
 }
 
 void KidsRender::rect_fill(const kk::Point2f& p_min
@@ -354,19 +856,53 @@ void KidsRender::rect_fill(const kk::Point2f& p_min
     , CmdList* cmd_list         // = nullptr
     )
 {
-    auto to_ = [&color](float x, float y) { return Vertex_Make(x, y, color); };
-
-    const float x1 = p_min.x;
-    const float x2 = p_max.x;
-    const float y1 = p_min.y;
-    const float y2 = p_max.y;
+    quad(white_1x1_
+        , p_min
+        , p_max
+        , kk::Vec2f{0.f, 0.f}
+        , kk::Vec2f{0.f, 0.f}
+        , color
+        , scale
+        , clip_rect
+        , cmd_list);
+}
 
+void KidsRender::quad(const ImageRef& texture
+    , const kk::Point2f& p_min
+    , const kk::Point2f& p_max
+    , const kk::Vec2f& uv_min
+    , const kk::Vec2f& uv_max
+    , const kk::Color& color
+    , const kk::Vec2f& scale
+    , const ClipRect& clip_rect
+    , CmdList* cmd_list
+    )
+{
+#if (KK_RENDER_OPENGL() || KK_RENDER_VULKAN())
+    // Vertex shader expands it to 4 corners.
+    const Vertex vertices[] =
+    {
+        Vertex{p_min, uv_min, color},
+        Vertex{p_max, uv_max, kk::Color{}}, // Texture unit 0.
+    };
+    AddVertices(cmd_list ? *cmd_list : cmd_list_
+        , texture
+        , vertices
+        , {}
+        , clip_rect
+        , scale
+        , Primitive::Quads);
+#else
+    auto to_ = [&color](float x, float y, float u, float v)
+    {
+        return Vertex{kk::Vec2f{x, y}, kk::Vec2f{u, v}, color};
+    };
     const Vertex vertices[] =
     {
-        to_(x1, y1),
-        to_(x1, y2),
-        to_(x2, y2),
-        to_(x2, y1),
+        to_(p_min.x, p_min.y, uv_min.x, uv_min.y),
+        to_(p_min.x, p_max.y, uv_min.x, uv_max.y),
+        to_(p_max.x, p_max.y, uv_max.x, uv_max.y),
+        to_(p_max.x, p_min.y, uv_max.x, uv_min.y),
     };
     const Index indices[] =
     {
@@ -378,11 +914,12 @@ void KidsRender::rect_fill(const kk::Point2f& p_min
         0,
     };
     AddVertices(cmd_list ? *cmd_list : cmd_list_
-        , white_1x1_
+        , texture
         , vertices
         , indices
         , clip_rect
         , scale);
+#endif
 }
 
 void KidsRender::circle_impl(const kk::Point2f& p_center
@@ -396,9 +933,12 @@ void KidsRender::circle_impl(const kk::Point2f& p_center
     , float width
     )
 {
-    if (segments_count <= 0)
-        segments_count = 314; // Auto-detect.
     KK_VERIFY(radius >= 0);
+    if (segments_count <= 0)
+    {
+        segments_count = (std::max)(kTessellate_MinSegments
+            , Tessellate_ArcSegments(radius, 2.0 * 3.1415926, scale, tessellation_tolerance_));
+    }
 
     auto segment = [&](int n) -> kk::Point2f
     {
@@ -411,26 +951,31 @@ void KidsRender::circle_impl(const kk::Point2f& p_center
         return {x_px, y_px};
     };
 
+    if (!do_fill)
+    {
+        std::vector<kk::Point2f> points(segments_count);
+        for (int ii = 0; ii < segments_count; ++ii)
+            points[ii] = segment(ii);
+        const bool closed = true;
+        polyline(points, color, width, closed, LineJoin::Miter, LineCap::Butt, scale, clip_rect, cmd_list);
+        return;
+    }
+
     const kk::Point2f first = segment(0);
     kk::Point2f prev = first;
 
     auto render_ = [&](kk::Point2f new_)
     {
-        if (do_fill)
-        {
-            triangle_fill(p_center
+        triangle_fill(p_center
 #if (KK_RENDER_VULKAN()) // Please, fix me.
-                , new_, prev
+            , new_, prev
 #else
-                , prev, new_
+            , prev, new_
 #endif
-                , color
-                , scale
-                , clip_rect
-                , cmd_list);
-        }
-        else
-            line(prev, new_, color, width, scale, clip_rect, cmd_list);
+            , color
+            , scale
+            , clip_rect
+            , cmd_list);
         prev = new_;
     };
 
@@ -483,49 +1028,66 @@ void KidsRender::circle_fill(const kk::Point2f& p_center
         , 1.f);
 }
 
-void KidsRender::image(const ImageRef& image
-    , const kk::Point2f& p_min  // = kk::Point2f{0, 0}
-    , const kk::Point2f& p_max  // = kk::Point2f_Invalid() // Use image's size.
-    , const kk::Vec2f& uv_min   // = kk::Vec2f{0.f, 0.f} // Use full image to sample.
-    , const kk::Vec2f& uv_max   // = kk::Vec2f{1.f, 1.f}
-    , const kk::Color& color_   // = Color_White()
-    , const kk::Vec2f& scale    // = kk::Vec2f{1.f, 1.f}
-    , const ClipRect& clip_rect // = {}
-    , CmdList* cmd_list         // = nullptr
-    )
-{
-    KK_VERIFY(image.is_valid());
-
-    const kk::Vec2f a = p_min;
-    kk::Vec2f c = p_max;
-    if (p_max == kk::Point2f_Invalid())
-    {
-        c.x = a.x + float(image.width()); // #TODO: unscale?
-        c.y = a.y + float(image.height());
-    };
+#if (KK_RENDER_OPENGL() || KK_RENDER_VULKAN())
+// Shape params go to the 2nd Vertex slot, in place of color:
+// corner radius and outline width as fixed point, 1/16 px.
+static constexpr float kSdf_Unit = 16.f;
+static constexpr std::uint16_t kSdf_Ellipse = 0xffff; // Radius value.
 
-    const kk::Vec2f uv_a = uv_min;
-    const kk::Vec2f uv_c = uv_max;
-    const kk::Vec2f b{c.x, a.y};
-    const kk::Vec2f d{a.x, c.y};
-    const kk::Vec2f uv_b{uv_c.x, uv_a.y};
-    const kk::Vec2f uv_d{uv_a.x, uv_c.y};
+static std::uint16_t Sdf_Fixed(float v)
+{
+    const float max_v = float(kSdf_Ellipse - 1);
+    return std::uint16_t((std::min)(std::round(v * kSdf_Unit), max_v));
+}
 
-    kk::Vec4f color{};
-    color.r = Normal_U8(color_.r);
-    color.g = Normal_U8(color_.g);
-    color.b = Normal_U8(color_.b);
-    color.a = Normal_U8(color_.a);
+static kk::Color Sdf_PackParams(std::uint16_t radius, std::uint16_t width)
+{
+    const std::uint16_t params[2] = {radius, width};
+    static_assert(sizeof(params) == sizeof(kk::Color));
+    kk::Color packed;
+    std::memcpy(&packed, params, sizeof(packed));
+    return packed;
+}
+#endif
 
-    auto to_ = [&color](kk::Vec2f p, kk::Vec2f uv) { return Vertex{p, uv, color}; };
-    const Vertex vertices[] =
+void KidsRender::shape_sdf(const kk::Point2f& p_center
+    , const kk::Vec2f& half_size
+    , float rounding
+    , const kk::Color& color
+    , float width
+    , const kk::Vec2f& scale
+    , const ClipRect& clip_rect
+    , CmdList* cmd_list
+    )
+{
+    KK_VERIFY((half_size.x > 0) && (half_size.y > 0));
+    KK_VERIFY(width >= 0);
+    const bool is_ellipse = (rounding < 0);
+    rounding = (std::min)((std::max)(rounding, 0.f), (std::min)(half_size.x, half_size.y));
+    width = (std::min)(width, (std::min)(half_size.x, half_size.y));
+
+#if (KK_RENDER_OPENGL() || KK_RENDER_VULKAN())
+    // Quad is 1px larger than the shape so the edge has room to fade out.
+    const float margin = (1.f / (std::min)(scale.x, scale.y));
+    const kk::Vec2f local{half_size.x + margin, half_size.y + margin};
+    const kk::Color params = Sdf_PackParams(is_ellipse ? kSdf_Ellipse : Sdf_Fixed(rounding)
+        , Sdf_Fixed(width));
+
+    // Slot 0: position, position relative to shape's center, color.
+    // Slot 1: position (again, so translation of all Vertex::p_ stays valid),
+    // half size, params.
+    auto to_ = [&](float sx, float sy, Vertex* out)
     {
-        to_(c, uv_c),
-        to_(b, uv_b),
-        to_(a, uv_a),
-        to_(d, uv_d),
+        const kk::Vec2f p{p_center.x + sx * local.x, p_center.y + sy * local.y};
+        out[0] = Vertex{p, kk::Vec2f{sx * local.x, sy * local.y}, color};
+        out[1] = Vertex{p, half_size, params};
     };
-    const Index indices[6] =
+    Vertex vertices[8];
+    to_(-1.f, -1.f, &vertices[0]);
+    to_(-1.f, +1.f, &vertices[2]);
+    to_(+1.f, +1.f, &vertices[4]);
+    to_(+1.f, -1.f, &vertices[6]);
+    const Index indices[] =
     {
         0,
         1,
@@ -535,14 +1097,155 @@ void KidsRender::image(const ImageRef& image
         0,
     };
     AddVertices(cmd_list ? *cmd_list : cmd_list_
-        , image
+        , white_1x1_
         , vertices
         , indices
         , clip_rect
-        , scale);
-}
+        , scale
+        , Primitive::SdfShapes);
+#else
+    // No SDF pipeline: tessellate. Outline is drawn inside, as with SDF.
+    const float inset = (width * 0.5f);
+    const kk::Vec2f r_outer{half_size.x - inset, half_size.y - inset};
+    const float r_corner = is_ellipse ? 0.f : (std::max)(rounding - inset, 0.f);
+    const int arc_segments = Tessellate_ArcSegments((std::max)(r_outer.x, r_outer.y)
+        , 3.1415926 * 0.5
+        , scale
+        , tessellation_tolerance_); // Per quarter.
 
-void KidsRender::bezier_cubic(
+    std::vector<kk::Point2f> points;
+    points.reserve(4 * (arc_segments + 1));
+    for (int quarter = 0; quarter < 4; ++quarter)
+    {
+        // Quarter's direction: +x+y, -x+y, -x-y, +x-y.
+        const float sx = ((quarter == 0) || (quarter == 3)) ? 1.f : -1.f;
+        const float sy = (quarter < 2) ? 1.f : -1.f;
+        for (int i = 0; i <= arc_segments; ++i)
+        {
+            const double theta = (3.1415926 * 0.5 * (quarter + double(i) / arc_segments));
+            const float cx = float(std::cos(theta));
+            const float cy = float(std::sin(theta));
+            if (is_ellipse)
+                points.push_back({p_center.x + r_outer.x * cx, p_center.y + r_outer.y * cy});
+            else
+                points.push_back(
+                    {p_center.x + sx * (r_outer.x - r_corner) + r_corner * cx
+                    , p_center.y + sy * (r_outer.y - r_corner) + r_corner * cy});
+        }
+    }
+
+    if (width > 0)
+    {
+        const bool closed = true;
+        polyline(points, color, width, closed, LineJoin::Miter, LineCap::Butt, scale, clip_rect, cmd_list);
+        return;
+    }
+    kk::Point2f prev = points.back();
+    for (const kk::Point2f& new_ : points)
+    {
+        triangle_fill(p_center
+            , new_, prev // Vulkan order, see circle_impl().
+            , color
+            , scale
+            , clip_rect
+            , cmd_list);
+        prev = new_;
+    }
+#endif
+}
+
+void KidsRender::circle_sdf(const kk::Point2f& p_center
+    , float radius
+    , const kk::Color& color    // = Color_White()
+    , float width               // = 0.f
+    , const kk::Vec2f& scale    // = kk::Vec2f{1.f, 1.f}
+    , const ClipRect& clip_rect // = {}
+    , CmdList* cmd_list         // = nullptr
+    )
+{
+    shape_sdf(p_center
+        , kk::Vec2f{radius, radius}
+        , radius
+        , color
+        , width
+        , scale
+        , clip_rect
+        , cmd_list);
+}
+
+void KidsRender::ellipse_sdf(const kk::Point2f& p_center
+    , const kk::Vec2f& radius
+    , const kk::Color& color    // = Color_White()
+    , float width               // = 0.f
+    , const kk::Vec2f& scale    // = kk::Vec2f{1.f, 1.f}
+    , const ClipRect& clip_rect // = {}
+    , CmdList* cmd_list         // = nullptr
+    )
+{
+    shape_sdf(p_center
+        , radius
+        , -1.f // Ellipse.
+        , color
+        , width
+        , scale
+        , clip_rect
+        , cmd_list);
+}
+
+void KidsRender::rect_rounded_sdf(const kk::Point2f& p_min
+    , const kk::Point2f& p_max
+    , float rounding
+    , const kk::Color& color    // = Color_White()
+    , float width               // = 0.f
+    , const kk::Vec2f& scale    // = kk::Vec2f{1.f, 1.f}
+    , const ClipRect& clip_rect // = {}
+    , CmdList* cmd_list         // = nullptr
+    )
+{
+    KK_VERIFY(rounding >= 0);
+    shape_sdf(kk::Point2f{(p_min.x + p_max.x) * 0.5f, (p_min.y + p_max.y) * 0.5f}
+        , kk::Vec2f{(p_max.x - p_min.x) * 0.5f, (p_max.y - p_min.y) * 0.5f}
+        , rounding
+        , color
+        , width
+        , scale
+        , clip_rect
+        , cmd_list);
+}
+
+void KidsRender::image(const ImageRef& image
+    , const kk::Point2f& p_min  // = kk::Point2f{0, 0}
+    , const kk::Point2f& p_max  // = kk::Point2f_Invalid() // Use image's size.
+    , const kk::Vec2f& uv_min   // = kk::Vec2f{0.f, 0.f} // Use full image to sample.
+    , const kk::Vec2f& uv_max   // = kk::Vec2f{1.f, 1.f}
+    , const kk::Color& color_   // = Color_White()
+    , const kk::Vec2f& scale    // = kk::Vec2f{1.f, 1.f}
+    , const ClipRect& clip_rect // = {}
+    , CmdList* cmd_list         // = nullptr
+    )
+{
+    KK_VERIFY(image.is_valid());
+
+    const kk::Vec2f a = p_min;
+    kk::Vec2f c = p_max;
+    if (p_max == kk::Point2f_Invalid())
+    {
+        c.x = a.x + float(image.width()); // #TODO: unscale?
+        c.y = a.y + float(image.height());
+    };
+
+    quad(image
+        , a
+        , c
+        , uv_min
+        , uv_max
+        , color_
+        , scale
+        , clip_rect
+        , cmd_list);
+}
+
+void KidsRender::bezier_cubic(
       const kk::Point2f& p1
     , const kk::Point2f& p2
     , const kk::Point2f& p3
@@ -556,7 +1259,10 @@ void KidsRender::bezier_cubic(
     )
 {
     if (segments_count <= 0)
-        segments_count = 128; // Auto-detect.
+    {
+        const kk::Point2f points[] = {p1, p2, p3, p4};
+        segments_count = Tessellate_BezierSegments(points, scale, tessellation_tolerance_);
+    }
 
     const float t_step = (1.f / segments_count);
     auto next_ = [&](int n) -> kk::Point2f
@@ -564,17 +1270,10 @@ void KidsRender::bezier_cubic(
         return ImBezierCubicCalc(p1, p2, p3, p4, t_step * n);
     };
 
-    const kk::Point2f first = next_(0);
-    kk::Point2f prev = first;
-
-    auto render_ = [&](kk::Point2f new_)
-    {
-        line(prev, new_, color, width, scale, clip_rect, cmd_list);
-        prev = new_;
-    };
-
-    for (int i_step = 1; i_step <= segments_count; ++i_step)
-        render_(next_(i_step));
+    std::vector<kk::Point2f> points(segments_count + 1);
+    for (int i_step = 0; i_step <= segments_count; ++i_step)
+        points[i_step] = next_(i_step);
+    polyline(points, color, width, false/*closed*/, LineJoin::Miter, LineCap::Butt, scale, clip_rect, cmd_list);
 }
 
 void KidsRender::bezier_quadratic(
@@ -590,7 +1289,10 @@ void KidsRender::bezier_quadratic(
     )
 {
     if (segments_count <= 0)
-        segments_count = 128; // Auto-detect.
+    {
+        const kk::Point2f points[] = {p1, p2, p3};
+        segments_count = Tessellate_BezierSegments(points, scale, tessellation_tolerance_);
+    }
 
     const float t_step = (1.f / segments_count);
     auto next_ = [&](int n) -> kk::Point2f
@@ -598,17 +1300,258 @@ void KidsRender::bezier_quadratic(
         return ImBezierQuadraticCalc(p1, p2, p3, t_step * n);
     };
 
-    const kk::Point2f first = next_(0);
-    kk::Point2f prev = first;
+    std::vector<kk::Point2f> points(segments_count + 1);
+    for (int i_step = 0; i_step <= segments_count; ++i_step)
+        points[i_step] = next_(i_step);
+    polyline(points, color, width, false/*closed*/, LineJoin::Miter, LineCap::Butt, scale, clip_rect, cmd_list);
+}
 
-    auto render_ = [&](kk::Point2f new_)
+namespace
+{
+// Left/right stroke edges at a polyline's point, as seen by one of
+// the segments; vertices are re-added if the segment ends up in
+// another DrawCmd chunk.
+struct Stroke_Edge
+{
+    kk::Point2f l;
+    kk::Point2f r;
+    Index l_index = 0;
+    Index r_index = 0;
+    std::size_t chunk = 0;
+};
+
+struct Stroke_Joint
+{
+    Stroke_Edge in;  // Segment that ends at the point.
+    Stroke_Edge out; // Segment that starts at the point.
+};
+} // namespace
+
+static float Vec2f_Cross(const kk::Vec2f& v1, const kk::Vec2f& v2)
+{
+    return (v1.x * v2.y - v1.y * v2.x);
+}
+
+// Same direction as line() offsets its edges in.
+static kk::Vec2f Stroke_Normal(const kk::Vec2f& d)
+{
+    return kk::Vec2f{+d.y, -d.x};
+}
+
+static kk::Vec2f Vec2f_Rotate(const kk::Vec2f& v, double angle)
+{
+    const float c = float(std::cos(angle));
+    const float s = float(std::sin(angle));
+    return kk::Vec2f{v.x * c - v.y * s, v.x * s + v.y * c};
+}
+
+void KidsRender::polyline(std::span<const kk::Point2f> points
+    , const kk::Color& color    // = Color_White()
+    , float width               // = 1.f
+    , bool closed                // = false
+    , LineJoin join             // = LineJoin::Miter
+    , LineCap cap               // = LineCap::Butt
+    , const kk::Vec2f& scale    // = kk::Vec2f{1.f, 1.f}
+    , const ClipRect& clip_rect // = {}
+    , CmdList* cmd_list         // = nullptr
+    )
+{
+    KK_ASSERT(width > 0.f);
+    // As in SVG: miter is cut when longer than 4 half-widths.
+    constexpr float kMiterLimit = 4.f;
+    // Flush before a joint could overflow Index; round joins/caps
+    // are at most kTessellate_MaxSegments + 3 vertices.
+    constexpr std::size_t kChunkVertices = (kMaxDrawCmdVertices - 2 * kTessellate_MaxSegments);
+
+    // Zero-length segments have no direction.
+    std::vector<kk::Point2f> path;
+    path.reserve(points.size());
+    for (const kk::Point2f& p : points)
     {
-        line(prev, new_, color, width, scale, clip_rect, cmd_list);
-        prev = new_;
+        if (path.empty() || (p != path.back()))
+            path.push_back(p);
+    }
+    if (closed && (path.size() > 2) && (path.front() == path.back()))
+        path.pop_back();
+    closed = (closed && (path.size() > 2));
+    if (path.size() < 2)
+        return;
+
+    const float hw = (width * 0.5f);
+    const std::size_t count = path.size();
+    const std::size_t segments_count = closed ? count : (count - 1);
+    auto direction = [&](std::size_t segment)
+    {
+        return Vec2f_Normalize(path[(segment + 1) % count] - path[segment]);
+    };
+
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    vertices.reserve((std::min)(kChunkVertices, 2 * count + 8));
+    indices.reserve(6 * segments_count);
+    std::size_t chunk = 0;
+
+    auto flush = [&]()
+    {
+        AddVertices(cmd_list ? *cmd_list : cmd_list_
+            , white_1x1_
+            , vertices
+            , indices
+            , clip_rect
+            , scale);
+        vertices.clear();
+        indices.clear();
+        ++chunk;
+    };
+    auto add = [&](const kk::Point2f& p) -> Index
+    {
+        vertices.push_back(Vertex_Make(p.x, p.y, color));
+        return Index(vertices.size() - 1);
+    };
+    // Same winding circle_impl() uses for Vulkan, which culls back faces.
+    auto triangle = [&](Index a, Index b, Index c)
+    {
+        const kk::Vec2f ab = (vertices[b].p_ - vertices[a].p_);
+        const kk::Vec2f ac = (vertices[c].p_ - vertices[a].p_);
+        if (Vec2f_Cross(ab, ac) > 0)
+            std::swap(b, c);
+        indices.insert(indices.end(), {a, b, c});
+    };
+    auto make_edge = [&](const kk::Point2f& l, const kk::Point2f& r) -> Stroke_Edge
+    {
+        return Stroke_Edge{l, r, add(l), add(r), chunk};
+    };
+    auto share_edge = [&](const kk::Point2f& l, const kk::Point2f& r, Index l_index, Index r_index)
+    {
+        return Stroke_Joint{Stroke_Edge{l, r, l_index, r_index, chunk}, Stroke_Edge{l, r, l_index, r_index, chunk}};
+    };
+    auto edge_to_chunk = [&](Stroke_Edge& edge)
+    {
+        if (edge.chunk != chunk)
+            edge = make_edge(edge.l, edge.r);
+    };
+    // Fan around `center` from `center + from` by `angle`.
+    auto fan = [&](const kk::Point2f& center, Index center_index
+        , const kk::Vec2f& from, Index from_index, Index to_index
+        , double angle)
+    {
+        const int steps = Tessellate_ArcSegments(hw, std::abs(angle), scale, tessellation_tolerance_);
+        Index prev = from_index;
+        for (int i = 1; i < steps; ++i)
+        {
+            const Index next = add(center + Vec2f_Rotate(from, angle * i / steps));
+            triangle(center_index, prev, next);
+            prev = next;
+        }
+        triangle(center_index, prev, to_index);
     };
 
-    for (int i_step = 1; i_step <= segments_count; ++i_step)
-        render_(next_(i_step));
+    auto make_cap = [&](const kk::Point2f& p, const kk::Vec2f& d, bool is_end) -> Stroke_Joint
+    {
+        const kk::Vec2f n = (Stroke_Normal(d) * hw);
+        const kk::Vec2f shift = ((cap == LineCap::Square) ? (d * (is_end ? hw : -hw)) : kk::Vec2f{});
+        const kk::Point2f l = (p + n + shift);
+        const kk::Point2f r = (p - n + shift);
+        const Index l_index = add(l);
+        const Index r_index = add(r);
+        if (cap == LineCap::Round)
+        {
+            // Rotating n by +90 degrees gives d: end cap goes forward, start goes back.
+            const double pi = 3.1415926;
+            fan(p, add(p), n, l_index, r_index, is_end ? pi : -pi);
+        }
+        return share_edge(l, r, l_index, r_index);
+    };
+
+    auto make_joint = [&](std::size_t i) -> Stroke_Joint
+    {
+        const kk::Point2f& p = path[i];
+        const kk::Vec2f d_in = direction((i + count - 1) % count);
+        const kk::Vec2f d_out = direction(i);
+        const kk::Vec2f n_in = Stroke_Normal(d_in);
+        const kk::Vec2f n_out = Stroke_Normal(d_out);
+
+        const kk::Vec2f m_sum = (n_in + n_out);
+        const float m_length = Vec2f_Length(m_sum);
+        // Miter vector; its length is hw / cos(half of the angle between segments).
+        const kk::Vec2f m = (m_length > 1e-6f) ? (m_sum / m_length) : n_in;
+        const float cos_half = (std::max)(Vec2f_Dot(m, n_in), 1e-6f);
+        const float miter = (hw / cos_half);
+        if ((join == LineJoin::Miter) && (miter <= (kMiterLimit * hw)))
+        {
+            const kk::Point2f l = (p + m * miter);
+            const kk::Point2f r = (p - m * miter);
+            return share_edge(l, r, add(l), add(r));
+        }
+
+        // Outer side is the one path turns away from.
+        const float side = (Vec2f_Dot(d_out, n_in) > 0) ? -1.f : +1.f;
+        // Inner corner must stay within both segments.
+        const float l_in = Vec2f_Length(p - path[(i + count - 1) % count]);
+        const float l_out = Vec2f_Length(path[(i + 1) % count] - p);
+        const float max_inner = std::sqrt(hw * hw + (std::min)(l_in, l_out) * (std::min)(l_in, l_out));
+        const kk::Point2f inner = (p - m * (side * (std::min)(miter, max_inner)));
+        const kk::Point2f outer_in = (p + n_in * (side * hw));
+        const kk::Point2f outer_out = (p + n_out * (side * hw));
+
+        const Index inner_index = add(inner);
+        const Index outer_in_index = add(outer_in);
+        const Index outer_out_index = add(outer_out);
+        const Index center_index = add(p);
+        triangle(inner_index, outer_in_index, center_index);
+        triangle(inner_index, center_index, outer_out_index);
+        if (join == LineJoin::Round)
+        {
+            const float cos_angle = (std::clamp)(Vec2f_Dot(n_in, n_out), -1.f, 1.f);
+            const double angle = std::acos(double(cos_angle)) * ((Vec2f_Cross(n_in, n_out) > 0) ? 1.0 : -1.0);
+            fan(p, center_index, n_in * (side * hw), outer_in_index, outer_out_index, angle);
+        }
+        else
+            triangle(center_index, outer_in_index, outer_out_index);
+
+        Stroke_Joint joint;
+        if (side > 0)
+        {
+            joint.in = Stroke_Edge{outer_in, inner, outer_in_index, inner_index, chunk};
+            joint.out = Stroke_Edge{outer_out, inner, outer_out_index, inner_index, chunk};
+        }
+        else
+        {
+            joint.in = Stroke_Edge{inner, outer_in, inner_index, outer_in_index, chunk};
+            joint.out = Stroke_Edge{inner, outer_out, inner_index, outer_out_index, chunk};
+        }
+        return joint;
+    };
+
+    auto segment = [&](Stroke_Edge& from, Stroke_Edge& to)
+    {
+        edge_to_chunk(from);
+        edge_to_chunk(to);
+        triangle(from.l_index, from.r_index, to.r_index);
+        triangle(from.l_index, to.r_index, to.l_index);
+    };
+
+    Stroke_Joint first = closed
+        ? make_joint(0)
+        : make_cap(path[0], direction(0), false/*is_end*/);
+    Stroke_Joint prev = first;
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        if (vertices.size() >= kChunkVertices)
+            flush();
+        Stroke_Joint joint = (closed || ((i + 1) < count))
+            ? make_joint(i)
+            : make_cap(path[i], direction(i - 1), true/*is_end*/);
+        segment(prev.out, joint.in);
+        prev = joint;
+    }
+    if (closed)
+    {
+        if (vertices.size() >= kChunkVertices)
+            flush();
+        segment(prev.out, first.in);
+    }
+    flush();
 }
 
 void KidsRender::clear()
@@ -616,6 +1559,140 @@ void KidsRender::clear()
     cmd_list_ = {};
 }
 
+void KidsRender::draw(const FrameInfo& frame_info)
+{
+    frame_stats_ = {};
+    frame_stats_.culled = cmd_list_.culled_;
+    frame_stats_.font_pages_created = std::exchange(font_pages_created_, 0);
+    draw_frame(frame_info);
+    profile_frame_end();
+}
+
+void KidsRender::profile_frame_end()
+{
+    if (profiling_)
+    {
+        frame_timings_ = {};
+        frame_timings_.frame_number = frame_number_;
+        for (std::size_t i = 0; i < std::size(profile_cpu_ms_); ++i)
+            frame_timings_.cpu_ms[i] = profile_cpu_ms_[i].exchange(0.0);
+        if (profile_pending_)
+            *profile_pending_ = frame_timings_;
+    }
+    else
+    {
+        for (std::atomic<double>& cpu_ms : profile_cpu_ms_)
+            cpu_ms.store(0.0);
+    }
+    profile_pending_ = nullptr;
+    ++frame_number_;
+}
+
+const char* ProfileStage_Name(ProfileStage stage)
+{
+    switch (stage)
+    {
+    case ProfileStage::Shape: return "Shape";
+    case ProfileStage::Build: return "Build";
+    case ProfileStage::Upload: return "Upload";
+    case ProfileStage::Submit: return "Submit";
+    case ProfileStage::Count_: break;
+    }
+    return "";
+}
+
+ProfileScope::ProfileScope(KidsRender* render, ProfileStage stage)
+    : render_{(render && render->profiling_) ? render : nullptr}
+    , stage_{stage}
+{
+    if (render_)
+        start_ = std::chrono::steady_clock::now();
+}
+
+ProfileScope::~ProfileScope() noexcept
+{
+    stop();
+}
+
+void ProfileScope::stop()
+{
+    if (!render_)
+        return;
+    const std::chrono::duration<double, std::milli> elapsed = (std::chrono::steady_clock::now() - start_);
+    render_->profile_cpu_ms_[std::size_t(stage_)].fetch_add(elapsed.count());
+    render_ = nullptr;
+}
+
+void KidsRender::set_tessellation_tolerance(float tolerance_px)
+{
+    KK_VERIFY(tolerance_px > 0);
+    tessellation_tolerance_ = tolerance_px;
+}
+
+#if (KK_RENDER_OPENGL() || KK_RENDER_VULKAN())
+// Merges runs of Quads that differ only by texture into `batch_draw_list`;
+// instance's texture unit goes to its 2nd Vertex::c_.r. Returns number
+// of DrawCmds saved.
+static std::size_t Quads_BatchTextures(CmdList& cmd_list
+    , std::vector<DrawCmd>& batch_draw_list
+    , std::vector<KidsRender::TextureSet>& texture_set_list)
+{
+    batch_draw_list.clear();
+    texture_set_list.clear();
+    auto set_unit = [&cmd_list](const DrawCmd& cmd, std::size_t unit)
+    {
+        for (unsigned i = 1; i < cmd.vertex_count_; i += 2)
+            cmd_list.vertex_list_[cmd.vertex_offset_ + i].c_.r = std::uint8_t(unit);
+    };
+    // Texture's unit in the `set`, adds it if there is a room.
+    auto find_unit = [](KidsRender::TextureSet& set, const ImageRef& texture) -> std::size_t
+    {
+        for (std::size_t unit = 0; unit < set.count; ++unit)
+        {
+            if (set.textures[unit] == texture)
+                return unit;
+        }
+        if (set.count == KidsRender::kMaxBatchTextures)
+            return set.count;
+        set.textures[set.count] = texture;
+        return set.count++;
+    };
+
+    for (const DrawCmd& cmd : cmd_list.draw_list_)
+    {
+        if ((cmd.primitive_ == Primitive::Quads) && (batch_draw_list.size() > 0))
+        {
+            DrawCmd& batch = batch_draw_list.back();
+            KidsRender::TextureSet& set = texture_set_list.back();
+            if (!batch.retained_
+                && (batch.primitive_ == Primitive::Quads)
+                && (batch.clip_rect_ == cmd.clip_rect_)
+                && (batch.scale_ == cmd.scale_)
+                && ((batch.vertex_offset_ + batch.vertex_count_) == cmd.vertex_offset_))
+            {
+                const std::size_t unit = find_unit(set, cmd.texture_);
+                if (unit < KidsRender::kMaxBatchTextures)
+                {
+                    set_unit(cmd, unit);
+                    batch.vertex_count_ += cmd.vertex_count_;
+                    continue;
+                }
+            }
+        }
+
+        batch_draw_list.push_back(cmd);
+        KidsRender::TextureSet& set = texture_set_list.emplace_back();
+        if (cmd.primitive_ == Primitive::Quads)
+        {
+            set.textures[0] = cmd.texture_;
+            set.count = 1;
+            set_unit(cmd, 0);
+        }
+    }
+    return (cmd_list.draw_list_.size() - batch_draw_list.size());
+}
+#endif
+
 #if (KK_RENDER_OPENGL())
 static const char kShader_Vertex[] =
 R"(
@@ -629,6 +1706,7 @@ uniform float ScreenWidth;
 uniform float ScreenHeight;
 uniform float ScaleX;
 uniform float ScaleY;
+uniform vec2 Translate;
 
 out vec2 Frag_UV;
 out vec4 Frag_Color;
@@ -660,7 +1738,7 @@ void main()
 {
     mat3x3 ortho = ortho2d(ScreenWidth, ScreenHeight);
     mat3x3 scale = scale2d(ScaleX, ScaleY);
-    vec3 p = ortho * scale * vec3(IN_Position, 1.0f);
+    vec3 p = ortho * scale * vec3(IN_Position + Translate, 1.0f);
     gl_Position = vec4(p, 1.0f);
 
     Frag_Color = IN_Color;
@@ -685,6 +1763,153 @@ void main()
 }
 )";
 
+// Instanced quads, see KidsRender::quad().
+static const char kShader_QuadVertex[] =
+R"(
+#version 430 core
+
+layout (location = 0) in vec2 IN_PositionMin;
+layout (location = 1) in vec2 IN_UVMin;
+layout (location = 2) in vec4 IN_Color;
+layout (location = 3) in vec2 IN_PositionMax;
+layout (location = 4) in vec2 IN_UVMax;
+layout (location = 5) in uint IN_Texture;
+
+uniform float ScreenWidth;
+uniform float ScreenHeight;
+uniform float ScaleX;
+uniform float ScaleY;
+uniform vec2 Translate;
+
+out vec2 Frag_UV;
+out vec4 Frag_Color;
+flat out uint Frag_Texture;
+
+void main()
+{
+    // Triangle strip: (min, min), (max, min), (min, max), (max, max).
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 p = (mix(IN_PositionMin, IN_PositionMax, corner) + Translate) * vec2(ScaleX, ScaleY);
+    gl_Position = vec4(2 * p.x / ScreenWidth - 1, 1 - 2 * p.y / ScreenHeight, 0, 1);
+
+    Frag_Color = IN_Color;
+    Frag_UV = mix(IN_UVMin, IN_UVMax, corner);
+    Frag_Texture = IN_Texture;
+}
+)";
+
+// Must match KidsRender::kMaxBatchTextures.
+static const char kShader_QuadFragment[] =
+R"(
+#version 430 core
+
+uniform sampler2D Textures[8];
+
+in vec2 Frag_UV;
+in vec4 Frag_Color;
+flat in uint Frag_Texture;
+
+out vec4 Out_Color;
+
+void main()
+{
+    // Frag_Texture is not dynamically uniform, so Textures[Frag_Texture]
+    // is not allowed: constant indices, with gradients taken outside of branches.
+    vec2 dx = dFdx(Frag_UV);
+    vec2 dy = dFdy(Frag_UV);
+    vec4 texel = vec4(1.0);
+    switch (Frag_Texture)
+    {
+    case 0u: texel = textureGrad(Textures[0], Frag_UV, dx, dy); break;
+    case 1u: texel = textureGrad(Textures[1], Frag_UV, dx, dy); break;
+    case 2u: texel = textureGrad(Textures[2], Frag_UV, dx, dy); break;
+    case 3u: texel = textureGrad(Textures[3], Frag_UV, dx, dy); break;
+    case 4u: texel = textureGrad(Textures[4], Frag_UV, dx, dy); break;
+    case 5u: texel = textureGrad(Textures[5], Frag_UV, dx, dy); break;
+    case 6u: texel = textureGrad(Textures[6], Frag_UV, dx, dy); break;
+    case 7u: texel = textureGrad(Textures[7], Frag_UV, dx, dy); break;
+    }
+    Out_Color = Frag_Color * texel;
+}
+)";
+
+// Analytic shapes, see KidsRender::shape_sdf().
+static const char kShader_SdfVertex[] =
+R"(
+#version 430 core
+
+layout (location = 0) in vec2 IN_Position;
+layout (location = 1) in vec2 IN_Local;
+layout (location = 2) in vec4 IN_Color;
+layout (location = 3) in vec2 IN_HalfSize;
+layout (location = 4) in vec2 IN_Params; // Radius, width; 1/16 px.
+
+uniform float ScreenWidth;
+uniform float ScreenHeight;
+uniform float ScaleX;
+uniform float ScaleY;
+uniform vec2 Translate;
+
+out vec2 Frag_Local;
+out vec4 Frag_Color;
+flat out vec2 Frag_HalfSize;
+flat out vec2 Frag_Params;
+
+void main()
+{
+    vec2 p = (IN_Position + Translate) * vec2(ScaleX, ScaleY);
+    gl_Position = vec4(2 * p.x / ScreenWidth - 1, 1 - 2 * p.y / ScreenHeight, 0, 1);
+
+    Frag_Local = IN_Local;
+    Frag_Color = IN_Color;
+    Frag_HalfSize = IN_HalfSize;
+    Frag_Params = IN_Params;
+}
+)";
+
+static const char kShader_SdfFragment[] =
+R"(
+#version 430 core
+
+in vec2 Frag_Local;
+in vec4 Frag_Color;
+flat in vec2 Frag_HalfSize;
+flat in vec2 Frag_Params;
+
+out vec4 Out_Color;
+
+const float kUnit = 1.0 / 16.0;
+const float kEllipse = 65535.0;
+
+// https://iquilezles.org/articles/distfunctions2d/
+float sd_rounded_box(vec2 p, vec2 half_size, float radius)
+{
+    vec2 q = abs(p) - half_size + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+// Approximation, exact on the edge itself which is enough for AA.
+float sd_ellipse(vec2 p, vec2 half_size)
+{
+    float k0 = length(p / half_size);
+    float k1 = length(p / (half_size * half_size));
+    return k0 * (k0 - 1.0) / max(k1, 1e-6);
+}
+
+void main()
+{
+    float d = (Frag_Params.x == kEllipse)
+        ? sd_ellipse(Frag_Local, Frag_HalfSize)
+        : sd_rounded_box(Frag_Local, Frag_HalfSize, Frag_Params.x * kUnit);
+    float width = Frag_Params.y * kUnit;
+    if (width > 0.0)
+        d = abs(d + 0.5 * width) - 0.5 * width;
+    // Distance in pixels; 1px wide transition centered on the edge.
+    float alpha = clamp(0.5 - d / max(fwidth(d), 1e-6), 0.0, 1.0);
+    Out_Color = vec4(Frag_Color.rgb, Frag_Color.a * alpha);
+}
+)";
+
 static unsigned Shaders_Link(const char* vertex_src, const char* fragment_src)
 {
     unsigned int vertex_shader = ::glCreateShader(GL_VERTEX_SHADER);
@@ -723,117 +1948,363 @@ static void Shaders_Free(unsigned shader_program)
     ::glDeleteProgram(shader_program);
 }
 
+static KidsRender::OpenGL_Program Program_Build(const char* vertex_src
+    , const char* fragment_src
+    , const char* texture_name // nullptr if program does not sample.
+    , int texture_count = 1)
+{
+    KidsRender::OpenGL_Program program;
+    program.program = Shaders_Link(vertex_src, fragment_src);
+    program.screen_width_ptr = ::glGetUniformLocation(program.program, "ScreenWidth");
+    program.screen_height_ptr = ::glGetUniformLocation(program.program, "ScreenHeight");
+    program.scale_x_ptr = ::glGetUniformLocation(program.program, "ScaleX");
+    program.scale_y_ptr = ::glGetUniformLocation(program.program, "ScaleY");
+    program.translate_ptr = ::glGetUniformLocation(program.program, "Translate");
+    KK_VERIFY(program.screen_width_ptr >= 0);
+    KK_VERIFY(program.screen_height_ptr >= 0);
+    KK_VERIFY(program.scale_x_ptr >= 0);
+    KK_VERIFY(program.scale_y_ptr >= 0);
+    KK_VERIFY(program.translate_ptr >= 0);
+    if (texture_name)
+    {
+        program.texture_ptr = ::glGetUniformLocation(program.program, texture_name);
+        program.texture_count = texture_count;
+        KK_VERIFY(program.texture_ptr >= 0);
+    }
+    return program;
+}
+
+static void VertexArray_SetFormat(std::size_t base_offset)
+{
+    ::glVertexAttribFormat(0
+        , sizeof(Vertex::p_) / sizeof(float)
+        , GL_FLOAT
+        , GL_FALSE
+        , GLuint(base_offset + offsetof(Vertex, p_)));
+    ::glVertexAttribBinding(0, 0);
+    ::glEnableVertexAttribArray(0);
+    ::glVertexAttribFormat(1
+        , sizeof(Vertex::uv_) / sizeof(float)
+        , GL_FLOAT
+        , GL_FALSE
+        , GLuint(base_offset + offsetof(Vertex, uv_)));
+    ::glVertexAttribBinding(1, 0);
+    ::glEnableVertexAttribArray(1);
+    ::glVertexAttribFormat(2
+        , sizeof(Vertex::c_) / sizeof(std::uint8_t)
+        , GL_UNSIGNED_BYTE
+        , GL_TRUE // Normalized, shader sees vec4 in [0; 1].
+        , GLuint(base_offset + offsetof(Vertex, c_)));
+    ::glVertexAttribBinding(2, 0);
+    ::glEnableVertexAttribArray(2);
+}
+
+static std::size_t StreamBuffer_GrowCapacity(std::size_t capacity, std::size_t required)
+{
+    const std::size_t kMinCapacity = (64 * 1024);
+    std::size_t new_capacity = (std::max)(capacity, kMinCapacity);
+    while (new_capacity < required)
+        new_capacity *= 2;
+    return new_capacity;
+}
+
+// Returns true if GPU still uses the buffer, without waiting for it.
+static bool StreamBuffer_IsBusy(const KidsRender::OpenGL_StreamBuffer& stream)
+{
+    if (!stream.fence)
+        return false;
+    const GLenum status = ::glClientWaitSync(stream.fence, 0, 0/*timeout*/);
+    return (status != GL_ALREADY_SIGNALED)
+        && (status != GL_CONDITION_SATISFIED);
+}
+
+static void StreamBuffer_Upload(GLenum target
+    , unsigned buffer
+    , std::size_t& capacity
+    , bool orphan
+    , const void* data
+    , std::size_t size)
+{
+    ::glBindBuffer(target, buffer);
+    if (size == 0)
+        return;
+    if (size > capacity)
+    {
+        capacity = StreamBuffer_GrowCapacity(capacity, size);
+        ::glBufferData(target, GLsizeiptr(capacity), nullptr, GL_STREAM_DRAW);
+    }
+    else if (orphan)
+    {
+        // GPU still reads previous content: ask the driver for a new storage
+        // instead of waiting (https://www.khronos.org/opengl/wiki/Buffer_Object_Streaming).
+        ::glBufferData(target, GLsizeiptr(capacity), nullptr, GL_STREAM_DRAW);
+    }
+    void* ptr = ::glMapBufferRange(target, 0, GLsizeiptr(size)
+        , GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    KK_VERIFY(ptr);
+    std::memcpy(ptr, data, size);
+    (void)::glUnmapBuffer(target);
+}
+
+static void StreamBuffer_Free(KidsRender::OpenGL_StreamBuffer& stream)
+{
+    if (stream.fence)
+        ::glDeleteSync(stream.fence);
+    ::glDeleteBuffers(1, &stream.vertex_buffer);
+    ::glDeleteBuffers(1, &stream.index_buffer);
+    stream = {};
+}
+
+// Returns uploaded size, in bytes.
+static std::size_t Retained_Upload(RetainedCmdList& retained)
+{
+    const CmdList& cmd_list = retained.cmd_list_;
+    const std::size_t vertex_size = (cmd_list.vertex_list_.size() * sizeof(Vertex));
+    const std::size_t index_size = (cmd_list.index_list_.size() * sizeof(Index));
+    // GL_COPY_WRITE_BUFFER so that VAO's GL_ELEMENT_ARRAY_BUFFER is untouched.
+    ::glBindBuffer(GL_COPY_WRITE_BUFFER, retained.vertex_buffer_);
+    ::glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(vertex_size), cmd_list.vertex_list_.data(), GL_STATIC_DRAW);
+    ::glBindBuffer(GL_COPY_WRITE_BUFFER, retained.index_buffer_);
+    ::glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(index_size), cmd_list.index_list_.data(), GL_STATIC_DRAW);
+    ::glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    retained.dirty_ = false;
+    return (vertex_size + index_size);
+}
+
+// Publishes finished queries (oldest first) and starts the next one.
+// Returns null, skipping the frame, when GPU is that far behind.
+static KidsRender::OpenGL_TimerQuery* TimerQuery_Begin(KidsRender& render)
+{
+    const std::size_t count = KidsRender::kTimerQueriesCount;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        KidsRender::OpenGL_TimerQuery& timer_query = render.timer_query_list_[(render.timer_query_index_ + i) % count];
+        if (!timer_query.pending)
+            continue;
+        GLint available = GL_FALSE;
+        ::glGetQueryObjectiv(timer_query.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        GLuint64 elapsed_ns = 0;
+        ::glGetQueryObjectui64v(timer_query.query, GL_QUERY_RESULT, &elapsed_ns);
+        timer_query.pending = false;
+        render.frame_timings_gpu_ = timer_query.timings;
+        render.frame_timings_gpu_.gpu_ms = (double(elapsed_ns) / 1e6);
+    }
+
+    KidsRender::OpenGL_TimerQuery& timer_query = render.timer_query_list_[render.timer_query_index_];
+    if (timer_query.pending)
+        return nullptr;
+    if (!timer_query.query)
+        ::glGenQueries(1, &timer_query.query);
+    render.timer_query_index_ = ((render.timer_query_index_ + 1) % count);
+    timer_query.pending = true;
+    ::glBeginQuery(GL_TIME_ELAPSED, timer_query.query);
+    return &timer_query;
+}
+
+RetainedCmdList::RetainedCmdList(KidsRender& render)
+    : render_(&render)
+{
+    ::glGenBuffers(1, &vertex_buffer_);
+    ::glGenBuffers(1, &index_buffer_);
+}
+
+RetainedCmdList::~RetainedCmdList() noexcept
+{
+    ::glDeleteBuffers(1, &vertex_buffer_);
+    ::glDeleteBuffers(1, &index_buffer_);
+}
+
 KidsRender::KidsRender() = default;
 
 KidsRender::~KidsRender() noexcept
 {
-    Shaders_Free(shader_program_);
+    for (OpenGL_StreamBuffer& stream : stream_list_)
+        StreamBuffer_Free(stream);
+    ::glDeleteVertexArrays(1, &vertex_array_);
+    ::glDeleteVertexArrays(1, &sdf_vertex_array_);
+    ::glDeleteVertexArrays(1, &quad_vertex_array_);
+    Shaders_Free(triangle_program_.program);
+    Shaders_Free(sdf_program_.program);
+    Shaders_Free(quad_program_.program);
+    for (OpenGL_TimerQuery& timer_query : timer_query_list_)
+        ::glDeleteQueries(1, &timer_query.query);
 }
 
 /*static*/ void KidsRender::Build(const RenderData& render_data, KidsRender& render)
 {
     render.render_data_ = render_data;
 
-    render.shader_program_ = Shaders_Link(kShader_Vertex, kShader_Fragment);
-
-    render.screen_width_ptr_ = ::glGetUniformLocation(render.shader_program_, "ScreenWidth");
-    render.screen_height_ptr_ = ::glGetUniformLocation(render.shader_program_, "ScreenHeight");
-    render.scale_x_ptr_ = ::glGetUniformLocation(render.shader_program_, "ScaleX");
-    render.scale_y_ptr_ = ::glGetUniformLocation(render.shader_program_, "ScaleY");
-    render.texture_ptr_ = ::glGetUniformLocation(render.shader_program_, "Texture");
-    KK_VERIFY(render.screen_width_ptr_ >= 0);
-    KK_VERIFY(render.screen_height_ptr_ >= 0);
-    KK_VERIFY(render.scale_x_ptr_ >= 0);
-    KK_VERIFY(render.scale_y_ptr_ >= 0);
-    KK_VERIFY(render.texture_ptr_ >= 0);
+    render.triangle_program_ = Program_Build(kShader_Vertex, kShader_Fragment, "Texture");
+    render.sdf_program_ = Program_Build(kShader_SdfVertex, kShader_SdfFragment, nullptr);
+    render.quad_program_ = Program_Build(kShader_QuadVertex, kShader_QuadFragment
+        , "Textures", int(kMaxBatchTextures));
+
+    // Vertex format is set once; buffers are attached per frame
+    // with glBindVertexBuffer() (see draw()).
+    ::glGenVertexArrays(1, &render.vertex_array_);
+    ::glBindVertexArray(render.vertex_array_);
+    VertexArray_SetFormat(0);
+
+    // Shape vertex is a pair of Vertex: 2nd one holds half size and params.
+    ::glGenVertexArrays(1, &render.sdf_vertex_array_);
+    ::glBindVertexArray(render.sdf_vertex_array_);
+    VertexArray_SetFormat(0);
+    ::glVertexAttribFormat(3
+        , sizeof(Vertex::uv_) / sizeof(float)
+        , GL_FLOAT
+        , GL_FALSE
+        , sizeof(Vertex) + offsetof(Vertex, uv_));
+    ::glVertexAttribBinding(3, 0);
+    ::glEnableVertexAttribArray(3);
+    ::glVertexAttribFormat(4
+        , 2
+        , GL_UNSIGNED_SHORT
+        , GL_FALSE // As is, see Sdf_PackParams().
+        , sizeof(Vertex) + offsetof(Vertex, c_));
+    ::glVertexAttribBinding(4, 0);
+    ::glEnableVertexAttribArray(4);
+
+    // Instance is a pair of Vertex: 2nd one holds max corner and uv.
+    ::glGenVertexArrays(1, &render.quad_vertex_array_);
+    ::glBindVertexArray(render.quad_vertex_array_);
+    VertexArray_SetFormat(0);
+    ::glVertexAttribFormat(3
+        , sizeof(Vertex::p_) / sizeof(float)
+        , GL_FLOAT
+        , GL_FALSE
+        , sizeof(Vertex) + offsetof(Vertex, p_));
+    ::glVertexAttribBinding(3, 0);
+    ::glEnableVertexAttribArray(3);
+    ::glVertexAttribFormat(4
+        , sizeof(Vertex::uv_) / sizeof(float)
+        , GL_FLOAT
+        , GL_FALSE
+        , sizeof(Vertex) + offsetof(Vertex, uv_));
+    ::glVertexAttribBinding(4, 0);
+    ::glEnableVertexAttribArray(4);
+    ::glVertexAttribIFormat(5
+        , 1
+        , GL_UNSIGNED_BYTE
+        , sizeof(Vertex) + offsetof(Vertex, c_) + offsetof(kk::Color, r));
+    ::glVertexAttribBinding(5, 0);
+    ::glEnableVertexAttribArray(5);
+    ::glVertexBindingDivisor(0, 1);
+    ::glBindVertexArray(0);
+
+    for (OpenGL_StreamBuffer& stream : render.stream_list_)
+    {
+        ::glGenBuffers(1, &stream.vertex_buffer);
+        ::glGenBuffers(1, &stream.index_buffer);
+    }
 
     render.white_1x1_ = Texture_White_1x1(render);
 }
 
-void KidsRender::draw(const FrameInfo& frame_info)
+void KidsRender::draw_frame(const FrameInfo& frame_info)
 {
     if (cmd_list_.draw_list_.empty())
         return;
+    OpenGL_TimerQuery* timer_query = profiling_ ? TimerQuery_Begin(*this) : nullptr;
 
-    auto upload_vertices = [this](unsigned int* VBO, unsigned int* VAO, unsigned int* EBO)
-    {
-        KK_VERIFY(cmd_list_.vertex_list_.size() > 0);
-        ::glGenVertexArrays(1, VAO);
-        ::glGenBuffers(1, VBO);
-        ::glGenBuffers(1, EBO);
-        ::glBindVertexArray(*VAO);
-        ::glBindBuffer(GL_ARRAY_BUFFER, *VBO);
-        ::glBufferData(GL_ARRAY_BUFFER
-            , cmd_list_.vertex_list_.size() * sizeof(Vertex)
-            , &cmd_list_.vertex_list_[0]
-            , GL_STATIC_DRAW);
-        ::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *EBO);
-        ::glBufferData(GL_ELEMENT_ARRAY_BUFFER
-            , cmd_list_.index_list_.size() * sizeof(Index)
-            , &cmd_list_.index_list_[0]
-            , GL_STATIC_DRAW);
-
-        ::glVertexAttribPointer(0
-            , sizeof(Vertex::p_) / sizeof(float)
-            , GL_FLOAT
-            , GL_FALSE
-            , sizeof(Vertex)
-            , (void*)offsetof(Vertex, p_));
-        ::glEnableVertexAttribArray(0);
-
-        ::glVertexAttribPointer(1
-            , sizeof(Vertex::uv_) / sizeof(float)
-            , GL_FLOAT
-            , GL_FALSE
-            , sizeof(Vertex)
-            , (void*)offsetof(Vertex, uv_));
-        ::glEnableVertexAttribArray(1);
-
-        ::glVertexAttribPointer(2
-            , sizeof(Vertex::c_) / sizeof(float)
-            , GL_FLOAT
-            , GL_FALSE
-            , sizeof(Vertex)
-            , (void*)offsetof(Vertex, c_));
-        ::glEnableVertexAttribArray(2);
-
-        ::glBindBuffer(GL_ARRAY_BUFFER, 0);
-        ::glBindVertexArray(0);
-    };
-    auto clean_up_vertices = [](unsigned int VBO, unsigned int VAO, unsigned int EBO)
+    ProfileScope build_scope{this, ProfileStage::Build};
+    if (reorder_draw_cmds_)
+        frame_stats_.draw_cmds_saved = ReorderDrawCmds(cmd_list_);
+    const std::vector<DrawCmd>* draw_list = &cmd_list_.draw_list_;
+    if (texture_batching_)
     {
-        ::glDeleteVertexArrays(1, &VAO);
-        ::glDeleteBuffers(1, &VBO);
-        ::glDeleteBuffers(1, &EBO);
-    };
+        frame_stats_.draw_cmds_saved += Quads_BatchTextures(cmd_list_, batch_draw_list_, texture_set_list_);
+        draw_list = &batch_draw_list_;
+    }
+    build_scope.stop();
 
-    unsigned int VBO = 0;
-    unsigned int VAO = 0;
-    unsigned int EBO = 0;
-    upload_vertices(&VBO, &VAO, &EBO);
+    ProfileScope upload_scope{this, ProfileStage::Upload};
+    for (const DrawCmd& cmd : cmd_list_.draw_list_)
+    {
+        if (cmd.retained_ && cmd.retained_->dirty_)
+            frame_stats_.bytes_uploaded += Retained_Upload(*cmd.retained_);
+    }
 
+    OpenGL_StreamBuffer& stream = stream_list_[stream_index_];
+    stream_index_ = ((stream_index_ + 1) % kStreamBuffersCount);
+    const bool orphan = StreamBuffer_IsBusy(stream);
+    if (stream.fence)
+    {
+        ::glDeleteSync(stream.fence);
+        stream.fence = {};
+    }
+
+    const std::size_t vertex_size = (cmd_list_.vertex_list_.size() * sizeof(Vertex));
+    const std::size_t index_size = (cmd_list_.index_list_.size() * sizeof(Index));
+
+    ::glBindVertexArray(vertex_array_);
+    StreamBuffer_Upload(GL_ARRAY_BUFFER
+        , stream.vertex_buffer
+        , stream.vertex_capacity
+        , orphan
+        , cmd_list_.vertex_list_.data()
+        , vertex_size);
+    // Binds index buffer to VAO, too.
+    StreamBuffer_Upload(GL_ELEMENT_ARRAY_BUFFER
+        , stream.index_buffer
+        , stream.index_capacity
+        , orphan
+        , cmd_list_.index_list_.data()
+        , index_size);
+    ::glBindBuffer(GL_ARRAY_BUFFER, 0);
+    ::glBindVertexBuffer(0, stream.vertex_buffer, 0, sizeof(Vertex));
+    frame_stats_.bytes_uploaded += (vertex_size + index_size);
+    upload_scope.stop();
+
+    ProfileScope submit_scope{this, ProfileStage::Submit};
     ::glEnable(GL_SCISSOR_TEST);
-    ::glUseProgram(shader_program_);
-    ::glUniform1f(screen_width_ptr_, float(frame_info.screen_size.width));
-    ::glUniform1f(screen_height_ptr_, float(frame_info.screen_size.height));
-    ::glUniform1i(texture_ptr_, 0);
+    for (const OpenGL_Program* program : {&sdf_program_, &quad_program_, &triangle_program_})
+    {
+        ::glUseProgram(program->program);
+        ::glUniform1f(program->screen_width_ptr, float(frame_info.screen_size.width));
+        ::glUniform1f(program->screen_height_ptr, float(frame_info.screen_size.height));
+        ::glUniform2f(program->translate_ptr, 0.f, 0.f);
+        static constexpr GLint kUnits[kMaxBatchTextures] = {0, 1, 2, 3, 4, 5, 6, 7};
+        if (program->texture_ptr >= 0)
+            ::glUniform1iv(program->texture_ptr, program->texture_count, kUnits);
+    }
     ::glActiveTexture(GL_TEXTURE0);
     ::glBindTexture(GL_TEXTURE_2D, white_1x1_.handle());
-    ::glBindVertexArray(VAO);
 
+    FrameStats& stats = frame_stats_;
     unsigned bound_texture = white_1x1_.handle();
-    auto bind_cmd_texture = [&bound_texture](const DrawCmd& cmd)
+    auto bind_cmd_texture = [&bound_texture, &stats](const DrawCmd& cmd)
     {
         KK_VERIFY(cmd.texture_.is_valid());
         if (cmd.texture_.handle() == bound_texture)
             return;
         ::glBindTexture(GL_TEXTURE_2D, cmd.texture_.handle());
         bound_texture = cmd.texture_.handle();
+        ++stats.texture_binds;
+    };
+    // Unit 0 is DrawCmd::texture_, see bind_cmd_texture().
+    auto bind_batch_textures = [&stats](const TextureSet& set)
+    {
+        if (set.count < 2)
+            return;
+        for (std::size_t unit = 1; unit < set.count; ++unit)
+        {
+            ::glActiveTexture(GLenum(GL_TEXTURE0 + unit));
+            ::glBindTexture(GL_TEXTURE_2D, set.textures[unit].handle());
+        }
+        ::glActiveTexture(GL_TEXTURE0);
+        stats.texture_binds += (set.count - 1);
     };
 
+    kk::Rect scissor_rect{-1, -1, -1, -1};
     auto apply_cmd_clip = [&](const DrawCmd& cmd)
     {
         const kk::Rect clip_rect = ClipRect_Transform(cmd.clip_rect_, cmd.scale_, frame_info.screen_size);
+        if (clip_rect == scissor_rect)
+            return;
+        scissor_rect = clip_rect;
+        ++stats.scissor_changes;
         const kk::Point clip_min = clip_rect.min();
         const kk::Point clip_max = clip_rect.max();
         ::glScissor(clip_min.x
@@ -844,20 +2315,98 @@ void KidsRender::draw(const FrameInfo& frame_info)
 
     static_assert(sizeof(Index) == 2); // GL_UNSIGNED_SHORT
 
-    for (const DrawCmd& cmd : cmd_list_.draw_list_)
+    // Every Primitive has own program and VAO;
+    // stream and retained lists have own buffers.
+    Primitive primitive = Primitive::Triangles;
+    const OpenGL_Program* program = &triangle_program_;
+    unsigned vertex_buffer = stream.vertex_buffer;
+    unsigned index_buffer = stream.index_buffer;
+    auto bind_cmd_buffers = [&](const DrawCmd& cmd)
+    {
+        if (cmd.primitive_ != primitive)
+        {
+            primitive = cmd.primitive_;
+            unsigned vertex_array = vertex_array_;
+            switch (primitive)
+            {
+            case Primitive::Triangles: program = &triangle_program_; vertex_array = vertex_array_; break;
+            case Primitive::SdfShapes: program = &sdf_program_; vertex_array = sdf_vertex_array_; break;
+            case Primitive::Quads: program = &quad_program_; vertex_array = quad_vertex_array_; break;
+            }
+            ::glUseProgram(program->program);
+            ::glBindVertexArray(vertex_array);
+            ::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+            if (primitive == Primitive::Triangles)
+                ::glBindVertexBuffer(0, vertex_buffer, 0, sizeof(Vertex));
+        }
+        if (primitive != Primitive::Triangles)
+        {
+            // 2 Vertex wide: no base vertex/instance with such a stride,
+            // so offset the binding instead.
+            ::glBindVertexBuffer(0, vertex_buffer
+                , GLintptr(cmd.vertex_offset_ * sizeof(Vertex)), 2 * sizeof(Vertex));
+        }
+    };
+    auto bind_buffers = [&](unsigned new_vertex_buffer, unsigned new_index_buffer)
     {
-        ::glUniform1f(scale_x_ptr_, cmd.scale_.x);
-        ::glUniform1f(scale_y_ptr_, cmd.scale_.y);
+        vertex_buffer = new_vertex_buffer;
+        index_buffer = new_index_buffer;
+        ::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+        if (primitive == Primitive::Triangles)
+            ::glBindVertexBuffer(0, vertex_buffer, 0, sizeof(Vertex));
+    };
+
+    auto draw_cmd = [&](const DrawCmd& cmd, const kk::Point2f& translate)
+    {
+        ++stats.draw_cmds;
+        stats.vertices += cmd.vertex_count_;
+        stats.indices += cmd.index_count_;
+        bind_cmd_buffers(cmd);
+        ::glUniform1f(program->scale_x_ptr, cmd.scale_.x);
+        ::glUniform1f(program->scale_y_ptr, cmd.scale_.y);
+        ::glUniform2f(program->translate_ptr, translate.x, translate.y);
         bind_cmd_texture(cmd);
         apply_cmd_clip(cmd);
 
+        if (cmd.primitive_ == Primitive::Quads)
+        {
+            ::glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(cmd.vertex_count_ / 2));
+            return;
+        }
         void* const indices_offset = (void*)std::uintptr_t(cmd.index_offset_ * sizeof(Index));
-        ::glDrawElements(GL_TRIANGLES, cmd.index_count_, GL_UNSIGNED_SHORT, indices_offset);
+        ::glDrawElementsBaseVertex(GL_TRIANGLES, cmd.index_count_, GL_UNSIGNED_SHORT, indices_offset
+            , (cmd.primitive_ == Primitive::Triangles) ? GLint(cmd.vertex_offset_) : 0);
+    };
+
+    ::glUseProgram(program->program);
+    for (std::size_t i = 0; i < draw_list->size(); ++i)
+    {
+        const DrawCmd& cmd = (*draw_list)[i];
+        if (!cmd.retained_)
+        {
+            if (texture_batching_)
+                bind_batch_textures(texture_set_list_[i]);
+            draw_cmd(cmd, kk::Point2f{});
+            continue;
+        }
+
+        const RetainedCmdList& retained = *cmd.retained_;
+        bind_buffers(retained.vertex_buffer_, retained.index_buffer_);
+        for (const DrawCmd& retained_cmd : retained.cmd_list_.draw_list_)
+            draw_cmd(DrawCmd_FromRetained(cmd, retained_cmd), cmd.retained_translate_);
+        bind_buffers(stream.vertex_buffer, stream.index_buffer);
     }
 
     ::glDisable(GL_SCISSOR_TEST);
+    ::glBindVertexArray(0);
 
-    clean_up_vertices(VBO, VAO, EBO);
+    // Next time this buffer is reused, we check if GPU is done with it.
+    stream.fence = ::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (timer_query)
+    {
+        ::glEndQuery(GL_TIME_ELAPSED);
+        profile_pending_ = &timer_query->timings;
+    }
 }
 #endif
 
@@ -879,6 +2428,8 @@ layout(push_constant) uniform constants
     float ScreenHeight;
     float ScaleX;
     float ScaleY;
+    float TranslateX;
+    float TranslateY;
 }
 PushConstants;
 
@@ -909,7 +2460,8 @@ void main()
 {
     mat3x3 orhto = ortho2d(PushConstants.ScreenWidth, PushConstants.ScreenHeight);
     mat3x3 scale = scale2d(PushConstants.ScaleX, PushConstants.ScaleY);
-    vec3 p = orhto * scale * vec3(IN_Position, 1.0f);
+    vec2 translate = vec2(PushConstants.TranslateX, PushConstants.TranslateY);
+    vec3 p = orhto * scale * vec3(IN_Position + translate, 1.0f);
     gl_Position = vec4(p, 1.0f);
 
     Frag_Color = IN_Color;
@@ -920,68 +2472,48 @@ void main()
 // glslangValidator -V -x -o shader.vert.u32 shader.vert
 static const uint32_t kShader_Vertex[] =
 {
-    // 1011.9.0
-    0x07230203,0x00010000,0x0008000a,0x00000086,0x00000000,0x00020011,0x00000001,0x0006000b,
+    0x07230203,0x00010000,0x0008000b,0x00000091,0x00000000,0x00020011,0x00000001,0x0006000b,
     0x00000001,0x4c534c47,0x6474732e,0x3035342e,0x00000000,0x0003000e,0x00000000,0x00000001,
-    0x000b000f,0x00000000,0x00000004,0x6e69616d,0x00000000,0x0000006c,0x00000076,0x0000007e,
-    0x00000080,0x00000083,0x00000084,0x00030003,0x00000002,0x000001c2,0x00040005,0x00000004,
-    0x6e69616d,0x00000000,0x00060005,0x0000000d,0x6874726f,0x2864326f,0x663b3166,0x00003b31,
-    0x00060005,0x0000000b,0x65726373,0x775f6e65,0x68746469,0x00000000,0x00060005,0x0000000c,
-    0x65726373,0x685f6e65,0x68676965,0x00000074,0x00060005,0x00000011,0x6c616373,0x28643265,
-    0x663b3166,0x00003b31,0x00040005,0x0000000f,0x6c616373,0x00785f65,0x00040005,0x00000010,
-    0x6c616373,0x00795f65,0x00040005,0x00000013,0x7466656c,0x00000000,0x00040005,0x00000015,
-    0x68676972,0x00000074,0x00030005,0x00000017,0x00706f74,0x00040005,0x00000019,0x74746f62,
-    0x00006d6f,0x00030005,0x0000001b,0x0000006d,0x00030005,0x00000048,0x0000006d,0x00040005,
-    0x00000050,0x7468726f,0x0000006f,0x00050005,0x00000051,0x736e6f63,0x746e6174,0x00000073,
-    0x00060006,0x00000051,0x00000000,0x65726353,0x69576e65,0x00687464,0x00070006,0x00000051,
-    0x00000001,0x65726353,0x65486e65,0x74686769,0x00000000,0x00050006,0x00000051,0x00000002,
-    0x6c616353,0x00005865,0x00050006,0x00000051,0x00000003,0x6c616353,0x00005965,0x00060005,
-    0x00000053,0x68737550,0x736e6f43,0x746e6174,0x00000073,0x00040005,0x00000054,0x61726170,
-    0x0000006d,0x00040005,0x00000058,0x61726170,0x0000006d,0x00040005,0x0000005c,0x6c616373,
-    0x00000065,0x00040005,0x0000005e,0x61726170,0x0000006d,0x00040005,0x00000061,0x61726170,
-    0x0000006d,0x00030005,0x00000066,0x00000070,0x00050005,0x0000006c,0x505f4e49,0x7469736f,
-    0x006e6f69,0x00060005,0x00000074,0x505f6c67,0x65567265,0x78657472,0x00000000,0x00060006,
-    0x00000074,0x00000000,0x505f6c67,0x7469736f,0x006e6f69,0x00070006,0x00000074,0x00000001,
-    0x505f6c67,0x746e696f,0x657a6953,0x00000000,0x00070006,0x00000074,0x00000002,0x435f6c67,
-    0x4470696c,0x61747369,0x0065636e,0x00070006,0x00000074,0x00000003,0x435f6c67,0x446c6c75,
-    0x61747369,0x0065636e,0x00030005,0x00000076,0x00000000,0x00050005,0x0000007e,0x67617246,
-    0x6c6f435f,0x0000726f,0x00050005,0x00000080,0x435f4e49,0x726f6c6f,0x00000000,0x00040005,
-    0x00000083,0x67617246,0x0056555f,0x00040005,0x00000084,0x555f4e49,0x00000056,0x00050048,
-    0x00000051,0x00000000,0x00000023,0x00000000,0x00050048,0x00000051,0x00000001,0x00000023,
-    0x00000004,0x00050048,0x00000051,0x00000002,0x00000023,0x00000008,0x00050048,0x00000051,
-    0x00000003,0x00000023,0x0000000c,0x00030047,0x00000051,0x00000002,0x00040047,0x0000006c,
-    0x0000001e,0x00000000,0x00050048,0x00000074,0x00000000,0x0000000b,0x00000000,0x00050048,
-    0x00000074,0x00000001,0x0000000b,0x00000001,0x00050048,0x00000074,0x00000002,0x0000000b,
-    0x00000003,0x00050048,0x00000074,0x00000003,0x0000000b,0x00000004,0x00030047,0x00000074,
-    0x00000002,0x00040047,0x0000007e,0x0000001e,0x00000001,0x00040047,0x00000080,0x0000001e,
-    0x00000002,0x00040047,0x00000083,0x0000001e,0x00000000,0x00040047,0x00000084,0x0000001e,
-    0x00000001,0x00020013,0x00000002,0x00030021,0x00000003,0x00000002,0x00030016,0x00000006,
-    0x00000020,0x00040020,0x00000007,0x00000007,0x00000006,0x00040017,0x00000008,0x00000006,
-    0x00000003,0x00040018,0x00000009,0x00000008,0x00000003,0x00050021,0x0000000a,0x00000009,
-    0x00000007,0x00000007,0x0004002b,0x00000006,0x00000014,0x00000000,0x00040020,0x0000001a,
-    0x00000007,0x00000009,0x0004002b,0x00000006,0x0000001c,0x3f800000,0x0006002c,0x00000008,
-    0x0000001d,0x0000001c,0x00000014,0x00000014,0x0006002c,0x00000008,0x0000001e,0x00000014,
-    0x0000001c,0x00000014,0x0006002c,0x00000008,0x0000001f,0x00000014,0x00000014,0x0000001c,
-    0x0006002c,0x00000009,0x00000020,0x0000001d,0x0000001e,0x0000001f,0x00040015,0x00000021,
-    0x00000020,0x00000001,0x0004002b,0x00000021,0x00000022,0x00000000,0x0004002b,0x00000006,
-    0x00000023,0x40000000,0x00040015,0x00000028,0x00000020,0x00000000,0x0004002b,0x00000028,
-    0x00000029,0x00000000,0x0004002b,0x00000021,0x0000002b,0x00000001,0x0004002b,0x00000028,
-    0x00000030,0x00000001,0x0004002b,0x00000021,0x00000032,0x00000002,0x0006001e,0x00000051,
+    0x000b000f,0x00000000,0x00000004,0x6e69616d,0x00000000,0x00000075,0x00000081,0x00000089,
+    0x0000008b,0x0000008e,0x0000008f,0x00030047,0x00000051,0x00000002,0x00050048,0x00000051,
+    0x00000000,0x00000023,0x00000000,0x00050048,0x00000051,0x00000001,0x00000023,0x00000004,
+    0x00050048,0x00000051,0x00000002,0x00000023,0x00000008,0x00050048,0x00000051,0x00000003,
+    0x00000023,0x0000000c,0x00050048,0x00000051,0x00000004,0x00000023,0x00000010,0x00050048,
+    0x00000051,0x00000005,0x00000023,0x00000014,0x00040047,0x00000075,0x0000001e,0x00000000,
+    0x00030047,0x0000007f,0x00000002,0x00050048,0x0000007f,0x00000000,0x0000000b,0x00000000,
+    0x00050048,0x0000007f,0x00000001,0x0000000b,0x00000001,0x00050048,0x0000007f,0x00000002,
+    0x0000000b,0x00000003,0x00050048,0x0000007f,0x00000003,0x0000000b,0x00000004,0x00040047,
+    0x00000089,0x0000001e,0x00000001,0x00040047,0x0000008b,0x0000001e,0x00000002,0x00040047,
+    0x0000008e,0x0000001e,0x00000000,0x00040047,0x0000008f,0x0000001e,0x00000001,0x00020013,
+    0x00000002,0x00030021,0x00000003,0x00000002,0x00030016,0x00000006,0x00000020,0x00040020,
+    0x00000007,0x00000007,0x00000006,0x00040017,0x00000008,0x00000006,0x00000003,0x00040018,
+    0x00000009,0x00000008,0x00000003,0x00050021,0x0000000a,0x00000009,0x00000007,0x00000007,
+    0x0004002b,0x00000006,0x00000014,0x00000000,0x00040020,0x0000001a,0x00000007,0x00000009,
+    0x0004002b,0x00000006,0x0000001c,0x3f800000,0x0006002c,0x00000008,0x0000001d,0x0000001c,
+    0x00000014,0x00000014,0x0006002c,0x00000008,0x0000001e,0x00000014,0x0000001c,0x00000014,
+    0x0006002c,0x00000008,0x0000001f,0x00000014,0x00000014,0x0000001c,0x0006002c,0x00000009,
+    0x00000020,0x0000001d,0x0000001e,0x0000001f,0x00040015,0x00000021,0x00000020,0x00000001,
+    0x0004002b,0x00000021,0x00000022,0x00000000,0x0004002b,0x00000006,0x00000023,0x40000000,
+    0x00040015,0x00000028,0x00000020,0x00000000,0x0004002b,0x00000028,0x00000029,0x00000000,
+    0x0004002b,0x00000021,0x0000002b,0x00000001,0x0004002b,0x00000028,0x00000030,0x00000001,
+    0x0004002b,0x00000021,0x00000032,0x00000002,0x0008001e,0x00000051,0x00000006,0x00000006,
     0x00000006,0x00000006,0x00000006,0x00000006,0x00040020,0x00000052,0x00000009,0x00000051,
     0x0004003b,0x00000052,0x00000053,0x00000009,0x00040020,0x00000055,0x00000009,0x00000006,
-    0x0004002b,0x00000021,0x0000005d,0x00000003,0x00040020,0x00000065,0x00000007,0x00000008,
-    0x00040017,0x0000006a,0x00000006,0x00000002,0x00040020,0x0000006b,0x00000001,0x0000006a,
-    0x0004003b,0x0000006b,0x0000006c,0x00000001,0x00040017,0x00000072,0x00000006,0x00000004,
-    0x0004001c,0x00000073,0x00000006,0x00000030,0x0006001e,0x00000074,0x00000072,0x00000006,
-    0x00000073,0x00000073,0x00040020,0x00000075,0x00000003,0x00000074,0x0004003b,0x00000075,
-    0x00000076,0x00000003,0x00040020,0x0000007c,0x00000003,0x00000072,0x0004003b,0x0000007c,
-    0x0000007e,0x00000003,0x00040020,0x0000007f,0x00000001,0x00000072,0x0004003b,0x0000007f,
-    0x00000080,0x00000001,0x00040020,0x00000082,0x00000003,0x0000006a,0x0004003b,0x00000082,
-    0x00000083,0x00000003,0x0004003b,0x0000006b,0x00000084,0x00000001,0x00050036,0x00000002,
-    0x00000004,0x00000000,0x00000003,0x000200f8,0x00000005,0x0004003b,0x0000001a,0x00000050,
-    0x00000007,0x0004003b,0x00000007,0x00000054,0x00000007,0x0004003b,0x00000007,0x00000058,
-    0x00000007,0x0004003b,0x0000001a,0x0000005c,0x00000007,0x0004003b,0x00000007,0x0000005e,
-    0x00000007,0x0004003b,0x00000007,0x00000061,0x00000007,0x0004003b,0x00000065,0x00000066,
+    0x0004002b,0x00000021,0x0000005d,0x00000003,0x00040017,0x00000065,0x00000006,0x00000002,
+    0x00040020,0x00000066,0x00000007,0x00000065,0x0004002b,0x00000021,0x00000068,0x00000004,
+    0x0004002b,0x00000021,0x0000006b,0x00000005,0x00040020,0x0000006f,0x00000007,0x00000008,
+    0x00040020,0x00000074,0x00000001,0x00000065,0x0004003b,0x00000074,0x00000075,0x00000001,
+    0x00040017,0x0000007d,0x00000006,0x00000004,0x0004001c,0x0000007e,0x00000006,0x00000030,
+    0x0006001e,0x0000007f,0x0000007d,0x00000006,0x0000007e,0x0000007e,0x00040020,0x00000080,
+    0x00000003,0x0000007f,0x0004003b,0x00000080,0x00000081,0x00000003,0x00040020,0x00000087,
+    0x00000003,0x0000007d,0x0004003b,0x00000087,0x00000089,0x00000003,0x00040020,0x0000008a,
+    0x00000001,0x0000007d,0x0004003b,0x0000008a,0x0000008b,0x00000001,0x00040020,0x0000008d,
+    0x00000003,0x00000065,0x0004003b,0x0000008d,0x0000008e,0x00000003,0x0004003b,0x00000074,
+    0x0000008f,0x00000001,0x00050036,0x00000002,0x00000004,0x00000000,0x00000003,0x000200f8,
+    0x00000005,0x0004003b,0x0000001a,0x00000050,0x00000007,0x0004003b,0x00000007,0x00000054,
+    0x00000007,0x0004003b,0x00000007,0x00000058,0x00000007,0x0004003b,0x0000001a,0x0000005c,
+    0x00000007,0x0004003b,0x00000007,0x0000005e,0x00000007,0x0004003b,0x00000007,0x00000061,
+    0x00000007,0x0004003b,0x00000066,0x00000067,0x00000007,0x0004003b,0x0000006f,0x00000070,
     0x00000007,0x00050041,0x00000055,0x00000056,0x00000053,0x00000022,0x0004003d,0x00000006,
     0x00000057,0x00000056,0x0003003e,0x00000054,0x00000057,0x00050041,0x00000055,0x00000059,
     0x00000053,0x0000002b,0x0004003d,0x00000006,0x0000005a,0x00000059,0x0003003e,0x00000058,
@@ -990,50 +2522,55 @@ static const uint32_t kShader_Vertex[] =
     0x00000006,0x00000060,0x0000005f,0x0003003e,0x0000005e,0x00000060,0x00050041,0x00000055,
     0x00000062,0x00000053,0x0000005d,0x0004003d,0x00000006,0x00000063,0x00000062,0x0003003e,
     0x00000061,0x00000063,0x00060039,0x00000009,0x00000064,0x00000011,0x0000005e,0x00000061,
-    0x0003003e,0x0000005c,0x00000064,0x0004003d,0x00000009,0x00000067,0x00000050,0x0004003d,
-    0x00000009,0x00000068,0x0000005c,0x00050092,0x00000009,0x00000069,0x00000067,0x00000068,
-    0x0004003d,0x0000006a,0x0000006d,0x0000006c,0x00050051,0x00000006,0x0000006e,0x0000006d,
-    0x00000000,0x00050051,0x00000006,0x0000006f,0x0000006d,0x00000001,0x00060050,0x00000008,
-    0x00000070,0x0000006e,0x0000006f,0x0000001c,0x00050091,0x00000008,0x00000071,0x00000069,
-    0x00000070,0x0003003e,0x00000066,0x00000071,0x0004003d,0x00000008,0x00000077,0x00000066,
-    0x00050051,0x00000006,0x00000078,0x00000077,0x00000000,0x00050051,0x00000006,0x00000079,
-    0x00000077,0x00000001,0x00050051,0x00000006,0x0000007a,0x00000077,0x00000002,0x00070050,
-    0x00000072,0x0000007b,0x00000078,0x00000079,0x0000007a,0x0000001c,0x00050041,0x0000007c,
-    0x0000007d,0x00000076,0x00000022,0x0003003e,0x0000007d,0x0000007b,0x0004003d,0x00000072,
-    0x00000081,0x00000080,0x0003003e,0x0000007e,0x00000081,0x0004003d,0x0000006a,0x00000085,
-    0x00000084,0x0003003e,0x00000083,0x00000085,0x000100fd,0x00010038,0x00050036,0x00000009,
-    0x0000000d,0x00000000,0x0000000a,0x00030037,0x00000007,0x0000000b,0x00030037,0x00000007,
-    0x0000000c,0x000200f8,0x0000000e,0x0004003b,0x00000007,0x00000013,0x00000007,0x0004003b,
-    0x00000007,0x00000015,0x00000007,0x0004003b,0x00000007,0x00000017,0x00000007,0x0004003b,
-    0x00000007,0x00000019,0x00000007,0x0004003b,0x0000001a,0x0000001b,0x00000007,0x0003003e,
-    0x00000013,0x00000014,0x0004003d,0x00000006,0x00000016,0x0000000b,0x0003003e,0x00000015,
-    0x00000016,0x0004003d,0x00000006,0x00000018,0x0000000c,0x0003003e,0x00000017,0x00000018,
-    0x0003003e,0x00000019,0x00000014,0x0003003e,0x0000001b,0x00000020,0x0004003d,0x00000006,
-    0x00000024,0x00000015,0x0004003d,0x00000006,0x00000025,0x00000013,0x00050083,0x00000006,
-    0x00000026,0x00000024,0x00000025,0x00050088,0x00000006,0x00000027,0x00000023,0x00000026,
-    0x00060041,0x00000007,0x0000002a,0x0000001b,0x00000022,0x00000029,0x0003003e,0x0000002a,
-    0x00000027,0x0004003d,0x00000006,0x0000002c,0x00000017,0x0004003d,0x00000006,0x0000002d,
-    0x00000019,0x00050083,0x00000006,0x0000002e,0x0000002c,0x0000002d,0x00050088,0x00000006,
-    0x0000002f,0x00000023,0x0000002e,0x00060041,0x00000007,0x00000031,0x0000001b,0x0000002b,
-    0x00000030,0x0003003e,0x00000031,0x0000002f,0x0004003d,0x00000006,0x00000033,0x00000015,
-    0x0004003d,0x00000006,0x00000034,0x00000013,0x00050081,0x00000006,0x00000035,0x00000033,
-    0x00000034,0x0004007f,0x00000006,0x00000036,0x00000035,0x0004003d,0x00000006,0x00000037,
-    0x00000015,0x0004003d,0x00000006,0x00000038,0x00000013,0x00050083,0x00000006,0x00000039,
-    0x00000037,0x00000038,0x00050088,0x00000006,0x0000003a,0x00000036,0x00000039,0x00060041,
-    0x00000007,0x0000003b,0x0000001b,0x00000032,0x00000029,0x0003003e,0x0000003b,0x0000003a,
-    0x0004003d,0x00000006,0x0000003c,0x00000017,0x0004003d,0x00000006,0x0000003d,0x00000019,
-    0x00050081,0x00000006,0x0000003e,0x0000003c,0x0000003d,0x0004007f,0x00000006,0x0000003f,
-    0x0000003e,0x0004003d,0x00000006,0x00000040,0x00000017,0x0004003d,0x00000006,0x00000041,
-    0x00000019,0x00050083,0x00000006,0x00000042,0x00000040,0x00000041,0x00050088,0x00000006,
-    0x00000043,0x0000003f,0x00000042,0x00060041,0x00000007,0x00000044,0x0000001b,0x00000032,
-    0x00000030,0x0003003e,0x00000044,0x00000043,0x0004003d,0x00000009,0x00000045,0x0000001b,
-    0x000200fe,0x00000045,0x00010038,0x00050036,0x00000009,0x00000011,0x00000000,0x0000000a,
-    0x00030037,0x00000007,0x0000000f,0x00030037,0x00000007,0x00000010,0x000200f8,0x00000012,
-    0x0004003b,0x0000001a,0x00000048,0x00000007,0x0003003e,0x00000048,0x00000020,0x0004003d,
-    0x00000006,0x00000049,0x0000000f,0x00060041,0x00000007,0x0000004a,0x00000048,0x00000022,
-    0x00000029,0x0003003e,0x0000004a,0x00000049,0x0004003d,0x00000006,0x0000004b,0x00000010,
-    0x00060041,0x00000007,0x0000004c,0x00000048,0x0000002b,0x00000030,0x0003003e,0x0000004c,
-    0x0000004b,0x0004003d,0x00000009,0x0000004d,0x00000048,0x000200fe,0x0000004d,0x00010038
+    0x0003003e,0x0000005c,0x00000064,0x00050041,0x00000055,0x00000069,0x00000053,0x00000068,
+    0x0004003d,0x00000006,0x0000006a,0x00000069,0x00050041,0x00000055,0x0000006c,0x00000053,
+    0x0000006b,0x0004003d,0x00000006,0x0000006d,0x0000006c,0x00050050,0x00000065,0x0000006e,
+    0x0000006a,0x0000006d,0x0003003e,0x00000067,0x0000006e,0x0004003d,0x00000009,0x00000071,
+    0x00000050,0x0004003d,0x00000009,0x00000072,0x0000005c,0x00050092,0x00000009,0x00000073,
+    0x00000071,0x00000072,0x0004003d,0x00000065,0x00000076,0x00000075,0x0004003d,0x00000065,
+    0x00000077,0x00000067,0x00050081,0x00000065,0x00000078,0x00000076,0x00000077,0x00050051,
+    0x00000006,0x00000079,0x00000078,0x00000000,0x00050051,0x00000006,0x0000007a,0x00000078,
+    0x00000001,0x00060050,0x00000008,0x0000007b,0x00000079,0x0000007a,0x0000001c,0x00050091,
+    0x00000008,0x0000007c,0x00000073,0x0000007b,0x0003003e,0x00000070,0x0000007c,0x0004003d,
+    0x00000008,0x00000082,0x00000070,0x00050051,0x00000006,0x00000083,0x00000082,0x00000000,
+    0x00050051,0x00000006,0x00000084,0x00000082,0x00000001,0x00050051,0x00000006,0x00000085,
+    0x00000082,0x00000002,0x00070050,0x0000007d,0x00000086,0x00000083,0x00000084,0x00000085,
+    0x0000001c,0x00050041,0x00000087,0x00000088,0x00000081,0x00000022,0x0003003e,0x00000088,
+    0x00000086,0x0004003d,0x0000007d,0x0000008c,0x0000008b,0x0003003e,0x00000089,0x0000008c,
+    0x0004003d,0x00000065,0x00000090,0x0000008f,0x0003003e,0x0000008e,0x00000090,0x000100fd,
+    0x00010038,0x00050036,0x00000009,0x0000000d,0x00000000,0x0000000a,0x00030037,0x00000007,
+    0x0000000b,0x00030037,0x00000007,0x0000000c,0x000200f8,0x0000000e,0x0004003b,0x00000007,
+    0x00000013,0x00000007,0x0004003b,0x00000007,0x00000015,0x00000007,0x0004003b,0x00000007,
+    0x00000017,0x00000007,0x0004003b,0x00000007,0x00000019,0x00000007,0x0004003b,0x0000001a,
+    0x0000001b,0x00000007,0x0003003e,0x00000013,0x00000014,0x0004003d,0x00000006,0x00000016,
+    0x0000000b,0x0003003e,0x00000015,0x00000016,0x0004003d,0x00000006,0x00000018,0x0000000c,
+    0x0003003e,0x00000017,0x00000018,0x0003003e,0x00000019,0x00000014,0x0003003e,0x0000001b,
+    0x00000020,0x0004003d,0x00000006,0x00000024,0x00000015,0x0004003d,0x00000006,0x00000025,
+    0x00000013,0x00050083,0x00000006,0x00000026,0x00000024,0x00000025,0x00050088,0x00000006,
+    0x00000027,0x00000023,0x00000026,0x00060041,0x00000007,0x0000002a,0x0000001b,0x00000022,
+    0x00000029,0x0003003e,0x0000002a,0x00000027,0x0004003d,0x00000006,0x0000002c,0x00000017,
+    0x0004003d,0x00000006,0x0000002d,0x00000019,0x00050083,0x00000006,0x0000002e,0x0000002c,
+    0x0000002d,0x00050088,0x00000006,0x0000002f,0x00000023,0x0000002e,0x00060041,0x00000007,
+    0x00000031,0x0000001b,0x0000002b,0x00000030,0x0003003e,0x00000031,0x0000002f,0x0004003d,
+    0x00000006,0x00000033,0x00000015,0x0004003d,0x00000006,0x00000034,0x00000013,0x00050081,
+    0x00000006,0x00000035,0x00000033,0x00000034,0x0004007f,0x00000006,0x00000036,0x00000035,
+    0x0004003d,0x00000006,0x00000037,0x00000015,0x0004003d,0x00000006,0x00000038,0x00000013,
+    0x00050083,0x00000006,0x00000039,0x00000037,0x00000038,0x00050088,0x00000006,0x0000003a,
+    0x00000036,0x00000039,0x00060041,0x00000007,0x0000003b,0x0000001b,0x00000032,0x00000029,
+    0x0003003e,0x0000003b,0x0000003a,0x0004003d,0x00000006,0x0000003c,0x00000017,0x0004003d,
+    0x00000006,0x0000003d,0x00000019,0x00050081,0x00000006,0x0000003e,0x0000003c,0x0000003d,
+    0x0004007f,0x00000006,0x0000003f,0x0000003e,0x0004003d,0x00000006,0x00000040,0x00000017,
+    0x0004003d,0x00000006,0x00000041,0x00000019,0x00050083,0x00000006,0x00000042,0x00000040,
+    0x00000041,0x00050088,0x00000006,0x00000043,0x0000003f,0x00000042,0x00060041,0x00000007,
+    0x00000044,0x0000001b,0x00000032,0x00000030,0x0003003e,0x00000044,0x00000043,0x0004003d,
+    0x00000009,0x00000045,0x0000001b,0x000200fe,0x00000045,0x00010038,0x00050036,0x00000009,
+    0x00000011,0x00000000,0x0000000a,0x00030037,0x00000007,0x0000000f,0x00030037,0x00000007,
+    0x00000010,0x000200f8,0x00000012,0x0004003b,0x0000001a,0x00000048,0x00000007,0x0003003e,
+    0x00000048,0x00000020,0x0004003d,0x00000006,0x00000049,0x0000000f,0x00060041,0x00000007,
+    0x0000004a,0x00000048,0x00000022,0x00000029,0x0003003e,0x0000004a,0x00000049,0x0004003d,
+    0x00000006,0x0000004b,0x00000010,0x00060041,0x00000007,0x0000004c,0x00000048,0x0000002b,
+    0x00000030,0x0003003e,0x0000004c,0x0000004b,0x0004003d,0x00000009,0x0000004d,0x00000048,
+    0x000200fe,0x0000004d,0x00010038
 };
 
 // shader.frag
@@ -1089,22 +2626,521 @@ static const uint32_t kShader_Fragment[] =
     0x0000001b,0x0003003e,0x00000009,0x0000001c,0x000100fd,0x00010038
 };
 
+// shader_quad.vert: instanced quads, see KidsRender::quad().
+// Goes with shader.frag or shader_quad_batch.frag.
+#if (0)
+#version 450
+
+layout(location = 0) in vec2 IN_PositionMin;
+layout(location = 1) in vec2 IN_UVMin;
+layout(location = 2) in vec4 IN_Color;
+layout(location = 3) in vec2 IN_PositionMax;
+layout(location = 4) in vec2 IN_UVMax;
+layout(location = 5) in uint IN_Texture;
+
+layout(location = 0) out vec2 Frag_UV;
+layout(location = 1) out vec4 Frag_Color;
+layout(location = 2) flat out uint Frag_Texture; // See shader_quad_batch.frag.
+
+layout(push_constant) uniform constants
+{
+    float ScreenWidth;
+    float ScreenHeight;
+    float ScaleX;
+    float ScaleY;
+    float TranslateX;
+    float TranslateY;
+}
+PushConstants;
+
+void main()
+{
+    // Triangle strip: (min, min), (min, max), (max, min), (max, max),
+    // counterclockwise as triangles of shader.vert.
+    vec2 corner = vec2(gl_VertexIndex >> 1, gl_VertexIndex & 1);
+    vec2 translate = vec2(PushConstants.TranslateX, PushConstants.TranslateY);
+    vec2 scale = vec2(PushConstants.ScaleX, PushConstants.ScaleY);
+    vec2 p = (mix(IN_PositionMin, IN_PositionMax, corner) + translate) * scale;
+    gl_Position = vec4(2 * p.x / PushConstants.ScreenWidth - 1, 2 * p.y / PushConstants.ScreenHeight - 1, 0, 1);
+
+    Frag_Color = IN_Color;
+    Frag_UV = mix(IN_UVMin, IN_UVMax, corner);
+    Frag_Texture = IN_Texture;
+}
+#endif
+// shader_quad.vert, compiled with:
+// glslangValidator -V -x -o shader_quad.vert.u32 shader_quad.vert
+static const uint32_t kShader_QuadVertex[] =
+{
+    0x07230203,0x00010000,0x0008000b,0x00000064,0x00000000,0x00020011,0x00000001,0x0006000b,
+    0x00000001,0x4c534c47,0x6474732e,0x3035342e,0x00000000,0x0003000e,0x00000000,0x00000001,
+    0x0010000f,0x00000000,0x00000004,0x6e69616d,0x00000000,0x0000000c,0x0000002b,0x0000002d,
+    0x0000003b,0x00000053,0x00000055,0x00000058,0x00000059,0x0000005b,0x00000060,0x00000062,
+    0x00040047,0x0000000c,0x0000000b,0x0000002a,0x00030047,0x00000016,0x00000002,0x00050048,
+    0x00000016,0x00000000,0x00000023,0x00000000,0x00050048,0x00000016,0x00000001,0x00000023,
+    0x00000004,0x00050048,0x00000016,0x00000002,0x00000023,0x00000008,0x00050048,0x00000016,
+    0x00000003,0x00000023,0x0000000c,0x00050048,0x00000016,0x00000004,0x00000023,0x00000010,
+    0x00050048,0x00000016,0x00000005,0x00000023,0x00000014,0x00040047,0x0000002b,0x0000001e,
+    0x00000000,0x00040047,0x0000002d,0x0000001e,0x00000003,0x00030047,0x00000039,0x00000002,
+    0x00050048,0x00000039,0x00000000,0x0000000b,0x00000000,0x00050048,0x00000039,0x00000001,
+    0x0000000b,0x00000001,0x00050048,0x00000039,0x00000002,0x0000000b,0x00000003,0x00050048,
+    0x00000039,0x00000003,0x0000000b,0x00000004,0x00040047,0x00000053,0x0000001e,0x00000001,
+    0x00040047,0x00000055,0x0000001e,0x00000002,0x00040047,0x00000058,0x0000001e,0x00000000,
+    0x00040047,0x00000059,0x0000001e,0x00000001,0x00040047,0x0000005b,0x0000001e,0x00000004,
+    0x00030047,0x00000060,0x0000000e,0x00040047,0x00000060,0x0000001e,0x00000002,0x00040047,
+    0x00000062,0x0000001e,0x00000005,0x00020013,0x00000002,0x00030021,0x00000003,0x00000002,
+    0x00030016,0x00000006,0x00000020,0x00040017,0x00000007,0x00000006,0x00000002,0x00040020,
+    0x00000008,0x00000007,0x00000007,0x00040015,0x0000000a,0x00000020,0x00000001,0x00040020,
+    0x0000000b,0x00000001,0x0000000a,0x0004003b,0x0000000b,0x0000000c,0x00000001,0x0004002b,
+    0x0000000a,0x0000000e,0x00000001,0x0008001e,0x00000016,0x00000006,0x00000006,0x00000006,
+    0x00000006,0x00000006,0x00000006,0x00040020,0x00000017,0x00000009,0x00000016,0x0004003b,
+    0x00000017,0x00000018,0x00000009,0x0004002b,0x0000000a,0x00000019,0x00000004,0x00040020,
+    0x0000001a,0x00000009,0x00000006,0x0004002b,0x0000000a,0x0000001d,0x00000005,0x0004002b,
+    0x0000000a,0x00000022,0x00000002,0x0004002b,0x0000000a,0x00000025,0x00000003,0x00040020,
+    0x0000002a,0x00000001,0x00000007,0x0004003b,0x0000002a,0x0000002b,0x00000001,0x0004003b,
+    0x0000002a,0x0000002d,0x00000001,0x00040017,0x00000035,0x00000006,0x00000004,0x00040015,
+    0x00000036,0x00000020,0x00000000,0x0004002b,0x00000036,0x00000037,0x00000001,0x0004001c,
+    0x00000038,0x00000006,0x00000037,0x0006001e,0x00000039,0x00000035,0x00000006,0x00000038,
+    0x00000038,0x00040020,0x0000003a,0x00000003,0x00000039,0x0004003b,0x0000003a,0x0000003b,
+    0x00000003,0x0004002b,0x0000000a,0x0000003c,0x00000000,0x0004002b,0x00000006,0x0000003d,
+    0x40000000,0x0004002b,0x00000036,0x0000003e,0x00000000,0x00040020,0x0000003f,0x00000007,
+    0x00000006,0x0004002b,0x00000006,0x00000046,0x3f800000,0x0004002b,0x00000006,0x0000004f,
+    0x00000000,0x00040020,0x00000051,0x00000003,0x00000035,0x0004003b,0x00000051,0x00000053,
+    0x00000003,0x00040020,0x00000054,0x00000001,0x00000035,0x0004003b,0x00000054,0x00000055,
+    0x00000001,0x00040020,0x00000057,0x00000003,0x00000007,0x0004003b,0x00000057,0x00000058,
+    0x00000003,0x0004003b,0x0000002a,0x00000059,0x00000001,0x0004003b,0x0000002a,0x0000005b,
+    0x00000001,0x00040020,0x0000005f,0x00000003,0x00000036,0x0004003b,0x0000005f,0x00000060,
+    0x00000003,0x00040020,0x00000061,0x00000001,0x00000036,0x0004003b,0x00000061,0x00000062,
+    0x00000001,0x00050036,0x00000002,0x00000004,0x00000000,0x00000003,0x000200f8,0x00000005,
+    0x0004003b,0x00000008,0x00000009,0x00000007,0x0004003b,0x00000008,0x00000015,0x00000007,
+    0x0004003b,0x00000008,0x00000021,0x00000007,0x0004003b,0x00000008,0x00000029,0x00000007,
+    0x0004003d,0x0000000a,0x0000000d,0x0000000c,0x000500c3,0x0000000a,0x0000000f,0x0000000d,
+    0x0000000e,0x0004006f,0x00000006,0x00000010,0x0000000f,0x0004003d,0x0000000a,0x00000011,
+    0x0000000c,0x000500c7,0x0000000a,0x00000012,0x00000011,0x0000000e,0x0004006f,0x00000006,
+    0x00000013,0x00000012,0x00050050,0x00000007,0x00000014,0x00000010,0x00000013,0x0003003e,
+    0x00000009,0x00000014,0x00050041,0x0000001a,0x0000001b,0x00000018,0x00000019,0x0004003d,
+    0x00000006,0x0000001c,0x0000001b,0x00050041,0x0000001a,0x0000001e,0x00000018,0x0000001d,
+    0x0004003d,0x00000006,0x0000001f,0x0000001e,0x00050050,0x00000007,0x00000020,0x0000001c,
+    0x0000001f,0x0003003e,0x00000015,0x00000020,0x00050041,0x0000001a,0x00000023,0x00000018,
+    0x00000022,0x0004003d,0x00000006,0x00000024,0x00000023,0x00050041,0x0000001a,0x00000026,
+    0x00000018,0x00000025,0x0004003d,0x00000006,0x00000027,0x00000026,0x00050050,0x00000007,
+    0x00000028,0x00000024,0x00000027,0x0003003e,0x00000021,0x00000028,0x0004003d,0x00000007,
+    0x0000002c,0x0000002b,0x0004003d,0x00000007,0x0000002e,0x0000002d,0x0004003d,0x00000007,
+    0x0000002f,0x00000009,0x0008000c,0x00000007,0x00000030,0x00000001,0x0000002e,0x0000002c,
+    0x0000002e,0x0000002f,0x0004003d,0x00000007,0x00000031,0x00000015,0x00050081,0x00000007,
+    0x00000032,0x00000030,0x00000031,0x0004003d,0x00000007,0x00000033,0x00000021,0x00050085,
+    0x00000007,0x00000034,0x00000032,0x00000033,0x0003003e,0x00000029,0x00000034,0x00050041,
+    0x0000003f,0x00000040,0x00000029,0x0000003e,0x0004003d,0x00000006,0x00000041,0x00000040,
+    0x00050085,0x00000006,0x00000042,0x0000003d,0x00000041,0x00050041,0x0000001a,0x00000043,
+    0x00000018,0x0000003c,0x0004003d,0x00000006,0x00000044,0x00000043,0x00050088,0x00000006,
+    0x00000045,0x00000042,0x00000044,0x00050083,0x00000006,0x00000047,0x00000045,0x00000046,
+    0x00050041,0x0000003f,0x00000048,0x00000029,0x00000037,0x0004003d,0x00000006,0x00000049,
+    0x00000048,0x00050085,0x00000006,0x0000004a,0x0000003d,0x00000049,0x00050041,0x0000001a,
+    0x0000004b,0x00000018,0x0000000e,0x0004003d,0x00000006,0x0000004c,0x0000004b,0x00050088,
+    0x00000006,0x0000004d,0x0000004a,0x0000004c,0x00050083,0x00000006,0x0000004e,0x0000004d,
+    0x00000046,0x00070050,0x00000035,0x00000050,0x00000047,0x0000004e,0x0000004f,0x00000046,
+    0x00050041,0x00000051,0x00000052,0x0000003b,0x0000003c,0x0003003e,0x00000052,0x00000050,
+    0x0004003d,0x00000035,0x00000056,0x00000055,0x0003003e,0x00000053,0x00000056,0x0004003d,
+    0x00000007,0x0000005a,0x00000059,0x0004003d,0x00000007,0x0000005c,0x0000005b,0x0004003d,
+    0x00000007,0x0000005d,0x00000009,0x0008000c,0x00000007,0x0000005e,0x00000001,0x0000002e,
+    0x0000005a,0x0000005c,0x0000005d,0x0003003e,0x00000058,0x0000005e,0x0004003d,0x00000036,
+    0x00000063,0x00000062,0x0003003e,0x00000060,0x00000063,0x000100fd,0x00010038
+};
+
+// shader_quad_batch.frag: quads of up to KidsRender::kMaxBatchTextures
+// textures, see KidsRender::set_texture_batching().
+#if (0)
+#version 450
+
+layout(location = 0) in vec2 Frag_UV;
+layout(location = 1) in vec4 Frag_Color;
+layout(location = 2) flat in uint Frag_Texture;
+
+// Must match KidsRender::kMaxBatchTextures.
+layout(set = 0, binding = 1) uniform texture2D Textures[8];
+layout(set = 0, binding = 2) uniform sampler samp;
+
+layout(location = 0) out vec4 Out_Color;
+
+void main()
+{
+    // Frag_Texture is not dynamically uniform, so Textures[Frag_Texture]
+    // is not allowed: constant indices, with gradients taken outside of branches.
+    vec2 dx = dFdx(Frag_UV);
+    vec2 dy = dFdy(Frag_UV);
+    vec4 texel = vec4(1.0);
+    switch (Frag_Texture)
+    {
+    case 0u: texel = textureGrad(sampler2D(Textures[0], samp), Frag_UV, dx, dy); break;
+    case 1u: texel = textureGrad(sampler2D(Textures[1], samp), Frag_UV, dx, dy); break;
+    case 2u: texel = textureGrad(sampler2D(Textures[2], samp), Frag_UV, dx, dy); break;
+    case 3u: texel = textureGrad(sampler2D(Textures[3], samp), Frag_UV, dx, dy); break;
+    case 4u: texel = textureGrad(sampler2D(Textures[4], samp), Frag_UV, dx, dy); break;
+    case 5u: texel = textureGrad(sampler2D(Textures[5], samp), Frag_UV, dx, dy); break;
+    case 6u: texel = textureGrad(sampler2D(Textures[6], samp), Frag_UV, dx, dy); break;
+    case 7u: texel = textureGrad(sampler2D(Textures[7], samp), Frag_UV, dx, dy); break;
+    }
+    Out_Color = Frag_Color * texel;
+}
+#endif
+// shader_quad_batch.frag, compiled with:
+// glslangValidator -V -x -o shader_quad_batch.frag.u32 shader_quad_batch.frag
+static const uint32_t kShader_QuadBatchFragment[] =
+{
+    0x07230203,0x00010000,0x0008000b,0x00000086,0x00000000,0x00020011,0x00000001,0x0006000b,
+    0x00000001,0x4c534c47,0x6474732e,0x3035342e,0x00000000,0x0003000e,0x00000000,0x00000001,
+    0x0009000f,0x00000004,0x00000004,0x6e69616d,0x00000000,0x0000000b,0x00000018,0x00000080,
+    0x00000082,0x00030010,0x00000004,0x00000007,0x00040047,0x0000000b,0x0000001e,0x00000000,
+    0x00030047,0x00000018,0x0000000e,0x00040047,0x00000018,0x0000001e,0x00000002,0x00040047,
+    0x00000027,0x00000021,0x00000001,0x00040047,0x00000027,0x00000022,0x00000000,0x00040047,
+    0x0000002f,0x00000021,0x00000002,0x00040047,0x0000002f,0x00000022,0x00000000,0x00040047,
+    0x00000080,0x0000001e,0x00000000,0x00040047,0x00000082,0x0000001e,0x00000001,0x00020013,
+    0x00000002,0x00030021,0x00000003,0x00000002,0x00030016,0x00000006,0x00000020,0x00040017,
+    0x00000007,0x00000006,0x00000002,0x00040020,0x00000008,0x00000007,0x00000007,0x00040020,
+    0x0000000a,0x00000001,0x00000007,0x0004003b,0x0000000a,0x0000000b,0x00000001,0x00040017,
+    0x00000011,0x00000006,0x00000004,0x00040020,0x00000012,0x00000007,0x00000011,0x0004002b,
+    0x00000006,0x00000014,0x3f800000,0x0007002c,0x00000011,0x00000015,0x00000014,0x00000014,
+    0x00000014,0x00000014,0x00040015,0x00000016,0x00000020,0x00000000,0x00040020,0x00000017,
+    0x00000001,0x00000016,0x0004003b,0x00000017,0x00000018,0x00000001,0x00090019,0x00000023,
+    0x00000006,0x00000001,0x00000000,0x00000000,0x00000000,0x00000001,0x00000000,0x0004002b,
+    0x00000016,0x00000024,0x00000008,0x0004001c,0x00000025,0x00000023,0x00000024,0x00040020,
+    0x00000026,0x00000000,0x00000025,0x0004003b,0x00000026,0x00000027,0x00000000,0x00040015,
+    0x00000028,0x00000020,0x00000001,0x0004002b,0x00000028,0x00000029,0x00000000,0x00040020,
+    0x0000002a,0x00000000,0x00000023,0x0002001a,0x0000002d,0x00040020,0x0000002e,0x00000000,
+    0x0000002d,0x0004003b,0x0000002e,0x0000002f,0x00000000,0x0003001b,0x00000031,0x00000023,
+    0x0004002b,0x00000028,0x00000038,0x00000001,0x0004002b,0x00000028,0x00000042,0x00000002,
+    0x0004002b,0x00000028,0x0000004c,0x00000003,0x0004002b,0x00000028,0x00000056,0x00000004,
+    0x0004002b,0x00000028,0x00000060,0x00000005,0x0004002b,0x00000028,0x0000006a,0x00000006,
+    0x0004002b,0x00000028,0x00000074,0x00000007,0x00040020,0x0000007f,0x00000003,0x00000011,
+    0x0004003b,0x0000007f,0x00000080,0x00000003,0x00040020,0x00000081,0x00000001,0x00000011,
+    0x0004003b,0x00000081,0x00000082,0x00000001,0x00050036,0x00000002,0x00000004,0x00000000,
+    0x00000003,0x000200f8,0x00000005,0x0004003b,0x00000008,0x00000009,0x00000007,0x0004003b,
+    0x00000008,0x0000000e,0x00000007,0x0004003b,0x00000012,0x00000013,0x00000007,0x0004003d,
+    0x00000007,0x0000000c,0x0000000b,0x000400cf,0x00000007,0x0000000d,0x0000000c,0x0003003e,
+    0x00000009,0x0000000d,0x0004003d,0x00000007,0x0000000f,0x0000000b,0x000400d0,0x00000007,
+    0x00000010,0x0000000f,0x0003003e,0x0000000e,0x00000010,0x0003003e,0x00000013,0x00000015,
+    0x0004003d,0x00000016,0x00000019,0x00000018,0x000300f7,0x00000022,0x00000000,0x001300fb,
+    0x00000019,0x00000022,0x00000000,0x0000001a,0x00000001,0x0000001b,0x00000002,0x0000001c,
+    0x00000003,0x0000001d,0x00000004,0x0000001e,0x00000005,0x0000001f,0x00000006,0x00000020,
+    0x00000007,0x00000021,0x000200f8,0x0000001a,0x00050041,0x0000002a,0x0000002b,0x00000027,
+    0x00000029,0x0004003d,0x00000023,0x0000002c,0x0000002b,0x0004003d,0x0000002d,0x00000030,
+    0x0000002f,0x00050056,0x00000031,0x00000032,0x0000002c,0x00000030,0x0004003d,0x00000007,
+    0x00000033,0x0000000b,0x0004003d,0x00000007,0x00000034,0x00000009,0x0004003d,0x00000007,
+    0x00000035,0x0000000e,0x00080058,0x00000011,0x00000036,0x00000032,0x00000033,0x00000004,
+    0x00000034,0x00000035,0x0003003e,0x00000013,0x00000036,0x000200f9,0x00000022,0x000200f8,
+    0x0000001b,0x00050041,0x0000002a,0x00000039,0x00000027,0x00000038,0x0004003d,0x00000023,
+    0x0000003a,0x00000039,0x0004003d,0x0000002d,0x0000003b,0x0000002f,0x00050056,0x00000031,
+    0x0000003c,0x0000003a,0x0000003b,0x0004003d,0x00000007,0x0000003d,0x0000000b,0x0004003d,
+    0x00000007,0x0000003e,0x00000009,0x0004003d,0x00000007,0x0000003f,0x0000000e,0x00080058,
+    0x00000011,0x00000040,0x0000003c,0x0000003d,0x00000004,0x0000003e,0x0000003f,0x0003003e,
+    0x00000013,0x00000040,0x000200f9,0x00000022,0x000200f8,0x0000001c,0x00050041,0x0000002a,
+    0x00000043,0x00000027,0x00000042,0x0004003d,0x00000023,0x00000044,0x00000043,0x0004003d,
+    0x0000002d,0x00000045,0x0000002f,0x00050056,0x00000031,0x00000046,0x00000044,0x00000045,
+    0x0004003d,0x00000007,0x00000047,0x0000000b,0x0004003d,0x00000007,0x00000048,0x00000009,
+    0x0004003d,0x00000007,0x00000049,0x0000000e,0x00080058,0x00000011,0x0000004a,0x00000046,
+    0x00000047,0x00000004,0x00000048,0x00000049,0x0003003e,0x00000013,0x0000004a,0x000200f9,
+    0x00000022,0x000200f8,0x0000001d,0x00050041,0x0000002a,0x0000004d,0x00000027,0x0000004c,
+    0x0004003d,0x00000023,0x0000004e,0x0000004d,0x0004003d,0x0000002d,0x0000004f,0x0000002f,
+    0x00050056,0x00000031,0x00000050,0x0000004e,0x0000004f,0x0004003d,0x00000007,0x00000051,
+    0x0000000b,0x0004003d,0x00000007,0x00000052,0x00000009,0x0004003d,0x00000007,0x00000053,
+    0x0000000e,0x00080058,0x00000011,0x00000054,0x00000050,0x00000051,0x00000004,0x00000052,
+    0x00000053,0x0003003e,0x00000013,0x00000054,0x000200f9,0x00000022,0x000200f8,0x0000001e,
+    0x00050041,0x0000002a,0x00000057,0x00000027,0x00000056,0x0004003d,0x00000023,0x00000058,
+    0x00000057,0x0004003d,0x0000002d,0x00000059,0x0000002f,0x00050056,0x00000031,0x0000005a,
+    0x00000058,0x00000059,0x0004003d,0x00000007,0x0000005b,0x0000000b,0x0004003d,0x00000007,
+    0x0000005c,0x00000009,0x0004003d,0x00000007,0x0000005d,0x0000000e,0x00080058,0x00000011,
+    0x0000005e,0x0000005a,0x0000005b,0x00000004,0x0000005c,0x0000005d,0x0003003e,0x00000013,
+    0x0000005e,0x000200f9,0x00000022,0x000200f8,0x0000001f,0x00050041,0x0000002a,0x00000061,
+    0x00000027,0x00000060,0x0004003d,0x00000023,0x00000062,0x00000061,0x0004003d,0x0000002d,
+    0x00000063,0x0000002f,0x00050056,0x00000031,0x00000064,0x00000062,0x00000063,0x0004003d,
+    0x00000007,0x00000065,0x0000000b,0x0004003d,0x00000007,0x00000066,0x00000009,0x0004003d,
+    0x00000007,0x00000067,0x0000000e,0x00080058,0x00000011,0x00000068,0x00000064,0x00000065,
+    0x00000004,0x00000066,0x00000067,0x0003003e,0x00000013,0x00000068,0x000200f9,0x00000022,
+    0x000200f8,0x00000020,0x00050041,0x0000002a,0x0000006b,0x00000027,0x0000006a,0x0004003d,
+    0x00000023,0x0000006c,0x0000006b,0x0004003d,0x0000002d,0x0000006d,0x0000002f,0x00050056,
+    0x00000031,0x0000006e,0x0000006c,0x0000006d,0x0004003d,0x00000007,0x0000006f,0x0000000b,
+    0x0004003d,0x00000007,0x00000070,0x00000009,0x0004003d,0x00000007,0x00000071,0x0000000e,
+    0x00080058,0x00000011,0x00000072,0x0000006e,0x0000006f,0x00000004,0x00000070,0x00000071,
+    0x0003003e,0x00000013,0x00000072,0x000200f9,0x00000022,0x000200f8,0x00000021,0x00050041,
+    0x0000002a,0x00000075,0x00000027,0x00000074,0x0004003d,0x00000023,0x00000076,0x00000075,
+    0x0004003d,0x0000002d,0x00000077,0x0000002f,0x00050056,0x00000031,0x00000078,0x00000076,
+    0x00000077,0x0004003d,0x00000007,0x00000079,0x0000000b,0x0004003d,0x00000007,0x0000007a,
+    0x00000009,0x0004003d,0x00000007,0x0000007b,0x0000000e,0x00080058,0x00000011,0x0000007c,
+    0x00000078,0x00000079,0x00000004,0x0000007a,0x0000007b,0x0003003e,0x00000013,0x0000007c,
+    0x000200f9,0x00000022,0x000200f8,0x00000022,0x0004003d,0x00000011,0x00000083,0x00000082,
+    0x0004003d,0x00000011,0x00000084,0x00000013,0x00050085,0x00000011,0x00000085,0x00000083,
+    0x00000084,0x0003003e,0x00000080,0x00000085,0x000100fd,0x00010038
+};
+
+// shader_sdf.vert: analytic shapes, see KidsRender::shape_sdf().
+#if (0)
+#version 450
+
+layout(location = 0) in vec2 IN_Position;
+layout(location = 1) in vec2 IN_Local;
+layout(location = 2) in vec4 IN_Color;
+layout(location = 3) in vec2 IN_HalfSize;
+layout(location = 4) in uvec2 IN_Params; // Radius, width; 1/16 px.
+
+layout(location = 0) out vec2 Frag_Local;
+layout(location = 1) out vec4 Frag_Color;
+layout(location = 2) flat out vec2 Frag_HalfSize;
+layout(location = 3) flat out vec2 Frag_Params;
+
+layout(push_constant) uniform constants
+{
+    float ScreenWidth;
+    float ScreenHeight;
+    float ScaleX;
+    float ScaleY;
+    float TranslateX;
+    float TranslateY;
+}
+PushConstants;
+
+void main()
+{
+    vec2 translate = vec2(PushConstants.TranslateX, PushConstants.TranslateY);
+    vec2 scale = vec2(PushConstants.ScaleX, PushConstants.ScaleY);
+    vec2 p = (IN_Position + translate) * scale;
+    gl_Position = vec4(2 * p.x / PushConstants.ScreenWidth - 1, 2 * p.y / PushConstants.ScreenHeight - 1, 0, 1);
+
+    Frag_Local = IN_Local;
+    Frag_Color = IN_Color;
+    Frag_HalfSize = IN_HalfSize;
+    Frag_Params = vec2(IN_Params);
+}
+#endif
+// shader_sdf.vert, compiled with:
+// glslangValidator -V -x -o shader_sdf.vert.u32 shader_sdf.vert
+static const uint32_t kShader_SdfVertex[] =
+{
+    0x07230203,0x00010000,0x0008000b,0x00000056,0x00000000,0x00020011,0x00000001,0x0006000b,
+    0x00000001,0x4c534c47,0x6474732e,0x3035342e,0x00000000,0x0003000e,0x00000000,0x00000001,
+    0x000f000f,0x00000000,0x00000004,0x6e69616d,0x00000000,0x00000020,0x0000002c,0x00000046,
+    0x00000047,0x00000049,0x0000004b,0x0000004d,0x0000004e,0x00000050,0x00000053,0x00030047,
+    0x0000000a,0x00000002,0x00050048,0x0000000a,0x00000000,0x00000023,0x00000000,0x00050048,
+    0x0000000a,0x00000001,0x00000023,0x00000004,0x00050048,0x0000000a,0x00000002,0x00000023,
+    0x00000008,0x00050048,0x0000000a,0x00000003,0x00000023,0x0000000c,0x00050048,0x0000000a,
+    0x00000004,0x00000023,0x00000010,0x00050048,0x0000000a,0x00000005,0x00000023,0x00000014,
+    0x00040047,0x00000020,0x0000001e,0x00000000,0x00030047,0x0000002a,0x00000002,0x00050048,
+    0x0000002a,0x00000000,0x0000000b,0x00000000,0x00050048,0x0000002a,0x00000001,0x0000000b,
+    0x00000001,0x00050048,0x0000002a,0x00000002,0x0000000b,0x00000003,0x00050048,0x0000002a,
+    0x00000003,0x0000000b,0x00000004,0x00040047,0x00000046,0x0000001e,0x00000000,0x00040047,
+    0x00000047,0x0000001e,0x00000001,0x00040047,0x00000049,0x0000001e,0x00000001,0x00040047,
+    0x0000004b,0x0000001e,0x00000002,0x00030047,0x0000004d,0x0000000e,0x00040047,0x0000004d,
+    0x0000001e,0x00000002,0x00040047,0x0000004e,0x0000001e,0x00000003,0x00030047,0x00000050,
+    0x0000000e,0x00040047,0x00000050,0x0000001e,0x00000003,0x00040047,0x00000053,0x0000001e,
+    0x00000004,0x00020013,0x00000002,0x00030021,0x00000003,0x00000002,0x00030016,0x00000006,
+    0x00000020,0x00040017,0x00000007,0x00000006,0x00000002,0x00040020,0x00000008,0x00000007,
+    0x00000007,0x0008001e,0x0000000a,0x00000006,0x00000006,0x00000006,0x00000006,0x00000006,
+    0x00000006,0x00040020,0x0000000b,0x00000009,0x0000000a,0x0004003b,0x0000000b,0x0000000c,
+    0x00000009,0x00040015,0x0000000d,0x00000020,0x00000001,0x0004002b,0x0000000d,0x0000000e,
+    0x00000004,0x00040020,0x0000000f,0x00000009,0x00000006,0x0004002b,0x0000000d,0x00000012,
+    0x00000005,0x0004002b,0x0000000d,0x00000017,0x00000002,0x0004002b,0x0000000d,0x0000001a,
+    0x00000003,0x00040020,0x0000001f,0x00000001,0x00000007,0x0004003b,0x0000001f,0x00000020,
+    0x00000001,0x00040017,0x00000026,0x00000006,0x00000004,0x00040015,0x00000027,0x00000020,
+    0x00000000,0x0004002b,0x00000027,0x00000028,0x00000001,0x0004001c,0x00000029,0x00000006,
+    0x00000028,0x0006001e,0x0000002a,0x00000026,0x00000006,0x00000029,0x00000029,0x00040020,
+    0x0000002b,0x00000003,0x0000002a,0x0004003b,0x0000002b,0x0000002c,0x00000003,0x0004002b,
+    0x0000000d,0x0000002d,0x00000000,0x0004002b,0x00000006,0x0000002e,0x40000000,0x0004002b,
+    0x00000027,0x0000002f,0x00000000,0x00040020,0x00000030,0x00000007,0x00000006,0x0004002b,
+    0x00000006,0x00000037,0x3f800000,0x0004002b,0x0000000d,0x0000003c,0x00000001,0x0004002b,
+    0x00000006,0x00000041,0x00000000,0x00040020,0x00000043,0x00000003,0x00000026,0x00040020,
+    0x00000045,0x00000003,0x00000007,0x0004003b,0x00000045,0x00000046,0x00000003,0x0004003b,
+    0x0000001f,0x00000047,0x00000001,0x0004003b,0x00000043,0x00000049,0x00000003,0x00040020,
+    0x0000004a,0x00000001,0x00000026,0x0004003b,0x0000004a,0x0000004b,0x00000001,0x0004003b,
+    0x00000045,0x0000004d,0x00000003,0x0004003b,0x0000001f,0x0000004e,0x00000001,0x0004003b,
+    0x00000045,0x00000050,0x00000003,0x00040017,0x00000051,0x00000027,0x00000002,0x00040020,
+    0x00000052,0x00000001,0x00000051,0x0004003b,0x00000052,0x00000053,0x00000001,0x00050036,
+    0x00000002,0x00000004,0x00000000,0x00000003,0x000200f8,0x00000005,0x0004003b,0x00000008,
+    0x00000009,0x00000007,0x0004003b,0x00000008,0x00000016,0x00000007,0x0004003b,0x00000008,
+    0x0000001e,0x00000007,0x00050041,0x0000000f,0x00000010,0x0000000c,0x0000000e,0x0004003d,
+    0x00000006,0x00000011,0x00000010,0x00050041,0x0000000f,0x00000013,0x0000000c,0x00000012,
+    0x0004003d,0x00000006,0x00000014,0x00000013,0x00050050,0x00000007,0x00000015,0x00000011,
+    0x00000014,0x0003003e,0x00000009,0x00000015,0x00050041,0x0000000f,0x00000018,0x0000000c,
+    0x00000017,0x0004003d,0x00000006,0x00000019,0x00000018,0x00050041,0x0000000f,0x0000001b,
+    0x0000000c,0x0000001a,0x0004003d,0x00000006,0x0000001c,0x0000001b,0x00050050,0x00000007,
+    0x0000001d,0x00000019,0x0000001c,0x0003003e,0x00000016,0x0000001d,0x0004003d,0x00000007,
+    0x00000021,0x00000020,0x0004003d,0x00000007,0x00000022,0x00000009,0x00050081,0x00000007,
+    0x00000023,0x00000021,0x00000022,0x0004003d,0x00000007,0x00000024,0x00000016,0x00050085,
+    0x00000007,0x00000025,0x00000023,0x00000024,0x0003003e,0x0000001e,0x00000025,0x00050041,
+    0x00000030,0x00000031,0x0000001e,0x0000002f,0x0004003d,0x00000006,0x00000032,0x00000031,
+    0x00050085,0x00000006,0x00000033,0x0000002e,0x00000032,0x00050041,0x0000000f,0x00000034,
+    0x0000000c,0x0000002d,0x0004003d,0x00000006,0x00000035,0x00000034,0x00050088,0x00000006,
+    0x00000036,0x00000033,0x00000035,0x00050083,0x00000006,0x00000038,0x00000036,0x00000037,
+    0x00050041,0x00000030,0x00000039,0x0000001e,0x00000028,0x0004003d,0x00000006,0x0000003a,
+    0x00000039,0x00050085,0x00000006,0x0000003b,0x0000002e,0x0000003a,0x00050041,0x0000000f,
+    0x0000003d,0x0000000c,0x0000003c,0x0004003d,0x00000006,0x0000003e,0x0000003d,0x00050088,
+    0x00000006,0x0000003f,0x0000003b,0x0000003e,0x00050083,0x00000006,0x00000040,0x0000003f,
+    0x00000037,0x00070050,0x00000026,0x00000042,0x00000038,0x00000040,0x00000041,0x00000037,
+    0x00050041,0x00000043,0x00000044,0x0000002c,0x0000002d,0x0003003e,0x00000044,0x00000042,
+    0x0004003d,0x00000007,0x00000048,0x00000047,0x0003003e,0x00000046,0x00000048,0x0004003d,
+    0x00000026,0x0000004c,0x0000004b,0x0003003e,0x00000049,0x0000004c,0x0004003d,0x00000007,
+    0x0000004f,0x0000004e,0x0003003e,0x0000004d,0x0000004f,0x0004003d,0x00000051,0x00000054,
+    0x00000053,0x00040070,0x00000007,0x00000055,0x00000054,0x0003003e,0x00000050,0x00000055,
+    0x000100fd,0x00010038
+};
+
+// shader_sdf.frag
+#if (0)
+#version 450
+
+layout(location = 0) in vec2 Frag_Local;
+layout(location = 1) in vec4 Frag_Color;
+layout(location = 2) flat in vec2 Frag_HalfSize;
+layout(location = 3) flat in vec2 Frag_Params;
+
+layout(location = 0) out vec4 Out_Color;
+
+const float kUnit = 1.0 / 16.0;
+const float kEllipse = 65535.0;
+
+// https://iquilezles.org/articles/distfunctions2d/
+float sd_rounded_box(vec2 p, vec2 half_size, float radius)
+{
+    vec2 q = abs(p) - half_size + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+// Approximation, exact on the edge itself which is enough for AA.
+float sd_ellipse(vec2 p, vec2 half_size)
+{
+    float k0 = length(p / half_size);
+    float k1 = length(p / (half_size * half_size));
+    return k0 * (k0 - 1.0) / max(k1, 1e-6);
+}
+
+void main()
+{
+    float d = (Frag_Params.x == kEllipse)
+        ? sd_ellipse(Frag_Local, Frag_HalfSize)
+        : sd_rounded_box(Frag_Local, Frag_HalfSize, Frag_Params.x * kUnit);
+    float width = Frag_Params.y * kUnit;
+    if (width > 0.0)
+        d = abs(d + 0.5 * width) - 0.5 * width;
+    // Distance in pixels; 1px wide transition centered on the edge.
+    float alpha = clamp(0.5 - d / max(fwidth(d), 1e-6), 0.0, 1.0);
+    Out_Color = vec4(Frag_Color.rgb, Frag_Color.a * alpha);
+}
+#endif
+// shader_sdf.frag, compiled with:
+// glslangValidator -V -x -o shader_sdf.frag.u32 shader_sdf.frag
+static const uint32_t kShader_SdfFragment[] =
+{
+    0x07230203,0x00010000,0x0008000b,0x00000090,0x00000000,0x00020011,0x00000001,0x0006000b,
+    0x00000001,0x4c534c47,0x6474732e,0x3035342e,0x00000000,0x0003000e,0x00000000,0x00000001,
+    0x000a000f,0x00000004,0x00000004,0x6e69616d,0x00000000,0x00000049,0x00000053,0x00000054,
+    0x00000081,0x00000083,0x00030010,0x00000004,0x00000007,0x00030047,0x00000049,0x0000000e,
+    0x00040047,0x00000049,0x0000001e,0x00000003,0x00040047,0x00000053,0x0000001e,0x00000000,
+    0x00030047,0x00000054,0x0000000e,0x00040047,0x00000054,0x0000001e,0x00000002,0x00040047,
+    0x00000081,0x0000001e,0x00000000,0x00040047,0x00000083,0x0000001e,0x00000001,0x00020013,
+    0x00000002,0x00030021,0x00000003,0x00000002,0x00030016,0x00000006,0x00000020,0x00040017,
+    0x00000007,0x00000006,0x00000002,0x00040020,0x00000008,0x00000007,0x00000007,0x00040020,
+    0x00000009,0x00000007,0x00000006,0x00060021,0x0000000a,0x00000006,0x00000008,0x00000008,
+    0x00000009,0x00050021,0x00000010,0x00000006,0x00000008,0x00000008,0x0004002b,0x00000006,
+    0x0000001e,0x00000000,0x00040015,0x00000022,0x00000020,0x00000000,0x0004002b,0x00000022,
+    0x00000023,0x00000000,0x0004002b,0x00000022,0x00000026,0x00000001,0x0004002b,0x00000006,
+    0x0000003e,0x3f800000,0x0004002b,0x00000006,0x00000042,0x358637bd,0x00040020,0x00000048,
+    0x00000001,0x00000007,0x0004003b,0x00000048,0x00000049,0x00000001,0x00040020,0x0000004a,
+    0x00000001,0x00000006,0x0004002b,0x00000006,0x0000004d,0x477fff00,0x00020014,0x0000004e,
+    0x0004003b,0x00000048,0x00000053,0x00000001,0x0004003b,0x00000048,0x00000054,0x00000001,
+    0x0004002b,0x00000006,0x0000005d,0x3d800000,0x0004002b,0x00000006,0x0000006f,0x3f000000,
+    0x00040017,0x0000007f,0x00000006,0x00000004,0x00040020,0x00000080,0x00000003,0x0000007f,
+    0x0004003b,0x00000080,0x00000081,0x00000003,0x00040020,0x00000082,0x00000001,0x0000007f,
+    0x0004003b,0x00000082,0x00000083,0x00000001,0x00040017,0x00000084,0x00000006,0x00000003,
+    0x0004002b,0x00000022,0x00000087,0x00000003,0x00050036,0x00000002,0x00000004,0x00000000,
+    0x00000003,0x000200f8,0x00000005,0x0004003b,0x00000009,0x00000047,0x00000007,0x0004003b,
+    0x00000009,0x00000050,0x00000007,0x0004003b,0x00000008,0x00000055,0x00000007,0x0004003b,
+    0x00000008,0x00000057,0x00000007,0x0004003b,0x00000008,0x0000005f,0x00000007,0x0004003b,
+    0x00000008,0x00000061,0x00000007,0x0004003b,0x00000009,0x00000063,0x00000007,0x0004003b,
+    0x00000009,0x00000066,0x00000007,0x0004003b,0x00000009,0x00000077,0x00000007,0x00050041,
+    0x0000004a,0x0000004b,0x00000049,0x00000023,0x0004003d,0x00000006,0x0000004c,0x0000004b,
+    0x000500b4,0x0000004e,0x0000004f,0x0000004c,0x0000004d,0x000300f7,0x00000052,0x00000000,
+    0x000400fa,0x0000004f,0x00000051,0x0000005a,0x000200f8,0x00000051,0x0004003d,0x00000007,
+    0x00000056,0x00000053,0x0003003e,0x00000055,0x00000056,0x0004003d,0x00000007,0x00000058,
+    0x00000054,0x0003003e,0x00000057,0x00000058,0x00060039,0x00000006,0x00000059,0x00000013,
+    0x00000055,0x00000057,0x0003003e,0x00000050,0x00000059,0x000200f9,0x00000052,0x000200f8,
+    0x0000005a,0x00050041,0x0000004a,0x0000005b,0x00000049,0x00000023,0x0004003d,0x00000006,
+    0x0000005c,0x0000005b,0x00050085,0x00000006,0x0000005e,0x0000005c,0x0000005d,0x0004003d,
+    0x00000007,0x00000060,0x00000053,0x0003003e,0x0000005f,0x00000060,0x0004003d,0x00000007,
+    0x00000062,0x00000054,0x0003003e,0x00000061,0x00000062,0x0003003e,0x00000063,0x0000005e,
+    0x00070039,0x00000006,0x00000064,0x0000000e,0x0000005f,0x00000061,0x00000063,0x0003003e,
+    0x00000050,0x00000064,0x000200f9,0x00000052,0x000200f8,0x00000052,0x0004003d,0x00000006,
+    0x00000065,0x00000050,0x0003003e,0x00000047,0x00000065,0x00050041,0x0000004a,0x00000067,
+    0x00000049,0x00000026,0x0004003d,0x00000006,0x00000068,0x00000067,0x00050085,0x00000006,
+    0x00000069,0x00000068,0x0000005d,0x0003003e,0x00000066,0x00000069,0x0004003d,0x00000006,
+    0x0000006a,0x00000066,0x000500ba,0x0000004e,0x0000006b,0x0000006a,0x0000001e,0x000300f7,
+    0x0000006d,0x00000000,0x000400fa,0x0000006b,0x0000006c,0x0000006d,0x000200f8,0x0000006c,
+    0x0004003d,0x00000006,0x0000006e,0x00000047,0x0004003d,0x00000006,0x00000070,0x00000066,
+    0x00050085,0x00000006,0x00000071,0x0000006f,0x00000070,0x00050081,0x00000006,0x00000072,
+    0x0000006e,0x00000071,0x0006000c,0x00000006,0x00000073,0x00000001,0x00000004,0x00000072,
+    0x0004003d,0x00000006,0x00000074,0x00000066,0x00050085,0x00000006,0x00000075,0x0000006f,
+    0x00000074,0x00050083,0x00000006,0x00000076,0x00000073,0x00000075,0x0003003e,0x00000047,
+    0x00000076,0x000200f9,0x0000006d,0x000200f8,0x0000006d,0x0004003d,0x00000006,0x00000078,
+    0x00000047,0x0004003d,0x00000006,0x00000079,0x00000047,0x000400d1,0x00000006,0x0000007a,
+    0x00000079,0x0007000c,0x00000006,0x0000007b,0x00000001,0x00000028,0x0000007a,0x00000042,
+    0x00050088,0x00000006,0x0000007c,0x00000078,0x0000007b,0x00050083,0x00000006,0x0000007d,
+    0x0000006f,0x0000007c,0x0008000c,0x00000006,0x0000007e,0x00000001,0x0000002b,0x0000007d,
+    0x0000001e,0x0000003e,0x0003003e,0x00000077,0x0000007e,0x0004003d,0x0000007f,0x00000085,
+    0x00000083,0x0008004f,0x00000084,0x00000086,0x00000085,0x00000085,0x00000000,0x00000001,
+    0x00000002,0x00050041,0x0000004a,0x00000088,0x00000083,0x00000087,0x0004003d,0x00000006,
+    0x00000089,0x00000088,0x0004003d,0x00000006,0x0000008a,0x00000077,0x00050085,0x00000006,
+    0x0000008b,0x00000089,0x0000008a,0x00050051,0x00000006,0x0000008c,0x00000086,0x00000000,
+    0x00050051,0x00000006,0x0000008d,0x00000086,0x00000001,0x00050051,0x00000006,0x0000008e,
+    0x00000086,0x00000002,0x00070050,0x0000007f,0x0000008f,0x0000008c,0x0000008d,0x0000008e,
+    0x0000008b,0x0003003e,0x00000081,0x0000008f,0x000100fd,0x00010038,0x00050036,0x00000006,
+    0x0000000e,0x00000000,0x0000000a,0x00030037,0x00000008,0x0000000b,0x00030037,0x00000008,
+    0x0000000c,0x00030037,0x00000009,0x0000000d,0x000200f8,0x0000000f,0x0004003b,0x00000008,
+    0x00000015,0x00000007,0x0004003d,0x00000007,0x00000016,0x0000000b,0x0006000c,0x00000007,
+    0x00000017,0x00000001,0x00000004,0x00000016,0x0004003d,0x00000007,0x00000018,0x0000000c,
+    0x00050083,0x00000007,0x00000019,0x00000017,0x00000018,0x0004003d,0x00000006,0x0000001a,
+    0x0000000d,0x00050050,0x00000007,0x0000001b,0x0000001a,0x0000001a,0x00050081,0x00000007,
+    0x0000001c,0x00000019,0x0000001b,0x0003003e,0x00000015,0x0000001c,0x0004003d,0x00000007,
+    0x0000001d,0x00000015,0x00050050,0x00000007,0x0000001f,0x0000001e,0x0000001e,0x0007000c,
+    0x00000007,0x00000020,0x00000001,0x00000028,0x0000001d,0x0000001f,0x0006000c,0x00000006,
+    0x00000021,0x00000001,0x00000042,0x00000020,0x00050041,0x00000009,0x00000024,0x00000015,
+    0x00000023,0x0004003d,0x00000006,0x00000025,0x00000024,0x00050041,0x00000009,0x00000027,
+    0x00000015,0x00000026,0x0004003d,0x00000006,0x00000028,0x00000027,0x0007000c,0x00000006,
+    0x00000029,0x00000001,0x00000028,0x00000025,0x00000028,0x0007000c,0x00000006,0x0000002a,
+    0x00000001,0x00000025,0x00000029,0x0000001e,0x00050081,0x00000006,0x0000002b,0x00000021,
+    0x0000002a,0x0004003d,0x00000006,0x0000002c,0x0000000d,0x00050083,0x00000006,0x0000002d,
+    0x0000002b,0x0000002c,0x000200fe,0x0000002d,0x00010038,0x00050036,0x00000006,0x00000013,
+    0x00000000,0x00000010,0x00030037,0x00000008,0x00000011,0x00030037,0x00000008,0x00000012,
+    0x000200f8,0x00000014,0x0004003b,0x00000009,0x00000030,0x00000007,0x0004003b,0x00000009,
+    0x00000035,0x00000007,0x0004003d,0x00000007,0x00000031,0x00000011,0x0004003d,0x00000007,
+    0x00000032,0x00000012,0x00050088,0x00000007,0x00000033,0x00000031,0x00000032,0x0006000c,
+    0x00000006,0x00000034,0x00000001,0x00000042,0x00000033,0x0003003e,0x00000030,0x00000034,
+    0x0004003d,0x00000007,0x00000036,0x00000011,0x0004003d,0x00000007,0x00000037,0x00000012,
+    0x0004003d,0x00000007,0x00000038,0x00000012,0x00050085,0x00000007,0x00000039,0x00000037,
+    0x00000038,0x00050088,0x00000007,0x0000003a,0x00000036,0x00000039,0x0006000c,0x00000006,
+    0x0000003b,0x00000001,0x00000042,0x0000003a,0x0003003e,0x00000035,0x0000003b,0x0004003d,
+    0x00000006,0x0000003c,0x00000030,0x0004003d,0x00000006,0x0000003d,0x00000030,0x00050083,
+    0x00000006,0x0000003f,0x0000003d,0x0000003e,0x00050085,0x00000006,0x00000040,0x0000003c,
+    0x0000003f,0x0004003d,0x00000006,0x00000041,0x00000035,0x0007000c,0x00000006,0x00000043,
+    0x00000001,0x00000028,0x00000041,0x00000042,0x00050088,0x00000006,0x00000044,0x00000040,
+    0x00000043,0x000200fe,0x00000044,0x00010038
+};
+
 struct Vertex_PushConstants
 {
     float screen_width;
     float screen_height;
     float scale_x;
     float scale_y;
+    float translate_x;
+    float translate_y;
 };
 
 static void Vulkan_CreatePipeline(KidsRender::Vulkan_Pipeline& pipeline
     , VkDevice device
+    , VkPipelineCache pipeline_cache
     , VkDescriptorSetLayout descriptor_set_layout
     , VkRenderPass render_pass
     , VkSampleCountFlagBits msaa_samples
     , VkShaderModule vertex_module
     , VkShaderModule fragment_module
-    , VkPrimitiveTopology topology)
+    , Primitive primitive)
 {
     VkPipelineShaderStageCreateInfo vertex_info{};
     vertex_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -1124,14 +3160,16 @@ static void Vulkan_CreatePipeline(KidsRender::Vulkan_Pipeline& pipeline
     fragment_info.pName = "main"; // entrypoint.
     fragment_info.pSpecializationInfo = nullptr;
 
+    // Quads and shapes take a pair of Vertex, see Primitive.
+    const bool is_quads = (primitive == Primitive::Quads);
     VkPipelineVertexInputStateCreateInfo vertex_input_info{};
     VkVertexInputBindingDescription binding_description =
     {
         .binding = 0,
-        .stride = sizeof(Vertex),
-        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+        .stride = uint32_t((primitive == Primitive::Triangles) ? sizeof(Vertex) : (2 * sizeof(Vertex))),
+        .inputRate = (is_quads ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX),
     };
-    VkVertexInputAttributeDescription attribute_descriptions[] =
+    VkVertexInputAttributeDescription attribute_descriptions[6] =
     {
         VkVertexInputAttributeDescription
         {
@@ -1151,23 +3189,53 @@ static void Vulkan_CreatePipeline(KidsRender::Vulkan_Pipeline& pipeline
         {
             .location = 2,
             .binding = binding_description.binding,
-            .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+            .format = VK_FORMAT_R8G8B8A8_UNORM, // vec4 in the shader.
             .offset = offsetof(Vertex, c_),
         },
     };
+    std::uint32_t attribute_count = 3;
+    auto add_attribute = [&](VkFormat format, std::size_t offset)
+    {
+        attribute_descriptions[attribute_count] = VkVertexInputAttributeDescription
+        {
+            .location = attribute_count,
+            .binding = binding_description.binding,
+            .format = format,
+            .offset = uint32_t(offset),
+        };
+        ++attribute_count;
+    };
+    switch (primitive)
+    {
+    case Primitive::Triangles:
+        break;
+    case Primitive::SdfShapes:
+        // 2nd Vertex holds half size and params.
+        add_attribute(VK_FORMAT_R32G32_SFLOAT, sizeof(Vertex) + offsetof(Vertex, uv_));
+        add_attribute(VK_FORMAT_R16G16_UINT, sizeof(Vertex) + offsetof(Vertex, c_)); // See Sdf_PackParams().
+        break;
+    case Primitive::Quads:
+        // 2nd Vertex holds max corner, uv and index of the texture in the batch.
+        add_attribute(VK_FORMAT_R32G32_SFLOAT, sizeof(Vertex) + offsetof(Vertex, p_));
+        add_attribute(VK_FORMAT_R32G32_SFLOAT, sizeof(Vertex) + offsetof(Vertex, uv_));
+        add_attribute(VK_FORMAT_R8_UINT, sizeof(Vertex) + offsetof(Vertex, c_) + offsetof(kk::Color, r));
+        break;
+    }
     vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertex_input_info.pNext = nullptr;
     vertex_input_info.flags = 0;
     vertex_input_info.vertexBindingDescriptionCount = 1;
     vertex_input_info.pVertexBindingDescriptions = &binding_description;
-    vertex_input_info.vertexAttributeDescriptionCount = uint32_t(std::size(attribute_descriptions));
+    vertex_input_info.vertexAttributeDescriptionCount = attribute_count;
     vertex_input_info.pVertexAttributeDescriptions = attribute_descriptions;
 
     VkPipelineInputAssemblyStateCreateInfo input_assembly_info{};
     input_assembly_info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
     input_assembly_info.pNext = nullptr;
     input_assembly_info.flags = 0;
-    input_assembly_info.topology = topology;
+    input_assembly_info.topology = (is_quads
+        ? VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP
+        : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
     input_assembly_info.primitiveRestartEnable = VK_FALSE;
 
     const VkDynamicState dynamic_states[2] =
@@ -1220,8 +3288,9 @@ static void Vulkan_CreatePipeline(KidsRender::Vulkan_Pipeline& pipeline
     color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
     color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+    // a + dst.a * (1 - a), same as OpenGL and Software.
     color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
     color_blend_attachment.colorWriteMask =
         VK_COLOR_COMPONENT_R_BIT |
@@ -1282,7 +3351,65 @@ static void Vulkan_CreatePipeline(KidsRender::Vulkan_Pipeline& pipeline
     pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
     pipeline_info.basePipelineIndex = -1;
 
-    KK_VERIFY(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline.pipeline) == VK_SUCCESS);
+    KK_VERIFY(vkCreateGraphicsPipelines(device, pipeline_cache, 1, &pipeline_info, nullptr, &pipeline.pipeline) == VK_SUCCESS);
+}
+
+// See VkPipelineCacheHeaderVersionOne.
+static bool PipelineCache_IsCompatible(VkPhysicalDevice physical_device, const std::vector<std::uint8_t>& data)
+{
+    const std::size_t kHeaderSize = (4 * sizeof(std::uint32_t) + VK_UUID_SIZE);
+    if (data.size() < kHeaderSize)
+        return false;
+    std::uint32_t header[4]{}; // headerSize, headerVersion, vendorID, deviceID.
+    std::memcpy(header, data.data(), sizeof(header));
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    return (header[0] >= kHeaderSize)
+        && (header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+        && (header[2] == properties.vendorID)
+        && (header[3] == properties.deviceID)
+        && (std::memcmp(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0);
+}
+
+VkPipelineCache PipelineCache_Load(VkPhysicalDevice physical_device
+    , VkDevice device
+    , const char* file_path
+    , bool* loaded /*= nullptr*/)
+{
+    std::vector<std::uint8_t> data;
+    if (std::FILE* file = (file_path ? std::fopen(file_path, "rb") : nullptr))
+    {
+        std::uint8_t chunk[16 * 1024];
+        std::size_t count = 0;
+        while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+            data.insert(data.end(), chunk, chunk + count);
+        std::fclose(file);
+    }
+    if (!PipelineCache_IsCompatible(physical_device, data))
+        data.clear(); // Other GPU or driver: start from scratch.
+
+    VkPipelineCacheCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.initialDataSize = data.size();
+    info.pInitialData = (data.empty() ? nullptr : data.data());
+    VkPipelineCache pipeline_cache{};
+    KK_VERIFY(vkCreatePipelineCache(device, &info, nullptr, &pipeline_cache) == VK_SUCCESS);
+    if (loaded)
+        *loaded = !data.empty();
+    return pipeline_cache;
+}
+
+bool PipelineCache_Save(VkDevice device, VkPipelineCache pipeline_cache, const char* file_path)
+{
+    std::size_t size = 0;
+    KK_VERIFY(vkGetPipelineCacheData(device, pipeline_cache, &size, nullptr) == VK_SUCCESS);
+    std::vector<std::uint8_t> data(size);
+    KK_VERIFY(vkGetPipelineCacheData(device, pipeline_cache, &size, data.data()) == VK_SUCCESS);
+    std::FILE* file = std::fopen(file_path, "wb");
+    if (!file)
+        return false;
+    const bool ok = (std::fwrite(data.data(), 1, size, file) == size);
+    return (std::fclose(file) == 0) && ok;
 }
 
 static void Vulkan_KillPipeline(VkDevice device, KidsRender::Vulkan_Pipeline& pipeline)
@@ -1292,13 +3419,13 @@ static void Vulkan_KillPipeline(VkDevice device, KidsRender::Vulkan_Pipeline& pi
     pipeline = {};
 }
 
-static void Vulkan_Buffer_Create(VkPhysicalDevice physical_device
+static void Vulkan_Buffer_Create(VulkanMemory& memory
     , VkDevice device
     , VkDeviceSize size
     , VkBufferUsageFlags usage
     , VkMemoryPropertyFlags properties
     , VkBuffer& buffer
-    , VkDeviceMemory& buffer_memory)
+    , VulkanMemory_Allocation& allocation)
 {
     VkBufferCreateInfo buffer_info{};
     buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -1313,56 +3440,13 @@ static void Vulkan_Buffer_Create(VkPhysicalDevice physical_device
     VkMemoryRequirements mem_requirements{};
     vkGetBufferMemoryRequirements(device, buffer, &mem_requirements);
 
-    VkPhysicalDeviceMemoryProperties mem_properties{};
-    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
-    uint32_t mem_index = uint32_t(-1);
-    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; ++i)
-    {
-        if ((mem_requirements.memoryTypeBits & (1 << i))
-            && ((mem_properties.memoryTypes[i].propertyFlags & properties) == properties))
-        {
-            mem_index = i;
-            break;
-        }
-    }
-    KK_VERIFY(mem_index != uint32_t(-1));
-
-    VkMemoryAllocateInfo vertex_alloc_info{};
-    vertex_alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    vertex_alloc_info.pNext = nullptr;
-    vertex_alloc_info.allocationSize = mem_requirements.size;
-    vertex_alloc_info.memoryTypeIndex = mem_index;
-
-    KK_VERIFY(vkAllocateMemory(device, &vertex_alloc_info, nullptr, &buffer_memory) == VK_SUCCESS);
-    KK_VERIFY(vkBindBufferMemory(device, buffer, buffer_memory, 0) == VK_SUCCESS);
+    allocation = memory.allocate(mem_requirements, properties, VulkanMemory_Kind::Buffer);
+    KK_VERIFY(vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset) == VK_SUCCESS);
 }
 
-static void Vulkan_Kill_FrameData(KidsRender::Vulkan_Frame& frame, RenderData& render_data)
+static void Vulkan_Kill_FrameData(KidsRender::Vulkan_Frame& frame)
 {
     frame.image_in_use_list_.clear();
-    if (frame.descriptor_set_list_.size() > 0)
-    {
-        KK_VERIFY(vkFreeDescriptorSets(render_data.device
-            , render_data.descriptor_pool
-            , uint32_t(frame.descriptor_set_list_.size())
-            , frame.descriptor_set_list_.data()) == VK_SUCCESS);
-    }
-    frame.descriptor_set_list_.clear();
-
-    if (frame.vertex_buffer)
-    {
-        vkDestroyBuffer(render_data.device, frame.vertex_buffer, nullptr);
-        frame.vertex_buffer = {};
-        vkFreeMemory(render_data.device, frame.vertex_memory, nullptr);
-        frame.vertex_memory = {};
-    }
-    if (frame.index_buffer)
-    {
-        vkDestroyBuffer(render_data.device, frame.index_buffer, nullptr);
-        frame.index_buffer = {};
-        vkFreeMemory(render_data.device, frame.index_memory, nullptr);
-        frame.index_memory = {};
-    }
 
     for (auto& clean_up : frame.to_flush_)
         clean_up();
@@ -1370,51 +3454,146 @@ static void Vulkan_Kill_FrameData(KidsRender::Vulkan_Frame& frame, RenderData& r
     std::swap(frame.to_flush_, frame.clean_up_list_);
 }
 
+static void Vulkan_Kill_FrameBuffer(KidsRender::Vulkan_Frame& frame, KidsRender& render)
+{
+    if (frame.buffer)
+    {
+        vkDestroyBuffer(render.render_data_.device, frame.buffer, nullptr);
+        render.memory_->free(frame.memory);
+    }
+    frame.buffer = {};
+    frame.mapped = nullptr;
+    frame.capacity = 0;
+    frame.index_offset = 0;
+}
+
+static VkDeviceSize Vulkan_FrameBuffer_GrowCapacity(VkDeviceSize capacity, VkDeviceSize required)
+{
+    VkDeviceSize new_capacity = (std::max)(capacity, VkDeviceSize(64 * 1024));
+    while (new_capacity < required)
+        new_capacity *= 2;
+    return new_capacity;
+}
+
 static void Vulkan_Recreate_FrameData(KidsRender::Vulkan_Frame& frame
-    , RenderData& render_data
+    , KidsRender& render
     , const std::span<const Vertex>& vertices
     , const std::span<const Index>& indices)
 {
-    Vulkan_Kill_FrameData(frame, render_data);
+    // Slot is reused only once GPU is done with it (OsRender waits
+    // for the in-flight fence), hence it's safe to overwrite/free.
+    Vulkan_Kill_FrameData(frame);
+
+    const VkDeviceSize vertex_size = (sizeof(Vertex) * vertices.size());
+    const VkDeviceSize index_size = (sizeof(Index) * indices.size());
+    // vkCmdBindIndexBuffer() offset must be a multiple of index type size.
+    const VkDeviceSize index_offset = ((vertex_size + 15) & ~VkDeviceSize(15));
+    const VkDeviceSize required = (index_offset + index_size);
+    if (required == 0)
+        return; // Only retained lists are drawn.
+    if (required > frame.capacity)
     {
-        const std::size_t vertex_size = (sizeof(Vertex) * vertices.size());
-        Vulkan_Buffer_Create(render_data.physical_device, render_data.device, vertex_size
-            , VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+        const VkDeviceSize capacity = Vulkan_FrameBuffer_GrowCapacity(frame.capacity, required);
+        Vulkan_Kill_FrameBuffer(frame, render);
+        Vulkan_Buffer_Create(*render.memory_, render.render_data_.device, capacity
+            , VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
             , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-            , frame.vertex_buffer
-            , frame.vertex_memory);
-        void* vertex_data = nullptr;
-        KK_VERIFY(vkMapMemory(render_data.device, frame.vertex_memory, 0, vertex_size, 0, &vertex_data) == VK_SUCCESS);
-        memcpy(vertex_data, &vertices[0], vertex_size);
-        vkUnmapMemory(render_data.device, frame.vertex_memory);
+            , frame.buffer
+            , frame.memory);
+        frame.mapped = frame.memory.mapped;
+        frame.capacity = capacity;
     }
+
+    std::uint8_t* data = static_cast<std::uint8_t*>(frame.mapped);
+    memcpy(data, vertices.data(), std::size_t(vertex_size));
+    memcpy(data + index_offset, indices.data(), std::size_t(index_size));
+    frame.index_offset = index_offset;
+}
+
+void KidsRender::Vulkan_DescriptorPools::free_batch_sets(VkImageView image_view)
+{
+    std::erase_if(batch_set_list, [&](const Vulkan_BatchSet& batch_set)
     {
-        const std::size_t index_size = (sizeof(Index) * indices.size());
-        Vulkan_Buffer_Create(render_data.physical_device, render_data.device, index_size
-            , VK_BUFFER_USAGE_INDEX_BUFFER_BIT
-            , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-            , frame.index_buffer
-            , frame.index_memory);
-        void* index_data = nullptr;
-        KK_VERIFY(vkMapMemory(render_data.device, frame.index_memory, 0, index_size, 0, &index_data) == VK_SUCCESS);
-        memcpy(index_data, &indices[0], index_size);
-        vkUnmapMemory(render_data.device, frame.index_memory);
-    }
+        if (std::find(std::begin(batch_set.image_views), std::end(batch_set.image_views), image_view)
+            == std::end(batch_set.image_views))
+        {
+            return false;
+        }
+        KK_VERIFY(vkFreeDescriptorSets(device, batch_set.pool, 1, &batch_set.descriptor_set) == VK_SUCCESS);
+        return true;
+    });
 }
 
-static VkDescriptorSet Vulkan_CreateDescriptorSet(const RenderData& render_data
+KidsRender::Vulkan_DescriptorPools::~Vulkan_DescriptorPools() noexcept
+{
+    for (const Vulkan_BatchSet& batch_set : batch_set_list)
+        vkFreeDescriptorSets(device, batch_set.pool, 1, &batch_set.descriptor_set);
+    // pool_list[0] is RenderData::descriptor_pool.
+    for (std::size_t i = 1; i < pool_list.size(); ++i)
+        vkDestroyDescriptorPool(device, pool_list[i], nullptr);
+}
+
+// Same kind as os_render_vulkan.cc creates for RenderData::descriptor_pool.
+static VkDescriptorPool Vulkan_CreateDescriptorPool(VkDevice device)
+{
+    const std::uint32_t max_sets = 1024;
+    VkDescriptorPoolSize descriptor_pool_size[] =
+    {
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, max_sets},
+        {VK_DESCRIPTOR_TYPE_SAMPLER, max_sets},
+    };
+    VkDescriptorPoolCreateInfo descriptor_pool_info{};
+    descriptor_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptor_pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    descriptor_pool_info.poolSizeCount = static_cast<uint32_t>(std::size(descriptor_pool_size));
+    descriptor_pool_info.maxSets = max_sets;
+    descriptor_pool_info.pPoolSizes = descriptor_pool_size;
+    VkDescriptorPool descriptor_pool{};
+    KK_VERIFY(vkCreateDescriptorPool(device, &descriptor_pool_info, nullptr, &descriptor_pool) == VK_SUCCESS);
+    return descriptor_pool;
+}
+
+// Tries every pool, starting with the last one that had space;
+// adds new pool when all are full.
+static VkDescriptorSet Vulkan_AllocateDescriptorSet(KidsRender::Vulkan_DescriptorPools& pools
     , VkDescriptorSetLayout descriptor_set_layout
-    , VkImageView image_view
-    , VkSampler sampler)
+    , VkDescriptorPool& pool)
 {
     VkDescriptorSet descriptor_set{};
     VkDescriptorSetAllocateInfo alloc_info = {};
     alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    alloc_info.descriptorPool = render_data.descriptor_pool;
     alloc_info.descriptorSetCount = 1;
     alloc_info.pSetLayouts = &descriptor_set_layout;
-    KK_VERIFY(vkAllocateDescriptorSets(render_data.device, &alloc_info
-        , &descriptor_set) == VK_SUCCESS);
+    const std::size_t count = pools.pool_list.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::size_t index = ((pools.current + i) % count);
+        alloc_info.descriptorPool = pools.pool_list[index];
+        const VkResult result = vkAllocateDescriptorSets(pools.device, &alloc_info, &descriptor_set);
+        if (result == VK_SUCCESS)
+        {
+            pools.current = index;
+            pool = pools.pool_list[index];
+            return descriptor_set;
+        }
+        KK_VERIFY((result == VK_ERROR_OUT_OF_POOL_MEMORY) || (result == VK_ERROR_FRAGMENTED_POOL));
+    }
+
+    pools.pool_list.push_back(Vulkan_CreateDescriptorPool(pools.device));
+    pools.current = count;
+    alloc_info.descriptorPool = pools.pool_list.back();
+    KK_VERIFY(vkAllocateDescriptorSets(pools.device, &alloc_info, &descriptor_set) == VK_SUCCESS);
+    pool = pools.pool_list.back();
+    return descriptor_set;
+}
+
+static VkDescriptorSet Vulkan_CreateDescriptorSet(KidsRender::Vulkan_DescriptorPools& pools
+    , VkDescriptorSetLayout descriptor_set_layout
+    , VkImageView image_view
+    , VkSampler sampler
+    , VkDescriptorPool& pool)
+{
+    VkDescriptorSet descriptor_set = Vulkan_AllocateDescriptorSet(pools, descriptor_set_layout, pool);
 
     VkDescriptorImageInfo image_info{};
     image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -1439,32 +3618,80 @@ static VkDescriptorSet Vulkan_CreateDescriptorSet(const RenderData& render_data
     descriptor_writes[1].dstArrayElement = 0;
     descriptor_writes[1].dstBinding = 2;
 
-    vkUpdateDescriptorSets(render_data.device, 2, descriptor_writes, 0, nullptr);
+    vkUpdateDescriptorSets(pools.device, 2, descriptor_writes, 0, nullptr);
     return descriptor_set;
 }
 
-static VkDescriptorSet Vulkan_Frame_ChooseDescriptoSet_FromCache(KidsRender::Vulkan_Frame& frame
-    , RenderData& render_data
-    , VkDescriptorSetLayout descriptor_set_layout
-    , VkSampler texture_sampler
-    , DrawCmd draw_cmd
-    , const ImageRef& white_1x1
-    , VkDescriptorSet white_descriptor_set)
+// Every image owns its descriptor set; the frame only keeps it alive.
+static VkDescriptorSet Vulkan_Frame_UseTexture(KidsRender::Vulkan_Frame& frame
+    , const ImageRef& texture
+    , const ImageRef& white_1x1)
 {
-    if (draw_cmd.texture_ == white_1x1)
-        return white_descriptor_set;
-    KK_VERIFY(frame.descriptor_set_list_.size()
-        == frame.image_in_use_list_.size());
-    if (!frame.image_in_use_list_.empty())
+    if ((texture != white_1x1) // Owned by KidsRender.
+        && (frame.image_in_use_list_.empty() || (frame.image_in_use_list_.back() != texture)))
+    {
+        frame.image_in_use_list_.push_back(texture);
+    }
+    return texture.descriptor_set();
+}
+
+// Allocated once per combination of textures, from the same pools as
+// images' own sets; the frame keeps textures (so the set) alive.
+// Unused array elements point at white_1x1, see shader_quad_batch.frag.
+static VkDescriptorSet Vulkan_Frame_BatchDescriptorSet(KidsRender& render
+    , KidsRender::Vulkan_Frame& frame
+    , const KidsRender::TextureSet& texture_set)
+{
+    KidsRender::Vulkan_BatchSet batch_set{};
+    for (std::size_t i = 0; i < KidsRender::kMaxBatchTextures; ++i)
+    {
+        const ImageRef& texture = (i < texture_set.count) ? texture_set.textures[i] : render.white_1x1_;
+        Vulkan_Frame_UseTexture(frame, texture, render.white_1x1_);
+        batch_set.image_views[i] = texture.image_view();
+    }
+    KidsRender::Vulkan_DescriptorPools& pools = *render.descriptor_pools_;
+    for (const KidsRender::Vulkan_BatchSet& cached : pools.batch_set_list)
+    {
+        if (std::equal(std::begin(cached.image_views), std::end(cached.image_views)
+            , std::begin(batch_set.image_views)))
+        {
+            return cached.descriptor_set;
+        }
+    }
+
+    const VkDevice device = render.render_data_.device;
+    const VkDescriptorSet descriptor_set = Vulkan_AllocateDescriptorSet(pools
+        , render.batch_descriptor_set_layout_, batch_set.pool);
+    batch_set.descriptor_set = descriptor_set;
+    pools.batch_set_list.push_back(batch_set);
+    // Within this draw(): FrameStats are set already.
+    ++render.frame_stats_.descriptor_sets_allocated;
+
+    VkDescriptorImageInfo image_info[KidsRender::kMaxBatchTextures]{};
+    for (std::size_t i = 0; i < KidsRender::kMaxBatchTextures; ++i)
     {
-        if (frame.image_in_use_list_.back() == draw_cmd.texture_)
-            return frame.descriptor_set_list_.back();
+        image_info[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        image_info[i].imageView = batch_set.image_views[i];
     }
+    VkDescriptorImageInfo sampler_info{};
+    sampler_info.sampler = render.texture_sampler_;
 
-    frame.image_in_use_list_.push_back(draw_cmd.texture_);
-    VkDescriptorSet descriptor_set = Vulkan_CreateDescriptorSet(render_data
-        , descriptor_set_layout, draw_cmd.texture_.image_view(), texture_sampler);
-    frame.descriptor_set_list_.push_back(descriptor_set);
+    VkWriteDescriptorSet descriptor_writes[2]{};
+    descriptor_writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_writes[0].dstSet = descriptor_set;
+    descriptor_writes[0].descriptorCount = std::uint32_t(KidsRender::kMaxBatchTextures);
+    descriptor_writes[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    descriptor_writes[0].pImageInfo = image_info;
+    descriptor_writes[0].dstArrayElement = 0;
+    descriptor_writes[0].dstBinding = 1;
+    descriptor_writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_writes[1].dstSet = descriptor_set;
+    descriptor_writes[1].descriptorCount = 1;
+    descriptor_writes[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    descriptor_writes[1].pImageInfo = &sampler_info;
+    descriptor_writes[1].dstArrayElement = 0;
+    descriptor_writes[1].dstBinding = 2;
+    vkUpdateDescriptorSets(device, 2, descriptor_writes, 0, nullptr);
     return descriptor_set;
 }
 
@@ -1484,94 +3711,431 @@ static VkRect2D Vulkan_Scissor(const DrawCmd& draw_cmd, const kk::Size& screen_s
     return scissor;
 }
 
+// What draw() has recorded to the command buffer so far: Vulkan_Record_Frame()
+// emits only the state that differs from the previous DrawCmd.
+struct Vulkan_BoundState
+{
+    VkPipeline pipeline{};
+    VkPipelineLayout layout{};
+    bool has_viewport = false;
+    bool has_push_constants = false;
+    kk::Vec2f scale{};
+    kk::Point2f translate{};
+    VkBuffer vertex_buffer{};
+    VkDeviceSize vertex_offset = 0;
+    VkBuffer index_buffer{};
+    VkDeviceSize index_offset = 0;
+    bool has_scissor = false;
+    VkRect2D scissor{};
+    VkDescriptorSet descriptor_set{};
+};
+
 static void Vulkan_Record_Frame(KidsRender::Vulkan_Frame& frame
-    , RenderData& render_data
-    , VkDescriptorSetLayout descriptor_set_layout
-    , VkSampler texture_sampler
+    , Vulkan_BoundState& bound
+    , FrameStats& stats
     , DrawCmd draw_cmd
     , const ImageRef& white_1x1
-    , VkDescriptorSet white_1x1_descriptor_set
-    , KidsRender::Vulkan_Pipeline& pipeline
+    , const KidsRender::Vulkan_Pipeline& pipeline // Of draw_cmd.primitive_.
     , VkCommandBuffer cmd_buffer
     , const kk::Size& screen_size
     , const kk::Vec2f& scale
+    , VkBuffer buffer // Vertices + indices.
+    , VkDeviceSize index_offset
+    , const kk::Point2f& translate
+    , VkDescriptorSet batch_descriptor_set // Of batched textures, if any.
     )
 {
-    vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pipeline);
-
-    Vertex_PushConstants push_constants{};
-    push_constants.screen_width = float(screen_size.width);
-    push_constants.screen_height = float(screen_size.height);
-    push_constants.scale_x = scale.x;
-    push_constants.scale_y = scale.y;
-    vkCmdPushConstants(cmd_buffer
-        , pipeline.layout
-        , VK_SHADER_STAGE_VERTEX_BIT
-        , 0
-        , sizeof(Vertex_PushConstants)
-        , &push_constants);
-
-    VkViewport viewport{};
-    viewport.x = 0;
-    viewport.y = 0;
-    viewport.width = float((std::max)(screen_size.width, 1));
-    viewport.height = float((std::max)(screen_size.height, 1));
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(cmd_buffer, 0, 1, &viewport);
-
-    VkRect2D scissor = Vulkan_Scissor(draw_cmd, screen_size);
-    vkCmdSetScissor(cmd_buffer, 0, 1, &scissor);
+    const bool is_quads = (draw_cmd.primitive_ == Primitive::Quads);
+    const bool is_pairs = (draw_cmd.primitive_ != Primitive::Triangles); // See Primitive.
+    if (bound.pipeline != pipeline.pipeline)
+    {
+        vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pipeline);
+        if (bound.layout != pipeline.layout)
+        {
+            // Batch layout has other set layout: set and push
+            // constants are not compatible with the previous ones.
+            bound.layout = pipeline.layout;
+            bound.has_push_constants = false;
+            bound.descriptor_set = VkDescriptorSet{};
+        }
+        bound.pipeline = pipeline.pipeline;
+        ++stats.state_changes;
+    }
+
+    if (!bound.has_viewport)
+    {
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = float((std::max)(screen_size.width, 1));
+        viewport.height = float((std::max)(screen_size.height, 1));
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(cmd_buffer, 0, 1, &viewport);
+        bound.has_viewport = true;
+        ++stats.state_changes;
+    }
+
+    // Same as OpenGL's Translate uniform: GPU-resident geometry is not touched.
+    if (!bound.has_push_constants || (bound.scale != scale) || (bound.translate != translate))
+    {
+        Vertex_PushConstants push_constants{};
+        push_constants.screen_width = float(screen_size.width);
+        push_constants.screen_height = float(screen_size.height);
+        push_constants.scale_x = scale.x;
+        push_constants.scale_y = scale.y;
+        push_constants.translate_x = translate.x;
+        push_constants.translate_y = translate.y;
+        vkCmdPushConstants(cmd_buffer
+            , pipeline.layout
+            , VK_SHADER_STAGE_VERTEX_BIT
+            , 0
+            , sizeof(Vertex_PushConstants)
+            , &push_constants);
+        bound.has_push_constants = true;
+        bound.scale = scale;
+        bound.translate = translate;
+        ++stats.state_changes;
+    }
+
+    const VkRect2D scissor = Vulkan_Scissor(draw_cmd, screen_size);
+    if (!bound.has_scissor
+        || (bound.scissor.offset.x != scissor.offset.x)
+        || (bound.scissor.offset.y != scissor.offset.y)
+        || (bound.scissor.extent.width != scissor.extent.width)
+        || (bound.scissor.extent.height != scissor.extent.height))
+    {
+        vkCmdSetScissor(cmd_buffer, 0, 1, &scissor);
+        bound.has_scissor = true;
+        bound.scissor = scissor;
+        ++stats.scissor_changes;
+    }
 
     static_assert(sizeof(Index) == 2); // VK_INDEX_TYPE_UINT16.
 
-    VkDeviceSize vertex_offset = 0;
-    VkDeviceSize index_offset = 0;
-    vkCmdBindVertexBuffers(cmd_buffer, 0, 1, &frame.vertex_buffer, &vertex_offset);
-    vkCmdBindIndexBuffer(cmd_buffer, frame.index_buffer, index_offset, VK_INDEX_TYPE_UINT16);
+    // Quads, shapes: firstInstance/vertexOffset count pairs of Vertex;
+    // odd vertex_offset_ shifts the binding by one Vertex instead.
+    const VkDeviceSize vertex_offset = (is_pairs ? ((draw_cmd.vertex_offset_ % 2) * sizeof(Vertex)) : 0);
+    if ((bound.vertex_buffer != buffer) || (bound.vertex_offset != vertex_offset))
+    {
+        vkCmdBindVertexBuffers(cmd_buffer, 0, 1, &buffer, &vertex_offset);
+        bound.vertex_buffer = buffer;
+        bound.vertex_offset = vertex_offset;
+        ++stats.state_changes;
+    }
+    if (!is_quads && ((bound.index_buffer != buffer) || (bound.index_offset != index_offset)))
+    {
+        vkCmdBindIndexBuffer(cmd_buffer, buffer, index_offset, VK_INDEX_TYPE_UINT16);
+        bound.index_buffer = buffer;
+        bound.index_offset = index_offset;
+        ++stats.state_changes;
+    }
 
-    VkDescriptorSet descriptor_set = Vulkan_Frame_ChooseDescriptoSet_FromCache(
-        frame, render_data, descriptor_set_layout, texture_sampler
-        , draw_cmd, white_1x1, white_1x1_descriptor_set);
+    VkDescriptorSet descriptor_set = batch_descriptor_set
+        ? batch_descriptor_set
+        : Vulkan_Frame_UseTexture(frame, draw_cmd.texture_, white_1x1);
+    if (bound.descriptor_set != descriptor_set)
+    {
+        vkCmdBindDescriptorSets(cmd_buffer
+            , VK_PIPELINE_BIND_POINT_GRAPHICS
+            , pipeline.layout
+            , 0
+            , 1
+            , &descriptor_set
+            , 0
+            , nullptr);
+        bound.descriptor_set = descriptor_set;
+        ++stats.texture_binds;
+    }
 
-    vkCmdBindDescriptorSets(cmd_buffer
-        , VK_PIPELINE_BIND_POINT_GRAPHICS
-        , pipeline.layout
-        , 0
-        , 1
-        , &descriptor_set
-        , 0
-        , nullptr);
+    if (is_quads)
+    {
+        // Triangle strip of 4 corners per instance, see shader_quad.vert.
+        vkCmdDraw(cmd_buffer
+            , 4
+            , uint32_t(draw_cmd.vertex_count_ / 2)
+            , 0
+            , uint32_t(draw_cmd.vertex_offset_ / 2));
+    }
+    else
+    {
+        vkCmdDrawIndexed(cmd_buffer
+            , uint32_t(draw_cmd.index_count_)
+            , 1
+            , uint32_t(draw_cmd.index_offset_)
+            , int32_t(is_pairs ? (draw_cmd.vertex_offset_ / 2) : draw_cmd.vertex_offset_)
+            , 0);
+    }
+    ++stats.draw_cmds;
+    stats.vertices += draw_cmd.vertex_count_;
+    stats.indices += draw_cmd.index_count_;
+}
 
-    vkCmdDrawIndexed(cmd_buffer
-        , uint32_t(draw_cmd.index_count_)
-        , 1
-        , uint32_t(draw_cmd.index_offset_)
-        , 0
-        , 0);
+// Returns uploaded size, in bytes.
+static std::size_t Vulkan_Retained_Upload(KidsRender& render, RetainedCmdList& retained)
+{
+    const RenderData& render_data = render.render_data_;
+    const VkDevice device = render_data.device;
+    if (retained.buffer_)
+    {
+        // Previous frames may still read from it.
+        render.defer_clean_up([device, buffer = retained.buffer_
+            , memory = render.memory_, allocation = retained.memory_]() mutable
+        {
+            vkDestroyBuffer(device, buffer, nullptr);
+            memory->free(allocation);
+        });
+        retained.buffer_ = {};
+        retained.memory_ = {};
+    }
+    retained.dirty_ = false;
+
+    const CmdList& cmd_list = retained.cmd_list_;
+    const VkDeviceSize vertex_size = (sizeof(Vertex) * cmd_list.vertex_list_.size());
+    const VkDeviceSize index_size = (sizeof(Index) * cmd_list.index_list_.size());
+    const VkDeviceSize index_offset = ((vertex_size + 15) & ~VkDeviceSize(15));
+    const VkDeviceSize size = (index_offset + index_size);
+    retained.index_offset_ = index_offset;
+    if (size == 0)
+        return 0;
+
+    VkBuffer upload_buffer{};
+    VulkanMemory_Allocation upload_memory{};
+    Vulkan_Buffer_Create(*render.memory_, device, size
+        , VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+        , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        , upload_buffer
+        , upload_memory);
+    void* data = upload_memory.mapped;
+    memcpy(data, cmd_list.vertex_list_.data(), std::size_t(vertex_size));
+    memcpy(static_cast<std::uint8_t*>(data) + index_offset, cmd_list.index_list_.data(), std::size_t(index_size));
+
+    Vulkan_Buffer_Create(*render.memory_, device, size
+        , VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+        , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        , retained.buffer_
+        , retained.memory_);
+
+    VkCommandBuffer command_buffer{};
+    VkCommandBufferAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.pNext = nullptr;
+    alloc_info.commandPool = render_data.work_command_pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+    KK_VERIFY(vkAllocateCommandBuffers(device, &alloc_info, &command_buffer) == VK_SUCCESS);
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    KK_VERIFY(vkBeginCommandBuffer(command_buffer, &begin_info) == VK_SUCCESS);
+
+    VkBufferCopy region{};
+    region.srcOffset = 0;
+    region.dstOffset = 0;
+    region.size = size;
+    vkCmdCopyBuffer(command_buffer, upload_buffer, retained.buffer_, 1, &region);
+
+    // Frame's command buffer is submitted after this one to the same queue.
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+        , 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    KK_VERIFY(vkEndCommandBuffer(command_buffer) == VK_SUCCESS);
+
+    VkSubmitInfo end_info = {};
+    end_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    end_info.commandBufferCount = 1;
+    end_info.pCommandBuffers = &command_buffer;
+    KK_VERIFY(vkQueueSubmit(render_data.work_queue, 1, &end_info, VK_NULL_HANDLE) == VK_SUCCESS);
+
+    render.defer_clean_up([device, upload_buffer, memory = render.memory_, upload_memory, command_buffer
+        , command_pool = render_data.work_command_pool]() mutable
+    {
+        vkDestroyBuffer(device, upload_buffer, nullptr);
+        memory->free(upload_memory);
+        vkFreeCommandBuffers(device, command_pool, 1, &command_buffer);
+    });
+    return std::size_t(size);
+}
+
+RetainedCmdList::RetainedCmdList(KidsRender& render)
+    : render_(&render)
+{
+}
+
+RetainedCmdList::~RetainedCmdList() noexcept
+{
+    if (!buffer_)
+        return;
+    const VkDevice device = render_->render_data_.device;
+    render_->defer_clean_up([device, buffer = buffer_
+        , memory = render_->memory_, allocation = memory_]() mutable
+    {
+        vkDestroyBuffer(device, buffer, nullptr);
+        memory->free(allocation);
+    });
 }
 
 KidsRender::KidsRender() = default;
 
+// Staging chunks are reused; rare bigger ones are freed when not needed.
+static constexpr VkDeviceSize kStagingChunkSize = (1024 * 1024);
+static constexpr std::size_t kStagingChunksKept = 4;
+
+static void Vulkan_StagingChunk_Free(KidsRender& render, KidsRender::Vulkan_StagingChunk& chunk)
+{
+    vkDestroyBuffer(render.render_data_.device, chunk.buffer, nullptr);
+    render.memory_->free(chunk.memory);
+    chunk = {};
+}
+
+static KidsRender::Vulkan_StagingChunk Vulkan_StagingChunk_Get(KidsRender& render, VkDeviceSize size)
+{
+    std::vector<KidsRender::Vulkan_StagingChunk>& free_list = render.staging_free_list_;
+    for (std::size_t i = 0; i < free_list.size(); ++i)
+    {
+        if (free_list[i].capacity < size)
+            continue;
+        KidsRender::Vulkan_StagingChunk chunk = free_list[i];
+        free_list.erase(free_list.begin() + i);
+        return chunk;
+    }
+    const RenderData& render_data = render.render_data_;
+    KidsRender::Vulkan_StagingChunk chunk;
+    chunk.capacity = (std::max)(size, kStagingChunkSize);
+    Vulkan_Buffer_Create(*render.memory_, render_data.device, chunk.capacity
+        , VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+        , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        , chunk.buffer
+        , chunk.memory);
+    chunk.mapped = static_cast<std::uint8_t*>(chunk.memory.mapped);
+    return chunk;
+}
+
+// Marks finished batches as done and takes their staging chunks back.
+static void Vulkan_Uploads_Recycle(KidsRender& render, bool wait)
+{
+    const RenderData& render_data = render.render_data_;
+    std::vector<KidsRender::Vulkan_UploadBatch>& in_flight_list = render.upload_in_flight_list_;
+    std::size_t finished = 0;
+    for (KidsRender::Vulkan_UploadBatch& batch : in_flight_list)
+    {
+        if (wait)
+            KK_VERIFY(vkWaitForFences(render_data.device, 1, &batch.fence, VK_TRUE, UINT64_MAX) == VK_SUCCESS);
+        else if (vkGetFenceStatus(render_data.device, batch.fence) != VK_SUCCESS)
+            break; // Batches are submitted to one queue: finish in order.
+        *batch.done = true;
+        vkDestroyFence(render_data.device, batch.fence, nullptr);
+        vkFreeCommandBuffers(render_data.device, render_data.work_command_pool, 1, &batch.command_buffer);
+        for (KidsRender::Vulkan_StagingChunk& chunk : batch.chunk_list)
+        {
+            chunk.used = 0;
+            if (render.staging_free_list_.size() < kStagingChunksKept)
+                render.staging_free_list_.push_back(chunk);
+            else
+                Vulkan_StagingChunk_Free(render, chunk);
+        }
+        ++finished;
+    }
+    in_flight_list.erase(in_flight_list.begin(), in_flight_list.begin() + finished);
+}
+
+KidsRender::Vulkan_UploadSpace KidsRender::upload_begin(VkDeviceSize size)
+{
+    Vulkan_UploadBatch& batch = upload_batch_;
+    if (!batch.command_buffer)
+    {
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = render_data_.work_command_pool;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+        KK_VERIFY(vkAllocateCommandBuffers(render_data_.device, &alloc_info, &batch.command_buffer) == VK_SUCCESS);
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        KK_VERIFY(vkBeginCommandBuffer(batch.command_buffer, &begin_info) == VK_SUCCESS);
+        batch.done = std::make_shared<bool>(false);
+    }
+
+    // vkCmdCopyBufferToImage() offset must be a multiple of texel size.
+    VkDeviceSize offset = 0;
+    if (!batch.chunk_list.empty())
+        offset = ((batch.chunk_list.back().used + 15) & ~VkDeviceSize(15));
+    if (batch.chunk_list.empty() || ((offset + size) > batch.chunk_list.back().capacity))
+    {
+        batch.chunk_list.push_back(Vulkan_StagingChunk_Get(*this, size));
+        offset = 0;
+    }
+    Vulkan_StagingChunk& chunk = batch.chunk_list.back();
+    chunk.used = (offset + size);
+
+    Vulkan_UploadSpace upload_space;
+    upload_space.command_buffer = batch.command_buffer;
+    upload_space.buffer = chunk.buffer;
+    upload_space.offset = offset;
+    upload_space.mapped = (chunk.mapped + offset);
+    upload_space.done = batch.done;
+    return upload_space;
+}
+
+void KidsRender::upload_end(const ImageRef& image)
+{
+    KK_VERIFY(upload_batch_.command_buffer);
+    upload_batch_.image_list.push_back(image);
+}
+
+void KidsRender::flush_uploads()
+{
+    Vulkan_Uploads_Recycle(*this, false/*wait*/);
+    Vulkan_UploadBatch& batch = upload_batch_;
+    if (!batch.command_buffer)
+        return;
+    KK_VERIFY(vkEndCommandBuffer(batch.command_buffer) == VK_SUCCESS);
+    VkFenceCreateInfo fence_info{};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    KK_VERIFY(vkCreateFence(render_data_.device, &fence_info, nullptr, &batch.fence) == VK_SUCCESS);
+    // Frames are submitted to the same queue later: barriers recorded
+    // with the copies make images visible to their fragment shaders.
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &batch.command_buffer;
+    KK_VERIFY(vkQueueSubmit(render_data_.work_queue, 1, &submit_info, batch.fence) == VK_SUCCESS);
+    upload_in_flight_list_.push_back(std::move(batch));
+    batch = {};
+}
+
 KidsRender::~KidsRender() noexcept
 {
     if (!render_data_.device)
         return;
+    flush_uploads();
+    Vulkan_Uploads_Recycle(*this, true/*wait*/);
+    for (Vulkan_StagingChunk& chunk : staging_free_list_)
+        Vulkan_StagingChunk_Free(*this, chunk);
     for (Vulkan_Frame& frame : frame_list_)
     {
-        Vulkan_Kill_FrameData(frame, render_data_);
+        Vulkan_Kill_FrameData(frame);
+        Vulkan_Kill_FrameBuffer(frame, *this);
         for (auto& clean_up : frame.to_flush_)
             clean_up();
         frame.to_flush_.clear();
     }
     Vulkan_KillPipeline(render_data_.device, triangle_pipeline_);
+    Vulkan_KillPipeline(render_data_.device, quad_pipeline_);
+    Vulkan_KillPipeline(render_data_.device, sdf_pipeline_);
+    Vulkan_KillPipeline(render_data_.device, quad_batch_pipeline_);
     vkDestroyDescriptorSetLayout(render_data_.device, descriptor_set_layout_, nullptr);
-    vkDestroySampler(render_data_.device, texture_sampler_, nullptr);
-    KK_VERIFY(vkFreeDescriptorSets(render_data_.device
-        , render_data_.descriptor_pool
-        , 1
-        , &white_1x1_descriptor_set_) == VK_SUCCESS);
+    vkDestroyDescriptorSetLayout(render_data_.device, batch_descriptor_set_layout_, nullptr);
+    for (Vulkan_Frame& frame : frame_list_)
+        vkDestroyQueryPool(render_data_.device, frame.timestamp_pool, nullptr);
     white_1x1_ = {};
+    vkDestroySampler(render_data_.device, texture_sampler_, nullptr);
 }
 
 static VkSampler Vulkan_CreateTextureSampler(VkDevice device)
@@ -1593,7 +4157,8 @@ static VkSampler Vulkan_CreateTextureSampler(VkDevice device)
     return sampler;
 }
 
-static VkDescriptorSetLayout Vulkan_CreateDescriptorSetLayout(VkDevice device)
+static VkDescriptorSetLayout Vulkan_CreateDescriptorSetLayout(VkDevice device
+    , std::uint32_t image_count)
 {
     VkDescriptorSetLayoutBinding binding[2]{};
     binding[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
@@ -1604,7 +4169,7 @@ static VkDescriptorSetLayout Vulkan_CreateDescriptorSetLayout(VkDevice device)
 
     binding[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
     binding[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    binding[1].descriptorCount = 1;
+    binding[1].descriptorCount = image_count;
     binding[1].pImmutableSamplers = nullptr;
     binding[1].binding = 1;
 
@@ -1634,68 +4199,227 @@ static VkShaderModule Vulkan_CreateShader(VkDevice device, const void* data, siz
     return shader;
 }
 
+// Publishes timestamps of the previous use of this frame and resets the pool
+// on host: draw() is called inside the render pass. Returns false, skipping
+// the frame, when previous timestamps are not ready yet.
+static bool Vulkan_Timestamps_Begin(KidsRender& render, KidsRender::Vulkan_Frame& frame, VkCommandBuffer command_buffer)
+{
+    const VkDevice device = render.render_data_.device;
+    if (!frame.timestamp_pool)
+    {
+        VkQueryPoolCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        info.queryCount = 2;
+        KK_VERIFY(vkCreateQueryPool(device, &info, nullptr, &frame.timestamp_pool) == VK_SUCCESS);
+    }
+    else if (frame.timestamp_pending)
+    {
+        std::uint64_t timestamps[2]{};
+        const VkResult err = vkGetQueryPoolResults(device, frame.timestamp_pool
+            , 0, 2
+            , sizeof(timestamps), timestamps, sizeof(std::uint64_t)
+            , VK_QUERY_RESULT_64_BIT);
+        if (err == VK_NOT_READY)
+            return false;
+        KK_VERIFY(err == VK_SUCCESS);
+        render.frame_timings_gpu_ = frame.timings;
+        render.frame_timings_gpu_.gpu_ms = (double(timestamps[1] - timestamps[0])
+            * double(render.timestamp_period_) / 1e6);
+    }
+    frame.timestamp_pending = false;
+    vkResetQueryPool(device, frame.timestamp_pool, 0, 2);
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.timestamp_pool, 0);
+    return true;
+}
+
 /*static*/ void KidsRender::Build(const RenderData& render_data, KidsRender& render)
 {
     render.render_data_ = render_data;
+    render.memory_ = std::make_shared<VulkanMemory>(render_data.physical_device, render_data.device);
+    render.descriptor_pools_ = std::make_shared<Vulkan_DescriptorPools>();
+    render.descriptor_pools_->device = render_data.device;
+    render.descriptor_pools_->pool_list.push_back(render_data.descriptor_pool);
 
     render.texture_sampler_ = Vulkan_CreateTextureSampler(render_data.device);
-    render.descriptor_set_layout_ = Vulkan_CreateDescriptorSetLayout(render_data.device);
+    render.descriptor_set_layout_ = Vulkan_CreateDescriptorSetLayout(render_data.device, 1);
+    render.batch_descriptor_set_layout_ = Vulkan_CreateDescriptorSetLayout(render_data.device
+        , std::uint32_t(kMaxBatchTextures));
 
     VkShaderModule vertex_module = Vulkan_CreateShader(render_data.device
         , kShader_Vertex, sizeof(kShader_Vertex));
     VkShaderModule fragment_module = Vulkan_CreateShader(render_data.device
         , kShader_Fragment, sizeof(kShader_Fragment));
+    VkShaderModule quad_vertex_module = Vulkan_CreateShader(render_data.device
+        , kShader_QuadVertex, sizeof(kShader_QuadVertex));
+    VkShaderModule quad_batch_fragment_module = Vulkan_CreateShader(render_data.device
+        , kShader_QuadBatchFragment, sizeof(kShader_QuadBatchFragment));
+    VkShaderModule sdf_vertex_module = Vulkan_CreateShader(render_data.device
+        , kShader_SdfVertex, sizeof(kShader_SdfVertex));
+    VkShaderModule sdf_fragment_module = Vulkan_CreateShader(render_data.device
+        , kShader_SdfFragment, sizeof(kShader_SdfFragment));
 
     Vulkan_CreatePipeline(render.triangle_pipeline_
         , render_data.device
+        , render_data.pipeline_cache
         , render.descriptor_set_layout_
         , render_data.render_pass
         , render_data.msaa_samples
         , vertex_module
         , fragment_module
-        , VkPrimitiveTopology::VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+        , Primitive::Triangles);
+    Vulkan_CreatePipeline(render.quad_pipeline_
+        , render_data.device
+        , render_data.pipeline_cache
+        , render.descriptor_set_layout_
+        , render_data.render_pass
+        , render_data.msaa_samples
+        , quad_vertex_module
+        , fragment_module
+        , Primitive::Quads);
+    Vulkan_CreatePipeline(render.quad_batch_pipeline_
+        , render_data.device
+        , render_data.pipeline_cache
+        , render.batch_descriptor_set_layout_
+        , render_data.render_pass
+        , render_data.msaa_samples
+        , quad_vertex_module
+        , quad_batch_fragment_module
+        , Primitive::Quads);
+    Vulkan_CreatePipeline(render.sdf_pipeline_
+        , render_data.device
+        , render_data.pipeline_cache
+        , render.descriptor_set_layout_ // Not sampled; keeps bound set compatible.
+        , render_data.render_pass
+        , render_data.msaa_samples
+        , sdf_vertex_module
+        , sdf_fragment_module
+        , Primitive::SdfShapes);
 
     vkDestroyShaderModule(render_data.device, vertex_module, nullptr);
     vkDestroyShaderModule(render_data.device, fragment_module, nullptr);
+    vkDestroyShaderModule(render_data.device, quad_vertex_module, nullptr);
+    vkDestroyShaderModule(render_data.device, quad_batch_fragment_module, nullptr);
+    vkDestroyShaderModule(render_data.device, sdf_vertex_module, nullptr);
+    vkDestroyShaderModule(render_data.device, sdf_fragment_module, nullptr);
 
-    KK_VERIFY(render_data.image_count > 0);
-    render.frame_list_.resize(render_data.image_count);
+    KK_VERIFY(render_data.frames_in_flight > 0);
+    render.frame_list_.resize(render_data.frames_in_flight);
     render.frame_list_.shrink_to_fit();
 
+    if (render_data.gpu_timestamps)
+    {
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(render_data.physical_device, &properties);
+        render.timestamp_period_ = properties.limits.timestampPeriod;
+    }
+
     render.white_1x1_ = Texture_White_1x1(render);
-    render.white_1x1_descriptor_set_ = Vulkan_CreateDescriptorSet(
-        render_data
-        , render.descriptor_set_layout_
-        , render.white_1x1_.image_view()
-        , render.texture_sampler_);
 }
 
-void KidsRender::draw(const FrameInfo& frame_info)
+void KidsRender::draw_frame(const FrameInfo& frame_info)
 {
+    frame_stats_.descriptor_sets_allocated = std::exchange(descriptor_sets_allocated_, 0);
+    flush_uploads();
     if (cmd_list_.draw_list_.empty())
         return;
+    ProfileScope build_scope{this, ProfileStage::Build};
+    if (reorder_draw_cmds_)
+        frame_stats_.draw_cmds_saved = ReorderDrawCmds(cmd_list_);
+    const std::vector<DrawCmd>* draw_list = &cmd_list_.draw_list_;
+    if (texture_batching_)
+    {
+        frame_stats_.draw_cmds_saved += Quads_BatchTextures(cmd_list_, batch_draw_list_, texture_set_list_);
+        draw_list = &batch_draw_list_;
+    }
+    build_scope.stop();
 
     KK_VERIFY(frame_info.frame_index < frame_list_.size());
     Vulkan_Frame& current_frame = frame_list_[frame_info.frame_index];
+    const bool gpu_timestamps = (profiling_ && render_data_.gpu_timestamps)
+        && Vulkan_Timestamps_Begin(*this, current_frame, frame_info.command_buffer);
+
+    ProfileScope upload_scope{this, ProfileStage::Upload};
+    for (const DrawCmd& cmd : cmd_list_.draw_list_)
+    {
+        if (cmd.retained_ && cmd.retained_->dirty_)
+            frame_stats_.bytes_uploaded += Vulkan_Retained_Upload(*this, *cmd.retained_);
+    }
 
-    Vulkan_Recreate_FrameData(current_frame, render_data_
+    Vulkan_Recreate_FrameData(current_frame, *this
         , cmd_list_.vertex_list_, cmd_list_.index_list_);
+    frame_stats_.bytes_uploaded += (cmd_list_.vertex_list_.size() * sizeof(Vertex));
+    frame_stats_.bytes_uploaded += (cmd_list_.index_list_.size() * sizeof(Index));
     KK_VERIFY(current_frame.image_in_use_list_.empty());
-
-    for (const DrawCmd& cmd : cmd_list_.draw_list_)
+    upload_scope.stop();
+
+    ProfileScope submit_scope{this, ProfileStage::Submit};
+    // Command buffer state is unknown before draw(): first DrawCmd sets everything.
+    Vulkan_BoundState bound{};
+    auto record_cmd = [&](const DrawCmd& cmd
+        , VkBuffer buffer
+        , VkDeviceSize index_offset
+        , const kk::Point2f& translate
+        , VkDescriptorSet batch_descriptor_set)
     {
+        const Vulkan_Pipeline& pipeline = (cmd.primitive_ == Primitive::Triangles) ? triangle_pipeline_
+            : (cmd.primitive_ == Primitive::SdfShapes) ? sdf_pipeline_
+            : batch_descriptor_set ? quad_batch_pipeline_
+            : quad_pipeline_;
         Vulkan_Record_Frame(current_frame
-            , render_data_
-            , descriptor_set_layout_
-            , texture_sampler_
+            , bound
+            , frame_stats_
             , cmd
             , white_1x1_
-            , white_1x1_descriptor_set_
-            , triangle_pipeline_
+            , pipeline
             , frame_info.command_buffer
             , frame_info.screen_size
-            , cmd.scale_);
+            , cmd.scale_
+            , buffer
+            , index_offset
+            , translate
+            , batch_descriptor_set);
+    };
+
+    for (std::size_t i = 0; i < draw_list->size(); ++i)
+    {
+        const DrawCmd& cmd = (*draw_list)[i];
+        if (!cmd.retained_)
+        {
+            // Single texture draws as usual, with its own descriptor set.
+            VkDescriptorSet batch_descriptor_set{};
+            if (texture_batching_ && (texture_set_list_[i].count > 1))
+                batch_descriptor_set = Vulkan_Frame_BatchDescriptorSet(*this, current_frame, texture_set_list_[i]);
+            record_cmd(cmd, current_frame.buffer, current_frame.index_offset, kk::Point2f{}, batch_descriptor_set);
+            continue;
+        }
+        const RetainedCmdList& retained = *cmd.retained_;
+        if (!retained.buffer_)
+            continue; // Empty geometry.
+        for (const DrawCmd& retained_cmd : retained.cmd_list_.draw_list_)
+        {
+            record_cmd(DrawCmd_FromRetained(cmd, retained_cmd)
+                , retained.buffer_
+                , retained.index_offset_
+                , cmd.retained_translate_
+                , VkDescriptorSet{});
+        }
     }
+
+    if (gpu_timestamps)
+    {
+        vkCmdWriteTimestamp(frame_info.command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+            , current_frame.timestamp_pool, 1);
+        current_frame.timestamp_pending = true;
+        profile_pending_ = &current_frame.timings;
+    }
+}
+
+VkDescriptorSet KidsRender::create_descriptor_set(VkImageView image_view, VkDescriptorPool& pool)
+{
+    ++descriptor_sets_allocated_;
+    return Vulkan_CreateDescriptorSet(*descriptor_pools_, descriptor_set_layout_
+        , image_view, texture_sampler_, pool);
 }
 
 void KidsRender::defer_clean_up(std::function<void ()> f)
@@ -1708,4 +4432,80 @@ void KidsRender::defer_clean_up(std::function<void ()> f)
 }
 #endif
 
+#if (KK_RENDER_SOFTWARE())
+RetainedCmdList::RetainedCmdList(KidsRender& render)
+    : render_(&render)
+{
+}
+
+RetainedCmdList::~RetainedCmdList() noexcept = default;
+
+KidsRender::KidsRender() = default;
+
+KidsRender::~KidsRender() noexcept = default;
+
+/*static*/ void KidsRender::Build(const RenderData& render_data, KidsRender& render)
+{
+    render.render_data_ = render_data;
+    render.raster_state_ = std::make_unique<Raster_State>();
+    render.white_1x1_ = Texture_White_1x1(render);
+}
+
+void KidsRender::draw_frame(const FrameInfo& frame_info)
+{
+    if (cmd_list_.draw_list_.empty())
+        return;
+    ProfileScope build_scope{this, ProfileStage::Build};
+    if (reorder_draw_cmds_)
+        frame_stats_.draw_cmds_saved = ReorderDrawCmds(cmd_list_);
+    build_scope.stop();
+    KK_VERIFY(raster_state_);
+
+    // There is no GPU: rasterization is reported as Submit.
+    ProfileScope submit_scope{this, ProfileStage::Submit};
+    std::vector<Raster_Cmd>& raster_cmd_list = raster_state_->cmd_list;
+    raster_cmd_list.clear();
+    // Nothing is uploaded: triangles are read right from CmdList.
+    auto add_cmd = [&](const DrawCmd& cmd, const CmdList& cmd_list, const kk::Point2f& translate)
+    {
+        KK_VERIFY(cmd.primitive_ == Primitive::Triangles);
+        KK_VERIFY(cmd.texture_.is_valid());
+        if (cmd.index_count_ == 0)
+            return;
+        Raster_Cmd& raster_cmd = raster_cmd_list.emplace_back();
+        ++frame_stats_.draw_cmds;
+        frame_stats_.vertices += cmd.vertex_count_;
+        frame_stats_.indices += cmd.index_count_;
+        raster_cmd.vertices = (cmd_list.vertex_list_.data() + cmd.vertex_offset_);
+        raster_cmd.indices = (cmd_list.index_list_.data() + cmd.index_offset_);
+        raster_cmd.index_count = cmd.index_count_;
+        raster_cmd.scale = cmd.scale_;
+        raster_cmd.translate = translate;
+        raster_cmd.clip = ClipRect_Transform(cmd.clip_rect_, cmd.scale_, frame_info.screen_size);
+        raster_cmd.texture.pixels = cmd.texture_.pixels();
+        raster_cmd.texture.width = cmd.texture_.width();
+        raster_cmd.texture.height = cmd.texture_.height();
+    };
+
+    for (const DrawCmd& cmd : cmd_list_.draw_list_)
+    {
+        if (!cmd.retained_)
+        {
+            add_cmd(cmd, cmd_list_, kk::Point2f{});
+            continue;
+        }
+        RetainedCmdList& retained = *cmd.retained_;
+        retained.dirty_ = false;
+        for (const DrawCmd& retained_cmd : retained.cmd_list_.draw_list_)
+            add_cmd(DrawCmd_FromRetained(cmd, retained_cmd), retained.cmd_list_, cmd.retained_translate_);
+    }
+
+    Raster_Target target;
+    target.pixels = frame_info.pixels;
+    target.size = frame_info.screen_size;
+    target.stride = frame_info.stride ? frame_info.stride : std::size_t(frame_info.screen_size.width);
+    Raster_Draw(*raster_state_, target, render_data_.thread_pool);
+}
+#endif
+
 } // namespace kr
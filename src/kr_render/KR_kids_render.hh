@@ -1,41 +1,129 @@
 #pragma once
 #include "KR_kids_config.hh"
 #include "KR_kids_image.hh"
+#include "KR_vulkan_memory.hh"
+#include "KS_thread_pool.hh"
 
 #include <functional>
+#include <chrono>
+#include <atomic>
 #include <vector>
 #include <span>
 #include <cstdint>
+#include <cstddef>
 #include <climits>
+#include <cfloat>
 
 namespace kr
 {
 
+struct RetainedCmdList;
+#if (KK_RENDER_SOFTWARE())
+struct Raster_State;
+#endif
+
+// How DrawCmd's vertices (and indices) are interpreted.
+enum class Primitive : std::uint8_t
+{
+    Triangles,
+    // Analytic shapes, see KidsRender::shape_sdf(). Every shape vertex
+    // takes 2 Vertex slots; indices count shape vertices.
+    SdfShapes,
+    // Axis-aligned (textured) quads, drawn instanced; no indices.
+    // Every quad takes 2 Vertex slots: {p_min, uv_min, color}, {p_max, uv_max, texture unit in c_.r}.
+    Quads,
+};
+
+// Axis-aligned box, in the same (unscaled) units as Vertex::p_. Empty by default.
+struct DrawCmd_Bounds
+{
+    float x0 = FLT_MAX;
+    float y0 = FLT_MAX;
+    float x1 = -FLT_MAX;
+    float y1 = -FLT_MAX;
+};
+
 struct DrawCmd
 {
     ClipRect clip_rect_{};
     ImageRef texture_{};
+    // Base vertex: indices of this command are relative to it.
     unsigned vertex_offset_ = 0;
     unsigned vertex_count_ = 0;
     unsigned index_offset_ = 0;
     unsigned index_count_ = 0;
     kk::Vec2f scale_{1.f, 1.f};
+    // Not null: draw GPU-resident list (see KidsRender::draw_retained()),
+    // vertex/index ranges are unused.
+    RetainedCmdList* retained_ = nullptr;
+    kk::Point2f retained_translate_{};
+    bool retained_clip_ = false; // Use clip_rect_ for every retained DrawCmd.
+    // vertex_offset_/vertex_count_ always count Vertex slots.
+    Primitive primitive_ = Primitive::Triangles;
+    DrawCmd_Bounds bounds_{}; // Of all vertices; for clip culling.
 };
 
 struct Vertex
 {
     kk::Vec2f p_;
     kk::Vec2f uv_;
-    kk::Vec4f c_;
+    kk::Color c_; // RGBA8, normalized to [0; 1] by the GPU.
 };
+static_assert(sizeof(Vertex) == 20);
 
 using Index = std::uint16_t;
+// Max vertices single DrawCmd can address; CmdList itself is unbounded.
+inline constexpr std::size_t kMaxDrawCmdVertices = (std::size_t(1) << (sizeof(Index) * CHAR_BIT));
+
+// Geometry dropped on the CPU because it was entirely outside of its ClipRect.
+struct CullStats
+{
+    std::size_t primitives = 0; // Lines, shapes, glyphs, ... (AddVertices() calls).
+    std::size_t draw_cmds = 0;  // Whole DrawCmds, by merge_cmd_lists().
+    std::size_t vertices = 0;
+    std::size_t indices = 0;
+};
 
 struct CmdList
 {
     std::vector<DrawCmd> draw_list_;
     std::vector<Vertex> vertex_list_;
     std::vector<Index> index_list_;
+    // Accumulated over all the lists merged into this one.
+    CullStats culled_;
+};
+
+// CmdList that lives on GPU: uploaded once and drawn any number of times
+// with KidsRender::draw_retained(). Re-uploaded on next draw() only when
+// set() changes the geometry. Must outlive draw() it's used in.
+struct RetainedCmdList
+{
+public:
+    explicit RetainedCmdList(KidsRender& render);
+    ~RetainedCmdList() noexcept;
+    RetainedCmdList(RetainedCmdList&& rhs) noexcept = delete;
+    RetainedCmdList(const RetainedCmdList&) noexcept = delete;
+    RetainedCmdList& operator=(const RetainedCmdList&) noexcept = delete;
+    RetainedCmdList& operator=(RetainedCmdList&&) noexcept = delete;
+
+    void set(CmdList cmd_list);
+    const CmdList& cmd_list() const { return cmd_list_; }
+
+// private:
+    KidsRender* render_ = nullptr;
+    CmdList cmd_list_;
+    bool dirty_ = false;
+#if (KK_RENDER_OPENGL())
+    // Owns.
+    unsigned vertex_buffer_ = 0;
+    unsigned index_buffer_ = 0;
+#endif
+#if (KK_RENDER_VULKAN())
+    // Owns. Vertices, followed by indices; device-local.
+    VkBuffer buffer_{};
+    VulkanMemory_Allocation memory_{};
+    VkDeviceSize index_offset_ = 0;
+#endif
 };
 
 #if (KK_RENDER_OPENGL())
@@ -54,20 +142,125 @@ struct RenderData
     VkDevice device{};
     VkQueue work_queue{};
     VkCommandPool work_command_pool{};
+    // Of SAMPLED_IMAGE + SAMPLER sets, with FREE_DESCRIPTOR_SET_BIT. When it
+    // is full, KidsRender allocates from more pools of its own.
     VkDescriptorPool descriptor_pool{};
     VkRenderPass render_pass{};
-    std::uint32_t image_count{};
+    // Frames CPU records while GPU works on previous ones; one KidsRender::Vulkan_Frame
+    // each. FrameInfo::frame_index is in [0, frames_in_flight).
+    std::uint32_t frames_in_flight{};
     VkSampleCountFlagBits msaa_samples{};
     std::function<std::uint32_t ()> current_frame_;
+    // `work_queue` supports timestamps and `hostQueryReset` feature is enabled:
+    // needed for GPU timings, see KidsRender::set_profiling().
+    bool gpu_timestamps{};
+    // Optional. Not owned; may be shared by many KidsRender, see PipelineCache_Load().
+    VkPipelineCache pipeline_cache{};
 };
 struct FrameInfo
 {
     kk::Size screen_size{};
     VkCommandBuffer command_buffer{};
+    // In-flight slot, not swapchain image: see RenderData::frames_in_flight.
     std::uint32_t frame_index{};
 };
+
+// VkPipelineCache with the data of `file_path` (may be null), if the file was
+// saved for this very device: vendor, device and pipelineCacheUUID match.
+// Otherwise, the cache starts empty. `loaded` tells which one happened.
+VkPipelineCache PipelineCache_Load(VkPhysicalDevice physical_device
+    , VkDevice device
+    , const char* file_path
+    , bool* loaded = nullptr);
+// Returns false on I/O errors.
+bool PipelineCache_Save(VkDevice device, VkPipelineCache pipeline_cache, const char* file_path);
+#endif
+#if (KK_RENDER_SOFTWARE())
+struct RenderData
+{
+    // Optional: setup, binning and tiles are rasterized on the calling thread when null.
+    kk::ThreadPool* thread_pool = nullptr;
+};
+struct FrameInfo
+{
+    kk::Size screen_size{};
+    // RGBA8, top row first; draw() blends into it as is (clear it yourself).
+    kk::Color* pixels = nullptr;
+    std::size_t stride = 0; // In pixels; 0 is screen_size.width.
+};
 #endif
 
+// Filled by every KidsRender::draw() call. Counters are bumped
+// where the work is done already: collecting them costs nothing.
+struct FrameStats
+{
+    // Draw calls: DrawCmds sent to the backend, retained ones expanded.
+    std::size_t draw_cmds = 0;
+    // DrawCmds merged away by KidsRender::ReorderDrawCmds() and
+    // texture batching, if enabled.
+    std::size_t draw_cmds_saved = 0;
+    // Drawn by `draw_cmds`.
+    std::size_t vertices = 0;
+    std::size_t indices = 0;
+    // Vertices + indices copied to GPU-visible memory.
+    std::size_t bytes_uploaded = 0;
+    // glBindTexture()/vkCmdBindDescriptorSets() calls. 0 on Software.
+    std::size_t texture_binds = 0;
+    // glScissor()/vkCmdSetScissor() calls. 0 on Software.
+    std::size_t scissor_changes = 0;
+    // Vulkan only: other state recorded (pipeline, push constants, viewport,
+    // vertex/index buffers); unchanged state is not recorded again.
+    std::size_t state_changes = 0;
+    // Vulkan only: VkDescriptorSets allocated since previous draw(),
+    // one per new ImageRef and per batch of textures.
+    std::size_t descriptor_sets_allocated = 0;
+    // Since previous draw(), by Font_FromFile() fonts: atlas thrash.
+    std::size_t font_pages_created = 0;
+    // Of the frame's CmdList, see CmdList::culled_.
+    CullStats culled;
+};
+
+// Parts of a frame timed on the CPU, see KidsRender::set_profiling().
+enum class ProfileStage
+{
+    Shape,  // Text_Shaper::text_add(), finish().
+    Build,  // merge_cmd_lists*(), draw_retained(); reordering and batching in draw().
+    Upload, // Vertices/indices (stream and retained) to GPU-visible memory.
+    Submit, // GL calls/Vulkan commands of draw(). Software: rasterization.
+    Count_,
+};
+
+const char* ProfileStage_Name(ProfileStage stage);
+
+// Timings of a single draw() call, in milliseconds.
+struct FrameTimings
+{
+    // draw() calls, counting from 0.
+    std::uint64_t frame_number = 0;
+    // CPU, on the render thread, since previous draw().
+    double cpu_ms[std::size_t(ProfileStage::Count_)]{};
+    // Execution of draw()'s commands on the GPU; < 0 when unknown.
+    double gpu_ms = -1.0;
+
+    double cpu(ProfileStage stage) const { return cpu_ms[std::size_t(stage)]; }
+};
+
+// How polyline() connects its segments.
+enum class LineJoin
+{
+    Miter, // Falls back to Bevel when too long (sharp angles).
+    Bevel,
+    Round,
+};
+
+// How open polyline() ends.
+enum class LineCap
+{
+    Butt,
+    Square,
+    Round,
+};
+
 struct KidsRender
 {
 public:
@@ -163,6 +356,45 @@ public:
         , int segments_count = -1
         , const ClipRect& clip_rect = {}
         , CmdList* cmd_list = nullptr);
+    // Stroke through all `points` as single piece of geometry: adjacent
+    // segments share vertices, joins have no gaps or overdraw.
+    // `closed` connects last point to the first one (caps are unused then).
+    void polyline(std::span<const kk::Point2f> points
+        , const kk::Color& color = kk::Color_White()
+        , float width = 1.f
+        , bool closed = false
+        , LineJoin join = LineJoin::Miter
+        , LineCap cap = LineCap::Butt
+        , const kk::Vec2f& scale = kk::Vec2f{1.f, 1.f}
+        , const ClipRect& clip_rect = {}
+        , CmdList* cmd_list = nullptr);
+
+    // Analytic shapes: single quad each, edge is evaluated (and anti-aliased)
+    // in the fragment shader. Filled when `width` is 0, otherwise outline
+    // of `width` drawn inside the shape (ring for circles).
+    // Software: tessellated, there is no SDF rasterizer.
+    void circle_sdf(const kk::Point2f& p_center
+        , float radius
+        , const kk::Color& color = kk::Color_White()
+        , float width = 0.f
+        , const kk::Vec2f& scale = kk::Vec2f{1.f, 1.f}
+        , const ClipRect& clip_rect = {}
+        , CmdList* cmd_list = nullptr);
+    void ellipse_sdf(const kk::Point2f& p_center
+        , const kk::Vec2f& radius
+        , const kk::Color& color = kk::Color_White()
+        , float width = 0.f
+        , const kk::Vec2f& scale = kk::Vec2f{1.f, 1.f}
+        , const ClipRect& clip_rect = {}
+        , CmdList* cmd_list = nullptr);
+    void rect_rounded_sdf(const kk::Point2f& p_min
+        , const kk::Point2f& p_max
+        , float rounding
+        , const kk::Color& color = kk::Color_White()
+        , float width = 0.f
+        , const kk::Vec2f& scale = kk::Vec2f{1.f, 1.f}
+        , const ClipRect& clip_rect = {}
+        , CmdList* cmd_list = nullptr);
 
 public:
     void draw(const FrameInfo& frame);
@@ -174,18 +406,145 @@ public:
         , const ClipRect* override_clip_rect = nullptr
         , CmdList* append_to_cmd_list = nullptr);
 
+    // Multi-threaded recording. Primitives above only read KidsRender
+    // and write to `cmd_list` they are given, so every thread may fill
+    // its own CmdList concurrently:
+    // 
+    //     thread_pool.parallel_for(N, [&](std::size_t i)
+    //     {
+    //         render.rect_fill(p_min, p_max, color, scale, {}, &cmd_lists[i]);
+    //     });
+    //     render.merge_cmd_lists_parallel(cmd_list_ptrs, thread_pool);
+    // 
+    // Anything that creates textures (ImageRef, Font pages) must stay
+    // on the render thread.
+    // 
+    // Same as merge_cmd_lists() for every list in order. Draw commands are
+    // merged on the calling thread; vertices/indices are copied and rebased
+    // by `thread_pool`, one list per task.
+    void merge_cmd_lists_parallel(std::span<const CmdList* const> new_cmd_lists
+        , kk::ThreadPool& thread_pool
+        , const kk::Point2f* translate_by = nullptr
+        , const ClipRect* override_clip_rect = nullptr
+        , CmdList* append_to_cmd_list = nullptr);
+
+    // Draws `retained` as part of the frame, in order with the rest of commands.
+    // Same as merge_cmd_lists(), but nothing is copied.
+    void draw_retained(RetainedCmdList& retained
+        , const kk::Point2f* translate_by = nullptr
+        , const ClipRect* override_clip_rect = nullptr
+        , CmdList* append_to_cmd_list = nullptr);
+
+    // Regroups DrawCmds that share texture/clip/scale, moving them
+    // back only over commands they do not overlap with, so the picture
+    // stays the same. Returns number of DrawCmds saved.
+    static std::size_t ReorderDrawCmds(CmdList& cmd_list);
+    // Run ReorderDrawCmds() on every draw(). Off by default.
+    void set_reorder_draw_cmds(bool enable) { reorder_draw_cmds_ = enable; }
+    // Quads (images, glyphs) that differ only by texture are drawn with
+    // a single call, up to kMaxBatchTextures textures each. Off by default.
+    // Vulkan allocates a descriptor set (FrameStats::descriptor_sets_allocated)
+    // the first time a combination of textures is drawn and keeps it until
+    // one of them is destroyed. Software ignores it.
+    void set_texture_batching(bool enable) { texture_batching_ = enable; }
+    static constexpr std::size_t kMaxBatchTextures = 8;
+
+    // Max distance, in pixels (after scale), between a curve and segments
+    // it's drawn with when `segments_count` is auto-detected (<= 0).
+    void set_tessellation_tolerance(float tolerance_px);
+    float tessellation_tolerance() const { return tessellation_tolerance_; }
+
+    const FrameStats& frame_stats() const { return frame_stats_; }
+#if (KK_RENDER_VULKAN())
+    // Device memory of buffers and images, see VulkanMemory.
+    VulkanMemory_Stats memory_stats() const { return memory_->stats(); }
+#endif
+
+    // CPU timers (see ProfileStage, ProfileScope) and GPU timer queries
+    // around draw(). Off by default. GPU results are read back a few
+    // frames later, when ready: nothing waits for the GPU.
+    void set_profiling(bool enable) { profiling_ = enable; }
+    bool is_profiling() const { return profiling_; }
+    // Last draw(): CPU stages only.
+    const FrameTimings& frame_timings() const { return frame_timings_; }
+    // Latest frame the GPU is done with: CPU stages and GPU time.
+    // Software has no GPU time: rasterization is ProfileStage::Submit.
+    const FrameTimings& frame_timings_gpu() const { return frame_timings_gpu_; }
+
 // private:
     RenderData render_data_;
     CmdList cmd_list_;
     ImageRef white_1x1_;
+    FrameStats frame_stats_;
+    bool reorder_draw_cmds_ = false;
+    bool texture_batching_ = false;
+    float tessellation_tolerance_ = 0.25f;
+    bool profiling_ = false;
+    std::uint64_t frame_number_ = 0;
+    // Atomic: ProfileScope may stop on worker threads, see merge_cmd_lists_parallel().
+    std::atomic<double> profile_cpu_ms_[std::size_t(ProfileStage::Count_)]{};
+    FrameTimings frame_timings_;
+    FrameTimings frame_timings_gpu_;
+    // Set by draw_frame(): GPU query that waits for this frame's timings.
+    FrameTimings* profile_pending_ = nullptr;
+    // Goes to FrameStats::font_pages_created on draw().
+    std::size_t font_pages_created_ = 0;
 
+#if (KK_RENDER_OPENGL() || KK_RENDER_VULKAN())
+    // Textures of the DrawCmd: texture units [0; count) on OpenGL,
+    // descriptor array elements on Vulkan.
+    struct TextureSet
+    {
+        ImageRef textures[kMaxBatchTextures]{};
+        std::size_t count = 0;
+    };
+    // cmd_list_.draw_list_ with texture batching applied (see set_texture_batching())
+    // and textures of every DrawCmd; count is 0 when not batched.
+    std::vector<DrawCmd> batch_draw_list_;
+    std::vector<TextureSet> texture_set_list_;
+#endif
 #if (KK_RENDER_OPENGL())
-    unsigned int shader_program_ = 0;
-    int screen_width_ptr_ = -1;
-    int screen_height_ptr_ = -1;
-    int scale_x_ptr_ = -1;
-    int scale_y_ptr_ = -1;
-    int texture_ptr_ = -1;
+    // One of N buffers, used in round-robin fashion, so the frame
+    // we write to is (most likely) not the one GPU still reads from.
+    struct OpenGL_StreamBuffer
+    {
+        unsigned vertex_buffer = 0;
+        unsigned index_buffer = 0;
+        std::size_t vertex_capacity = 0; // In bytes.
+        std::size_t index_capacity = 0;  // In bytes.
+        GLsync fence{};
+    };
+    static constexpr std::size_t kStreamBuffersCount = 3;
+    struct OpenGL_Program
+    {
+        unsigned int program = 0;
+        int screen_width_ptr = -1;
+        int screen_height_ptr = -1;
+        int scale_x_ptr = -1;
+        int scale_y_ptr = -1;
+        int translate_ptr = -1;
+        int texture_ptr = -1; // -1 if program does not sample.
+        int texture_count = 0;
+    };
+    // Owns.
+    OpenGL_Program triangle_program_{};
+    OpenGL_Program sdf_program_{};
+    OpenGL_Program quad_program_{};
+    unsigned vertex_array_ = 0;
+    unsigned sdf_vertex_array_ = 0;  // Same buffers, 2 Vertex per shape vertex.
+    unsigned quad_vertex_array_ = 0; // Same buffers, 2 Vertex per instance.
+    OpenGL_StreamBuffer stream_list_[kStreamBuffersCount]{};
+    std::size_t stream_index_ = 0;
+    // GL_TIME_ELAPSED around draw(); polled on the next draw() calls.
+    struct OpenGL_TimerQuery
+    {
+        unsigned query = 0;
+        bool pending = false;
+        FrameTimings timings;
+    };
+    static constexpr std::size_t kTimerQueriesCount = 4;
+    OpenGL_TimerQuery timer_query_list_[kTimerQueriesCount]{};
+    std::size_t timer_query_index_ = 0;
 #endif
 #if (KK_RENDER_VULKAN())
     struct Vulkan_Pipeline
@@ -195,33 +554,139 @@ public:
     };
     struct Vulkan_Frame
     {
-        VkBuffer vertex_buffer{};
-        VkDeviceMemory vertex_memory{};
-        VkBuffer index_buffer{};
-        VkDeviceMemory index_memory{};
-        std::vector<VkDescriptorSet> descriptor_set_list_{};
+        // Vertices, followed by indices. Persistently mapped;
+        // recreated only when frame data does not fit anymore.
+        VkBuffer buffer{};
+        VulkanMemory_Allocation memory{};
+        void* mapped = nullptr;
+        VkDeviceSize capacity = 0; // In bytes.
+        VkDeviceSize index_offset = 0;
+        // Keeps images (and their descriptor sets) alive while GPU reads them.
         std::vector<ImageRef> image_in_use_list_;
 
         std::vector<std::function<void ()>> to_flush_;
         std::vector<std::function<void ()>> clean_up_list_;
+
+        // Start/end timestamps of draw(); read back when the slot is reused.
+        VkQueryPool timestamp_pool{};
+        bool timestamp_pending = false;
+        FrameTimings timings;
+    };
+    // Owns. Shared with ImageRefs: they may outlive the render.
+    std::shared_ptr<VulkanMemory> memory_;
+    // Descriptor set of batched textures (see set_texture_batching()),
+    // by image views in TextureSet order; white_1x1_ fills the rest.
+    struct Vulkan_BatchSet
+    {
+        VkImageView image_views[kMaxBatchTextures]{};
+        VkDescriptorSet descriptor_set{};
+        VkDescriptorPool pool{};
     };
+    // RenderData::descriptor_pool (not owned), followed by pools created
+    // when all are full. Shared with ImageRefs: sets go back to their pool.
+    struct Vulkan_DescriptorPools
+    {
+        VkDevice device{};
+        std::vector<VkDescriptorPool> pool_list;
+        std::size_t current = 0; // Last one allocated from.
+        // Reused by every draw(); freed with any of their images.
+        std::vector<Vulkan_BatchSet> batch_set_list;
+        void free_batch_sets(VkImageView image_view);
+        ~Vulkan_DescriptorPools() noexcept;
+    };
+    std::shared_ptr<Vulkan_DescriptorPools> descriptor_pools_;
     // Owns.
     Vulkan_Pipeline triangle_pipeline_{};
-    std::vector<Vulkan_Frame> frame_list_{};
+    Vulkan_Pipeline quad_pipeline_{};
+    Vulkan_Pipeline quad_batch_pipeline_{};
+    Vulkan_Pipeline sdf_pipeline_{};
+    std::vector<Vulkan_Frame> frame_list_{}; // By FrameInfo::frame_index.
     VkSampler texture_sampler_{};
     VkDescriptorSetLayout descriptor_set_layout_{};
-    VkDescriptorSet white_1x1_descriptor_set_;
+    VkDescriptorSetLayout batch_descriptor_set_layout_{}; // kMaxBatchTextures images.
+    float timestamp_period_ = 0; // Nanoseconds per timestamp tick.
+    // Goes to FrameStats::descriptor_sets_allocated on draw().
+    std::size_t descriptor_sets_allocated_ = 0;
+
+    // Texture uploads. Copies of all new ImageRefs are recorded to one
+    // command buffer, from staging chunks that are reused, and submitted
+    // once per draw(): see flush_uploads(), ImageRef::is_ready().
+    struct Vulkan_StagingChunk
+    {
+        VkBuffer buffer{};
+        VulkanMemory_Allocation memory{};
+        std::uint8_t* mapped = nullptr; // Persistently.
+        VkDeviceSize capacity = 0;
+        VkDeviceSize used = 0;
+    };
+    struct Vulkan_UploadBatch
+    {
+        VkCommandBuffer command_buffer{}; // Null if nothing is recorded.
+        VkFence fence{};
+        std::vector<Vulkan_StagingChunk> chunk_list;
+        std::vector<ImageRef> image_list; // Alive till GPU is done.
+        std::shared_ptr<bool> done;
+    };
+    // Where ImageRef::FromMemory() puts pixels and records the copy.
+    struct Vulkan_UploadSpace
+    {
+        VkCommandBuffer command_buffer{};
+        VkBuffer buffer{};
+        VkDeviceSize offset = 0;
+        void* mapped = nullptr; // At `offset`.
+        std::shared_ptr<const bool> done;
+    };
+    Vulkan_UploadBatch upload_batch_{};
+    std::vector<Vulkan_UploadBatch> upload_in_flight_list_;
+    std::vector<Vulkan_StagingChunk> staging_free_list_;
 
     void defer_clean_up(std::function<void ()> f);
+    // For ImageRef::descriptor_set(). Caller frees to `pool`,
+    // one of descriptor_pools_.
+    VkDescriptorSet create_descriptor_set(VkImageView image_view, VkDescriptorPool& pool);
+    // For ImageRef::FromMemory(): `size` bytes of staging memory.
+    // upload_end() keeps `image` alive till the copy is done.
+    Vulkan_UploadSpace upload_begin(VkDeviceSize size);
+    void upload_end(const ImageRef& image);
+    // Submits recorded uploads, if any; called by draw(). Does not wait:
+    // finished batches are recycled on the next calls.
+    void flush_uploads();
+#endif
+#if (KK_RENDER_SOFTWARE())
+    // Owns. Scratch memory of draw(), see KR_software_raster.hh.
+    std::unique_ptr<Raster_State> raster_state_;
 #endif
 
 private:
+    // Backend part of draw().
+    void draw_frame(const FrameInfo& frame);
+    void profile_frame_end();
+
     static void AddVertices(CmdList& cmd_list
         , const ImageRef& texture
         , const std::span<const Vertex>& new_vertices
         , const std::span<const Index>& new_indices
         , const ClipRect& clip_rect
-        , const kk::Vec2f& scale);
+        , const kk::Vec2f& scale
+        , Primitive primitive = Primitive::Triangles);
+    // Instanced on OpenGL and Vulkan, 4 vertices on Software.
+    void quad(const ImageRef& texture
+        , const kk::Point2f& p_min
+        , const kk::Point2f& p_max
+        , const kk::Vec2f& uv_min
+        , const kk::Vec2f& uv_max
+        , const kk::Color& color
+        , const kk::Vec2f& scale
+        , const ClipRect& clip_rect
+        , CmdList* cmd_list);
+    void shape_sdf(const kk::Point2f& p_center
+        , const kk::Vec2f& half_size
+        , float rounding // < 0 for ellipse.
+        , const kk::Color& color
+        , float width
+        , const kk::Vec2f& scale
+        , const ClipRect& clip_rect
+        , CmdList* cmd_list);
     void circle_impl(const kk::Point2f& p_center
         , float radius
         , bool do_fill
@@ -233,4 +698,22 @@ private:
         , float width);
 };
 
+// Adds time spent in the scope to `stage` of the next FrameTimings.
+// Does nothing when `render` is null or is not profiling.
+// Thread-safe: scopes of worker threads (merge_cmd_lists() into own CmdList,
+// Text_Shaper) add up to the same frame; set_profiling() is render-thread only.
+struct ProfileScope
+{
+    explicit ProfileScope(KidsRender* render, ProfileStage stage);
+    ~ProfileScope() noexcept;
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+    // Ends the scope early.
+    void stop();
+
+    KidsRender* render_ = nullptr;
+    ProfileStage stage_{};
+    std::chrono::steady_clock::time_point start_{};
+};
+
 } // namespace kr
@@ -0,0 +1,516 @@
+#include "KR_software_raster.hh"
+
+#if (KK_RENDER_SOFTWARE())
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#  define KK_RASTER_SSE2() 1
+#  include <emmintrin.h>
+#else
+#  define KK_RASTER_SSE2() 0
+#endif
+
+namespace kr
+{
+
+static_assert(sizeof(kk::Color) == sizeof(std::uint32_t));
+
+// Triangles set up by single task.
+static constexpr std::size_t kRaster_SetupChunk = 4096;
+
+static float Color_Normalize(std::uint8_t c)
+{
+    return (c / 255.f);
+}
+
+static int Texture_Wrap(int i, int size)
+{
+    i %= size;
+    return (i < 0) ? (i + size) : i;
+}
+
+// Texels to filter between along one axis, GL_REPEAT + GL_LINEAR.
+static void Texture_Coord(float t, int size, int& i0, int& i1, float& weight)
+{
+    float f = (t * size - 0.5f);
+    if (!(std::abs(f) < 1e7f))
+        f = 0.f; // Way out of range (or NaN): any texel is as good.
+    const float f_floor = std::floor(f);
+    weight = (f - f_floor);
+    i0 = Texture_Wrap(int(f_floor), size);
+    i1 = ((i0 + 1) == size) ? 0 : (i0 + 1);
+}
+
+#if (KK_RASTER_SSE2())
+static __m128 Texel_Load(const kk::Color& texel)
+{
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &texel, sizeof(bits));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bytes = _mm_cvtsi32_si128(int(bits));
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+}
+#endif
+
+// Bilinear; `rgba` is normalized.
+static void Texture_Sample(const Raster_Texture& texture, float u, float v, float rgba[4])
+{
+    int x0 = 0;
+    int x1 = 0;
+    int y0 = 0;
+    int y1 = 0;
+    float wx = 0.f;
+    float wy = 0.f;
+    Texture_Coord(u, texture.width, x0, x1, wx);
+    Texture_Coord(v, texture.height, y0, y1, wy);
+    const kk::Color* row0 = (texture.pixels + std::size_t(y0) * texture.width);
+    const kk::Color* row1 = (texture.pixels + std::size_t(y1) * texture.width);
+#if (KK_RASTER_SSE2())
+    const __m128 c00 = Texel_Load(row0[x0]);
+    const __m128 c10 = Texel_Load(row0[x1]);
+    const __m128 c01 = Texel_Load(row1[x0]);
+    const __m128 c11 = Texel_Load(row1[x1]);
+    const __m128 top = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c10, c00), _mm_set1_ps(wx)));
+    const __m128 bottom = _mm_add_ps(c01, _mm_mul_ps(_mm_sub_ps(c11, c01), _mm_set1_ps(wx)));
+    const __m128 c = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), _mm_set1_ps(wy)));
+    _mm_storeu_ps(rgba, _mm_mul_ps(c, _mm_set1_ps(1.f / 255.f)));
+#else
+    const std::uint8_t* c00 = &row0[x0].r;
+    const std::uint8_t* c10 = &row0[x1].r;
+    const std::uint8_t* c01 = &row1[x0].r;
+    const std::uint8_t* c11 = &row1[x1].r;
+    for (int i = 0; i < 4; ++i)
+    {
+        const float top = (c00[i] + (c10[i] - c00[i]) * wx);
+        const float bottom = (c01[i] + (c11[i] - c01[i]) * wx);
+        rgba[i] = ((top + (bottom - top) * wy) / 255.f);
+    }
+#endif
+}
+
+static void Raster_SetupTriangle(Raster_Triangle& t
+    , const Raster_Cmd& cmd
+    , std::uint32_t cmd_index
+    , std::size_t triangle
+    , const Raster_Target& target)
+{
+    t.cmd_index = cmd_index;
+    t.x0 = t.x1 = 0; // Empty.
+    t.y0 = t.y1 = 0;
+
+    const Vertex* v[3] =
+    {
+        &cmd.vertices[cmd.indices[3 * triangle + 0]],
+        &cmd.vertices[cmd.indices[3 * triangle + 1]],
+        &cmd.vertices[cmd.indices[3 * triangle + 2]],
+    };
+    kk::Vec2f p[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        p[i].x = ((v[i]->p_.x + cmd.translate.x) * cmd.scale.x);
+        p[i].y = ((v[i]->p_.y + cmd.translate.y) * cmd.scale.y);
+    }
+    // Either winding is drawn: make it the one edge functions expect.
+    float area = ((p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x));
+    if (area < 0)
+    {
+        std::swap(v[1], v[2]);
+        std::swap(p[1], p[2]);
+        area = -area;
+    }
+    if (!(area > 0))
+        return; // Degenerate (or NaN).
+
+    // Pixels with centers inside triangle's box.
+    const float clip_x0 = float((std::max)(cmd.clip.x, 0));
+    const float clip_y0 = float((std::max)(cmd.clip.y, 0));
+    const float clip_x1 = float((std::min)(cmd.clip.x + cmd.clip.width, target.size.width));
+    const float clip_y1 = float((std::min)(cmd.clip.y + cmd.clip.height, target.size.height));
+    if ((clip_x0 >= clip_x1) || (clip_y0 >= clip_y1))
+        return;
+    const float min_x = (std::min)({p[0].x, p[1].x, p[2].x});
+    const float min_y = (std::min)({p[0].y, p[1].y, p[2].y});
+    const float max_x = (std::max)({p[0].x, p[1].x, p[2].x});
+    const float max_y = (std::max)({p[0].y, p[1].y, p[2].y});
+    t.x0 = int(std::clamp(std::ceil(min_x - 0.5f), clip_x0, clip_x1));
+    t.y0 = int(std::clamp(std::ceil(min_y - 0.5f), clip_y0, clip_y1));
+    t.x1 = int(std::clamp(std::floor(max_x - 0.5f) + 1.f, clip_x0, clip_x1));
+    t.y1 = int(std::clamp(std::floor(max_y - 0.5f) + 1.f, clip_y0, clip_y1));
+    if ((t.x0 >= t.x1) || (t.y0 >= t.y1))
+        return;
+
+    // Edge k is opposite to vertex k: E_k(p[k]) == area.
+    for (int k = 0; k < 3; ++k)
+    {
+        const kk::Vec2f& from = p[(k + 1) % 3];
+        const kk::Vec2f& to = p[(k + 2) % 3];
+        t.edge_a[k] = (from.y - to.y);
+        t.edge_b[k] = (to.x - from.x);
+        t.edge_x[k] = from.x;
+        t.edge_y[k] = from.y;
+        t.edge_inclusive[k] = (t.edge_a[k] > 0) || ((t.edge_a[k] == 0) && (t.edge_b[k] > 0));
+    }
+
+    const Raster_Texture& texture = cmd.texture;
+    t.textured = ((texture.width > 1) || (texture.height > 1));
+    float texel[4] = {1.f, 1.f, 1.f, 1.f};
+    if (!t.textured)
+    {
+        texel[0] = Color_Normalize(texture.pixels[0].r);
+        texel[1] = Color_Normalize(texture.pixels[0].g);
+        texel[2] = Color_Normalize(texture.pixels[0].b);
+        texel[3] = Color_Normalize(texture.pixels[0].a);
+    }
+    float attr[3][6];
+    for (int i = 0; i < 3; ++i)
+    {
+        attr[i][0] = v[i]->uv_.x;
+        attr[i][1] = v[i]->uv_.y;
+        attr[i][2] = Color_Normalize(v[i]->c_.r) * texel[0];
+        attr[i][3] = Color_Normalize(v[i]->c_.g) * texel[1];
+        attr[i][4] = Color_Normalize(v[i]->c_.b) * texel[2];
+        attr[i][5] = Color_Normalize(v[i]->c_.a) * texel[3];
+    }
+    const kk::Color& c0 = v[0]->c_;
+    const kk::Color& c1 = v[1]->c_;
+    const kk::Color& c2 = v[2]->c_;
+    t.flat = !t.textured
+        && (std::memcmp(&c0, &c1, sizeof(kk::Color)) == 0)
+        && (std::memcmp(&c0, &c2, sizeof(kk::Color)) == 0);
+
+    // Barycentric weight of vertex k is E_k / area; E_1 and E_2 are 0 at p[0].
+    t.origin_x = p[0].x;
+    t.origin_y = p[0].y;
+    for (int i = 0; i < 6; ++i)
+    {
+        t.attr_0[i] = attr[0][i];
+        t.attr_x[i] = 0.f;
+        t.attr_y[i] = 0.f;
+        for (int k = 0; k < 3; ++k)
+        {
+            t.attr_x[i] += (attr[k][i] * t.edge_a[k] / area);
+            t.attr_y[i] += (attr[k][i] * t.edge_b[k] / area);
+        }
+    }
+}
+
+// Conservative: true only if none of rect's pixel centers can be covered.
+static bool Raster_TriangleMissesRect(const Raster_Triangle& t, int x0, int y0, int x1, int y1)
+{
+    for (int k = 0; k < 3; ++k)
+    {
+        // Corner where the edge function is max.
+        const float x = (t.edge_a[k] > 0) ? (x1 - 0.5f) : (x0 + 0.5f);
+        const float y = (t.edge_b[k] > 0) ? (y1 - 0.5f) : (y0 + 0.5f);
+        if ((t.edge_a[k] * (x - t.edge_x[k]) + t.edge_b[k] * (y - t.edge_y[k])) < 0)
+            return true;
+    }
+    return false;
+}
+
+#if (KK_RASTER_SSE2())
+// 4 RGBA8 pixels to [0; 255] channels.
+static void Pixels_Unpack(__m128i bits, __m128 channels[4])
+{
+    const __m128i mask = _mm_set1_epi32(0xff);
+    channels[0] = _mm_cvtepi32_ps(_mm_and_si128(bits, mask));
+    channels[1] = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(bits, 8), mask));
+    channels[2] = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(bits, 16), mask));
+    channels[3] = _mm_cvtepi32_ps(_mm_srli_epi32(bits, 24));
+}
+
+static __m128i Pixels_Pack(const __m128 channels[4])
+{
+    const __m128i r = _mm_cvtps_epi32(channels[0]);
+    const __m128i g = _mm_slli_epi32(_mm_cvtps_epi32(channels[1]), 8);
+    const __m128i b = _mm_slli_epi32(_mm_cvtps_epi32(channels[2]), 16);
+    const __m128i a = _mm_slli_epi32(_mm_cvtps_epi32(channels[3]), 24);
+    return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+
+// Shades and blends `count` (<= 4) pixels starting at `dst`; `px` are
+// their centers. Only `covered` lanes are changed.
+static void Raster_Shade4(const Raster_Triangle& t
+    , const Raster_Texture& texture
+    , kk::Color* dst
+    , int count
+    , __m128 px
+    , float py
+    , __m128 covered)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    __m128 src[4];
+    if (t.flat)
+    {
+        for (int i = 0; i < 4; ++i)
+            src[i] = _mm_set1_ps(t.attr_0[2 + i]);
+    }
+    else
+    {
+        const __m128 dx = _mm_sub_ps(px, _mm_set1_ps(t.origin_x));
+        const float dy = (py - t.origin_y);
+        auto attr = [&](int i)
+        {
+            return _mm_add_ps(_mm_set1_ps(t.attr_0[i] + t.attr_y[i] * dy)
+                , _mm_mul_ps(_mm_set1_ps(t.attr_x[i]), dx));
+        };
+        for (int i = 0; i < 4; ++i)
+            src[i] = _mm_min_ps(_mm_max_ps(attr(2 + i), zero), one);
+        if (t.textured)
+        {
+            alignas(16) float u[4];
+            alignas(16) float v[4];
+            alignas(16) float texel[4][4]{}; // [channel][lane].
+            _mm_store_ps(u, attr(0));
+            _mm_store_ps(v, attr(1));
+            const int mask = _mm_movemask_ps(covered);
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (!(mask & (1 << lane)))
+                    continue;
+                float rgba[4];
+                Texture_Sample(texture, u[lane], v[lane], rgba);
+                for (int i = 0; i < 4; ++i)
+                    texel[i][lane] = rgba[i];
+            }
+            for (int i = 0; i < 4; ++i)
+                src[i] = _mm_mul_ps(src[i], _mm_load_ps(texel[i]));
+        }
+    }
+
+    alignas(16) kk::Color pixels[4]{};
+    std::memcpy(pixels, dst, count * sizeof(kk::Color));
+    const __m128i old_bits = _mm_load_si128(reinterpret_cast<const __m128i*>(pixels));
+    __m128 blended[4];
+    Pixels_Unpack(old_bits, blended);
+    const __m128 src_a = src[3];
+    const __m128 dst_k = _mm_sub_ps(one, src_a);
+    const __m128 src_k = _mm_mul_ps(src_a, _mm_set1_ps(255.f));
+    for (int i = 0; i < 3; ++i)
+        blended[i] = _mm_add_ps(_mm_mul_ps(src[i], src_k), _mm_mul_ps(blended[i], dst_k));
+    blended[3] = _mm_add_ps(src_k, _mm_mul_ps(blended[3], dst_k));
+
+    const __m128i mask = _mm_castps_si128(covered);
+    const __m128i new_bits = _mm_or_si128(_mm_and_si128(mask, Pixels_Pack(blended))
+        , _mm_andnot_si128(mask, old_bits));
+    _mm_store_si128(reinterpret_cast<__m128i*>(pixels), new_bits);
+    std::memcpy(dst, pixels, count * sizeof(kk::Color));
+}
+
+// Pixels [x0; x1) x [y0; y1) of `t`, 4 at a time.
+static void Raster_TriangleRect(const Raster_Triangle& t
+    , const Raster_Texture& texture
+    , const Raster_Target& target
+    , int x0, int y0, int x1, int y1)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 lane_centers = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 x_end = _mm_set1_ps(float(x1));
+    __m128 edge_a[3];
+    __m128 edge_x[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        edge_a[k] = _mm_set1_ps(t.edge_a[k]);
+        edge_x[k] = _mm_set1_ps(t.edge_x[k]);
+    }
+
+    for (int y = y0; y < y1; ++y)
+    {
+        const float py = (float(y) + 0.5f);
+        __m128 edge_row[3];
+        for (int k = 0; k < 3; ++k)
+            edge_row[k] = _mm_set1_ps(t.edge_b[k] * (py - t.edge_y[k]));
+        kk::Color* row = (target.pixels + std::size_t(y) * target.stride);
+
+        for (int x = x0; x < x1; x += 4)
+        {
+            const __m128 px = _mm_add_ps(_mm_set1_ps(float(x)), lane_centers);
+            __m128 covered = _mm_cmplt_ps(px, x_end);
+            for (int k = 0; k < 3; ++k)
+            {
+                const __m128 e = _mm_add_ps(_mm_mul_ps(edge_a[k], _mm_sub_ps(px, edge_x[k])), edge_row[k]);
+                covered = _mm_and_ps(covered
+                    , t.edge_inclusive[k] ? _mm_cmpge_ps(e, zero) : _mm_cmpgt_ps(e, zero));
+            }
+            if (_mm_movemask_ps(covered) == 0)
+                continue;
+            Raster_Shade4(t, texture, row + x, (std::min)(4, x1 - x), px, py, covered);
+        }
+    }
+}
+#else
+static std::uint8_t Color_Denormalize(float c)
+{
+    return std::uint8_t(std::lround((std::min)((std::max)(c, 0.f), 255.f)));
+}
+
+static void Raster_ShadePixel(const Raster_Triangle& t
+    , const Raster_Texture& texture
+    , kk::Color& dst
+    , float px
+    , float py)
+{
+    float src[4];
+    const float dx = (px - t.origin_x);
+    const float dy = (py - t.origin_y);
+    auto attr = [&](int i)
+    {
+        return t.flat ? t.attr_0[i] : (t.attr_0[i] + t.attr_y[i] * dy + t.attr_x[i] * dx);
+    };
+    for (int i = 0; i < 4; ++i)
+        src[i] = (std::min)((std::max)(attr(2 + i), 0.f), 1.f);
+    if (t.textured)
+    {
+        float texel[4];
+        Texture_Sample(texture, attr(0), attr(1), texel);
+        for (int i = 0; i < 4; ++i)
+            src[i] *= texel[i];
+    }
+
+    const float dst_k = (1.f - src[3]);
+    const float src_k = (src[3] * 255.f);
+    dst.r = Color_Denormalize(src[0] * src_k + dst.r * dst_k);
+    dst.g = Color_Denormalize(src[1] * src_k + dst.g * dst_k);
+    dst.b = Color_Denormalize(src[2] * src_k + dst.b * dst_k);
+    dst.a = Color_Denormalize(src_k + dst.a * dst_k);
+}
+
+static void Raster_TriangleRect(const Raster_Triangle& t
+    , const Raster_Texture& texture
+    , const Raster_Target& target
+    , int x0, int y0, int x1, int y1)
+{
+    for (int y = y0; y < y1; ++y)
+    {
+        const float py = (float(y) + 0.5f);
+        kk::Color* row = (target.pixels + std::size_t(y) * target.stride);
+        for (int x = x0; x < x1; ++x)
+        {
+            const float px = (float(x) + 0.5f);
+            bool covered = true;
+            for (int k = 0; k < 3; ++k)
+            {
+                const float e = (t.edge_a[k] * (px - t.edge_x[k]) + t.edge_b[k] * (py - t.edge_y[k]));
+                covered = covered && (t.edge_inclusive[k] ? (e >= 0) : (e > 0));
+            }
+            if (covered)
+                Raster_ShadePixel(t, texture, row[x], px, py);
+        }
+    }
+}
+#endif
+
+void Raster_Draw(Raster_State& state
+    , const Raster_Target& target
+    , kk::ThreadPool* thread_pool)
+{
+    KK_VERIFY(target.pixels);
+    KK_VERIFY(target.stride >= std::size_t(target.size.width));
+    if ((target.size.width <= 0) || (target.size.height <= 0))
+        return;
+
+    auto parallel_for = [thread_pool](std::size_t count, const std::function<void (std::size_t)>& task)
+    {
+        if (thread_pool)
+        {
+            thread_pool->parallel_for(count, task);
+            return;
+        }
+        for (std::size_t i = 0; i < count; ++i)
+            task(i);
+    };
+
+    // Setup: transform, clip and compute edges/gradients of every triangle.
+    std::vector<std::size_t>& offsets = state.cmd_triangle_offsets;
+    offsets.resize(state.cmd_list.size() + 1);
+    offsets[0] = 0;
+    for (std::size_t i = 0; i < state.cmd_list.size(); ++i)
+        offsets[i + 1] = (offsets[i] + state.cmd_list[i].index_count / 3);
+    const std::size_t triangles_count = offsets.back();
+    KK_VERIFY(triangles_count <= UINT32_MAX);
+    state.triangle_list.resize(triangles_count);
+    parallel_for((triangles_count + kRaster_SetupChunk - 1) / kRaster_SetupChunk, [&](std::size_t chunk)
+    {
+        const std::size_t begin = (chunk * kRaster_SetupChunk);
+        const std::size_t end = (std::min)(begin + kRaster_SetupChunk, triangles_count);
+        std::size_t cmd_index = std::size_t(std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin() - 1);
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            while (i >= offsets[cmd_index + 1])
+                ++cmd_index; // Skip commands without triangles.
+            Raster_SetupTriangle(state.triangle_list[i]
+                , state.cmd_list[cmd_index]
+                , std::uint32_t(cmd_index)
+                , (i - offsets[cmd_index])
+                , target);
+        }
+    });
+
+    // Binning: every row of tiles is filled by own task, in triangles order.
+    const int tiles_x = ((target.size.width + kRaster_TileSize - 1) / kRaster_TileSize);
+    const int tiles_y = ((target.size.height + kRaster_TileSize - 1) / kRaster_TileSize);
+    state.tile_bins.resize(std::size_t(tiles_x) * std::size_t(tiles_y));
+    auto tile_rect = [&](int tile_x, int tile_y, int& x0, int& y0, int& x1, int& y1)
+    {
+        x0 = (tile_x * kRaster_TileSize);
+        y0 = (tile_y * kRaster_TileSize);
+        x1 = (std::min)(x0 + kRaster_TileSize, target.size.width);
+        y1 = (std::min)(y0 + kRaster_TileSize, target.size.height);
+    };
+    parallel_for(std::size_t(tiles_y), [&](std::size_t tile_y)
+    {
+        std::vector<std::uint32_t>* bins = &state.tile_bins[tile_y * tiles_x];
+        for (int tile_x = 0; tile_x < tiles_x; ++tile_x)
+            bins[tile_x].clear();
+        int x0 = 0;
+        int y0 = 0;
+        int x1 = 0;
+        int y1 = 0;
+        tile_rect(0, int(tile_y), x0, y0, x1, y1);
+        const int row_y0 = y0;
+        const int row_y1 = y1;
+        for (std::size_t i = 0; i < triangles_count; ++i)
+        {
+            const Raster_Triangle& t = state.triangle_list[i];
+            if ((t.x0 >= t.x1) || (t.y0 >= row_y1) || (t.y1 <= row_y0))
+                continue;
+            for (int tile_x = (t.x0 / kRaster_TileSize); tile_x <= ((t.x1 - 1) / kRaster_TileSize); ++tile_x)
+            {
+                tile_rect(tile_x, int(tile_y), x0, y0, x1, y1);
+                if (Raster_TriangleMissesRect(t
+                    , (std::max)(x0, t.x0), (std::max)(y0, t.y0)
+                    , (std::min)(x1, t.x1), (std::min)(y1, t.y1)))
+                {
+                    continue;
+                }
+                bins[tile_x].push_back(std::uint32_t(i));
+            }
+        }
+    });
+
+    parallel_for(state.tile_bins.size(), [&](std::size_t tile)
+    {
+        int x0 = 0;
+        int y0 = 0;
+        int x1 = 0;
+        int y1 = 0;
+        tile_rect(int(tile % tiles_x), int(tile / tiles_x), x0, y0, x1, y1);
+        for (std::uint32_t i : state.tile_bins[tile])
+        {
+            const Raster_Triangle& t = state.triangle_list[i];
+            Raster_TriangleRect(t
+                , state.cmd_list[t.cmd_index].texture
+                , target
+                , (std::max)(x0, t.x0), (std::max)(y0, t.y0)
+                , (std::min)(x1, t.x1), (std::min)(y1, t.y1));
+        }
+    });
+}
+
+} // namespace kr
+#endif
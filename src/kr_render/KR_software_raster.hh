@@ -0,0 +1,91 @@
+#pragma once
+#include "KR_kids_render.hh"
+
+#if (KK_RENDER_SOFTWARE())
+#include <vector>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+
+namespace kr
+{
+
+// Screen is split into square tiles; every tile is rasterized
+// by single thread, in DrawCmd order, so blending needs no locks.
+inline constexpr int kRaster_TileSize = 64;
+
+struct Raster_Texture
+{
+    const kk::Color* pixels = nullptr; // RGBA8, see ImageRef::pixels().
+    int width = 0;
+    int height = 0;
+};
+
+// DrawCmd, resolved to what rasterizer needs.
+struct Raster_Cmd
+{
+    const Vertex* vertices = nullptr; // Base vertex.
+    const Index* indices = nullptr;
+    std::size_t index_count = 0;
+    kk::Vec2f scale{1.f, 1.f};
+    kk::Point2f translate{};
+    kk::Rect clip{}; // In pixels.
+    Raster_Texture texture{};
+};
+
+struct Raster_Target
+{
+    kk::Color* pixels = nullptr; // RGBA8, top row first.
+    kk::Size size{};
+    std::size_t stride = 0; // In pixels.
+};
+
+// Set up once, read by every tile it overlaps.
+struct Raster_Triangle
+{
+    // Edge i: E(x, y) = a * (x - x0) + b * (y - y0); pixel is covered
+    // when E >= 0 for all edges (E > 0 for edges that are not top-left,
+    // so pixels on edges shared by 2 triangles are drawn once).
+    float edge_a[3];
+    float edge_b[3];
+    float edge_x[3];
+    float edge_y[3];
+    bool edge_inclusive[3];
+    // Attribute: f(x, y) = f0 + fx * (x - origin_x) + fy * (y - origin_y);
+    // u, v, r, g, b, a (color is normalized to [0; 1]).
+    float origin_x;
+    float origin_y;
+    float attr_0[6];
+    float attr_x[6];
+    float attr_y[6];
+    // Pixels [x0; x1) x [y0; y1), already clipped. Empty for culled triangles.
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+    std::uint32_t cmd_index;
+    // Texture is sampled; 1x1 textures are applied to vertex colors instead.
+    bool textured;
+    // Same color everywhere: it's in attr_0, gradients are unused.
+    bool flat;
+};
+
+// Scratch memory, reused by every Raster_Draw().
+struct Raster_State
+{
+    std::vector<Raster_Cmd> cmd_list;
+    std::vector<std::size_t> cmd_triangle_offsets; // Prefix sums of triangles count.
+    std::vector<Raster_Triangle> triangle_list;
+    std::vector<std::vector<std::uint32_t>> tile_bins; // Triangle indices, in order.
+};
+
+// Blends triangles of `state.cmd_list` into `target`: src * a + dst * (1 - a),
+// alpha is a + dst.a * (1 - a); OpenGL and Vulkan blend state matches it.
+// Triangle setup, binning and tiles are spread over `thread_pool`,
+// when given; everything runs on the calling thread otherwise.
+void Raster_Draw(Raster_State& state
+    , const Raster_Target& target
+    , kk::ThreadPool* thread_pool);
+
+} // namespace kr
+#endif
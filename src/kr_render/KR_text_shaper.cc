@@ -123,6 +123,7 @@ bool Text_Shaper::line_is_wrap_required(const Text_ShaperLine& line) const
 void Text_Shaper::text_add(const Text_UTF8& text_utf8, const Text_Markup& markup)
 {
     KK_VERIFY(!finished_);
+    ProfileScope profile_scope{render_, ProfileStage::Shape};
 
     // Empty text adds initial line anyway.
     // Otherwise, "metrics" does not make much sense.
@@ -292,6 +293,7 @@ void Text_Shaper::text_add_codepoint(std::uint32_t codepoint
 void Text_Shaper::finish()
 {
     KK_VERIFY(!finished_);
+    ProfileScope profile_scope{render_, ProfileStage::Shape};
     KK_VERIFY(line_list_.size() > 0);
     finished_ = true;
     Text_ShaperLine& last_line = line_list_.back();
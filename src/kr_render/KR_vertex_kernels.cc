@@ -0,0 +1,241 @@
+#include "KR_vertex_kernels.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#  define KK_SIMD_X64() 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  endif
+#else
+#  define KK_SIMD_X64() 0
+#endif
+
+// MSVC allows any intrinsic anywhere; GCC/Clang need a per-function target.
+#if (KK_SIMD_X64()) && (defined(__clang__) || defined(__GNUC__))
+#  define KK_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define KK_TARGET_AVX2
+#endif
+
+namespace kr
+{
+
+static_assert(sizeof(Vertex) == (5 * sizeof(float)));
+static_assert(offsetof(Vertex, p_) == 0);
+static_assert(sizeof(Index) == 2);
+
+static void Vertices_Translate_Scalar(Vertex* dst
+    , const Vertex* src
+    , std::size_t count
+    , const kk::Vec2f& translate)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Vertex& v = dst[i];
+        v = src[i];
+        v.p_.x += translate.x;
+        v.p_.y += translate.y;
+    }
+}
+
+static void Indices_Rebase_Scalar(Index* dst
+    , const Index* src
+    , std::size_t count
+    , Index rebase)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        dst[i] = Index(src[i] + rebase);
+}
+
+#if (KK_SIMD_X64())
+// Vertex is 5 floats (color bits count as one); N vertices are handled
+// as a batch of 5 registers (LCM of 5 and lanes count). Addition is done
+// for every lane, but only position lanes are taken: adding 0 to color
+// bits could change them (NaN patterns).
+template<unsigned kLanes>
+struct VertexBatchPattern
+{
+    static constexpr unsigned kFloats = (5 * kLanes);
+    alignas(32) float add[kFloats]{};
+    alignas(32) std::uint32_t mask[kFloats]{};
+
+    explicit VertexBatchPattern(const kk::Vec2f& translate)
+    {
+        for (unsigned i = 0; i < kFloats; ++i)
+        {
+            const unsigned field = (i % 5);
+            add[i] = (field == 0) ? translate.x : ((field == 1) ? translate.y : 0.f);
+            mask[i] = (field < 2) ? 0xffffffffu : 0u;
+        }
+    }
+};
+
+static void Vertices_Translate_SSE2(Vertex* dst
+    , const Vertex* src
+    , std::size_t count
+    , const kk::Vec2f& translate)
+{
+    const VertexBatchPattern<4> pattern(translate);
+#define KK_LOAD_PATTERN(K) \
+    const __m128 add##K = _mm_load_ps(pattern.add + 4 * K); \
+    const __m128 mask##K = _mm_castsi128_ps(_mm_load_si128( \
+        reinterpret_cast<const __m128i*>(pattern.mask + 4 * K)))
+    KK_LOAD_PATTERN(0); KK_LOAD_PATTERN(1); KK_LOAD_PATTERN(2); KK_LOAD_PATTERN(3); KK_LOAD_PATTERN(4);
+#undef KK_LOAD_PATTERN
+
+    std::size_t i = 0;
+    for (; (i + 4) <= count; i += 4)
+    {
+        const float* s = reinterpret_cast<const float*>(src + i);
+        float* d = reinterpret_cast<float*>(dst + i);
+#define KK_TRANSLATE(K) do { \
+        const __m128 v = _mm_loadu_ps(s + 4 * K); \
+        const __m128 t = _mm_add_ps(v, add##K); \
+        _mm_storeu_ps(d + 4 * K, _mm_or_ps(_mm_and_ps(mask##K, t), _mm_andnot_ps(mask##K, v))); \
+    } while (false)
+        KK_TRANSLATE(0); KK_TRANSLATE(1); KK_TRANSLATE(2); KK_TRANSLATE(3); KK_TRANSLATE(4);
+#undef KK_TRANSLATE
+    }
+    Vertices_Translate_Scalar(dst + i, src + i, count - i, translate);
+}
+
+KK_TARGET_AVX2 static void Vertices_Translate_AVX2(Vertex* dst
+    , const Vertex* src
+    , std::size_t count
+    , const kk::Vec2f& translate)
+{
+    const VertexBatchPattern<8> pattern(translate);
+#define KK_LOAD_PATTERN(K) \
+    const __m256 add##K = _mm256_load_ps(pattern.add + 8 * K); \
+    const __m256 mask##K = _mm256_castsi256_ps(_mm256_load_si256( \
+        reinterpret_cast<const __m256i*>(pattern.mask + 8 * K)))
+    KK_LOAD_PATTERN(0); KK_LOAD_PATTERN(1); KK_LOAD_PATTERN(2); KK_LOAD_PATTERN(3); KK_LOAD_PATTERN(4);
+#undef KK_LOAD_PATTERN
+
+    std::size_t i = 0;
+    for (; (i + 8) <= count; i += 8)
+    {
+        const float* s = reinterpret_cast<const float*>(src + i);
+        float* d = reinterpret_cast<float*>(dst + i);
+#define KK_TRANSLATE(K) do { \
+        const __m256 v = _mm256_loadu_ps(s + 8 * K); \
+        _mm256_storeu_ps(d + 8 * K, _mm256_blendv_ps(v, _mm256_add_ps(v, add##K), mask##K)); \
+    } while (false)
+        KK_TRANSLATE(0); KK_TRANSLATE(1); KK_TRANSLATE(2); KK_TRANSLATE(3); KK_TRANSLATE(4);
+#undef KK_TRANSLATE
+    }
+    Vertices_Translate_SSE2(dst + i, src + i, count - i, translate);
+}
+
+static void Indices_Rebase_SSE2(Index* dst
+    , const Index* src
+    , std::size_t count
+    , Index rebase)
+{
+    const __m128i add = _mm_set1_epi16(short(rebase));
+    std::size_t i = 0;
+    for (; (i + 8) <= count; i += 8)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi16(v, add));
+    }
+    Indices_Rebase_Scalar(dst + i, src + i, count - i, rebase);
+}
+
+KK_TARGET_AVX2 static void Indices_Rebase_AVX2(Index* dst
+    , const Index* src
+    , std::size_t count
+    , Index rebase)
+{
+    const __m256i add = _mm256_set1_epi16(short(rebase));
+    std::size_t i = 0;
+    for (; (i + 16) <= count; i += 16)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi16(v, add));
+    }
+    Indices_Rebase_SSE2(dst + i, src + i, count - i, rebase);
+}
+
+static bool CPU_HasAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4]{};
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    const bool os_saves_ymm = ((info[2] & (1 << 27)) != 0) // OSXSAVE.
+        && ((info[2] & (1 << 28)) != 0)                    // AVX.
+        && ((_xgetbv(0) & 0x6) == 0x6);                    // XMM and YMM state.
+    if (!os_saves_ymm)
+        return false;
+    __cpuidex(info, 7, 0);
+    return ((info[1] & (1 << 5)) != 0);
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+SimdLevel Simd_BestLevel()
+{
+#if (KK_SIMD_X64())
+    static const SimdLevel level = CPU_HasAVX2()
+        ? SimdLevel::AVX2
+        : SimdLevel::SSE2; // Always there on x64.
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const char* Simd_LevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar: return "Scalar";
+    case SimdLevel::SSE2: return "SSE2";
+    case SimdLevel::AVX2: return "AVX2";
+    }
+    KK_UNREACHABLE();
+    return "";
+}
+
+void Vertices_Translate(Vertex* dst
+    , const Vertex* src
+    , std::size_t count
+    , const kk::Vec2f& translate
+    , SimdLevel level /*= Simd_BestLevel()*/)
+{
+    level = (std::min)(level, Simd_BestLevel());
+#if (KK_SIMD_X64())
+    if (level == SimdLevel::AVX2)
+        return Vertices_Translate_AVX2(dst, src, count, translate);
+    if (level == SimdLevel::SSE2)
+        return Vertices_Translate_SSE2(dst, src, count, translate);
+#endif
+    Vertices_Translate_Scalar(dst, src, count, translate);
+}
+
+void Indices_Rebase(Index* dst
+    , const Index* src
+    , std::size_t count
+    , Index rebase
+    , SimdLevel level /*= Simd_BestLevel()*/)
+{
+    level = (std::min)(level, Simd_BestLevel());
+#if (KK_SIMD_X64())
+    if (level == SimdLevel::AVX2)
+        return Indices_Rebase_AVX2(dst, src, count, rebase);
+    if (level == SimdLevel::SSE2)
+        return Indices_Rebase_SSE2(dst, src, count, rebase);
+#endif
+    Indices_Rebase_Scalar(dst, src, count, rebase);
+}
+
+} // namespace kr
@@ -0,0 +1,37 @@
+#pragma once
+#include "KR_kids_render.hh"
+
+#include <cstddef>
+
+namespace kr
+{
+
+enum class SimdLevel
+{
+    Scalar,
+    SSE2,
+    AVX2,
+};
+
+// Best level supported by the CPU we run on; checked once.
+SimdLevel Simd_BestLevel();
+const char* Simd_LevelName(SimdLevel level);
+
+// Hot loops of CmdList merging. `level` is clamped to Simd_BestLevel().
+// `dst` and `src` must not overlap.
+
+// dst[i] = src[i], with position moved by `translate`. UVs and color bits are kept as-is.
+void Vertices_Translate(Vertex* dst
+    , const Vertex* src
+    , std::size_t count
+    , const kk::Vec2f& translate
+    , SimdLevel level = Simd_BestLevel());
+
+// dst[i] = src[i] + rebase; wraps around as uint16 math does.
+void Indices_Rebase(Index* dst
+    , const Index* src
+    , std::size_t count
+    , Index rebase
+    , SimdLevel level = Simd_BestLevel());
+
+} // namespace kr
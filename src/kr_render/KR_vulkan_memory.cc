@@ -0,0 +1,227 @@
+#include "KR_vulkan_memory.hh"
+
+#if (KK_RENDER_VULKAN())
+#include <algorithm>
+
+namespace kr
+{
+
+struct VulkanMemory_Range
+{
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+};
+
+struct VulkanMemory_Block
+{
+    VkDeviceMemory memory{};
+    VkDeviceSize size = 0;
+    std::uint8_t* mapped = nullptr;
+    std::uint32_t memory_type = 0;
+    VulkanMemory_Kind kind = VulkanMemory_Kind::Buffer;
+    bool dedicated = false;
+    std::vector<VulkanMemory_Range> free_list; // Sorted by offset.
+    std::size_t allocation_count = 0;
+    VkDeviceSize used_bytes = 0;
+    VkDeviceSize wasted_bytes = 0;
+};
+
+static VkDeviceSize VulkanMemory_AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    KK_VERIFY(alignment > 0);
+    return ((value + alignment - 1) / alignment) * alignment;
+}
+
+static std::uint32_t VulkanMemory_FindType(const VkPhysicalDeviceMemoryProperties& memory_properties
+    , VkMemoryPropertyFlags properties
+    , std::uint32_t type_bits)
+{
+    for (std::uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    {
+        if ((memory_properties.memoryTypes[i].propertyFlags & properties) == properties
+            && (type_bits & (1u << i)))
+        {
+            return i;
+        }
+    }
+    KK_VERIFY(false);
+    return 0xffffffff;
+}
+
+static void VulkanMemory_FreeBlock(VkDevice device, VulkanMemory_Block& block)
+{
+    if (block.mapped)
+        vkUnmapMemory(device, block.memory);
+    vkFreeMemory(device, block.memory, nullptr);
+}
+
+// First fit. Padding in front of the aligned offset stays part of the range,
+// so free() returns it back as a whole.
+static bool VulkanMemory_TryAllocate(VulkanMemory_Block& block
+    , const VkMemoryRequirements& requirements
+    , VulkanMemory_Allocation& allocation)
+{
+    for (std::size_t i = 0; i < block.free_list.size(); ++i)
+    {
+        VulkanMemory_Range& range = block.free_list[i];
+        const VkDeviceSize offset = VulkanMemory_AlignUp(range.offset, requirements.alignment);
+        const VkDeviceSize end = (offset + requirements.size);
+        if (end > (range.offset + range.size))
+            continue;
+
+        allocation.memory = block.memory;
+        allocation.offset = offset;
+        allocation.size = requirements.size;
+        allocation.mapped = block.mapped ? (block.mapped + offset) : nullptr;
+        allocation.block = &block;
+        allocation.range_offset = range.offset;
+        allocation.range_size = (end - range.offset);
+
+        block.allocation_count += 1;
+        block.used_bytes += requirements.size;
+        block.wasted_bytes += (offset - range.offset);
+
+        range.size -= allocation.range_size;
+        range.offset = end;
+        if (range.size == 0)
+            block.free_list.erase(block.free_list.begin() + i);
+        return true;
+    }
+    return false;
+}
+
+VulkanMemory::VulkanMemory(VkPhysicalDevice physical_device
+    , VkDevice device
+    , VkDeviceSize block_size)
+    : device_(device)
+    , block_size_(block_size)
+    , memory_properties_()
+    , block_list_()
+{
+    KK_VERIFY(block_size_ > 0);
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties_);
+}
+
+VulkanMemory::~VulkanMemory() noexcept
+{
+    for (const std::unique_ptr<VulkanMemory_Block>& block : block_list_)
+    {
+        KK_VERIFY(block->allocation_count == 0);
+        VulkanMemory_FreeBlock(device_, *block);
+    }
+}
+
+VulkanMemory_Allocation VulkanMemory::allocate(const VkMemoryRequirements& requirements
+    , VkMemoryPropertyFlags properties
+    , VulkanMemory_Kind kind)
+{
+    KK_VERIFY(requirements.size > 0);
+    const std::uint32_t memory_type = VulkanMemory_FindType(memory_properties_
+        , properties, requirements.memoryTypeBits);
+
+    VulkanMemory_Allocation allocation{};
+    const bool dedicated = (requirements.size > (block_size_ / 2));
+    if (!dedicated)
+    {
+        for (const std::unique_ptr<VulkanMemory_Block>& block : block_list_)
+        {
+            if ((block->memory_type != memory_type) || (block->kind != kind) || block->dedicated)
+                continue;
+            if (VulkanMemory_TryAllocate(*block, requirements, allocation))
+                return allocation;
+        }
+    }
+
+    std::unique_ptr<VulkanMemory_Block> block = std::make_unique<VulkanMemory_Block>();
+    block->size = dedicated ? requirements.size : block_size_;
+    block->memory_type = memory_type;
+    block->kind = kind;
+    block->dedicated = dedicated;
+    block->free_list.push_back(VulkanMemory_Range{0, block->size});
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = block->size;
+    alloc_info.memoryTypeIndex = memory_type;
+    KK_VERIFY(vkAllocateMemory(device_, &alloc_info, nullptr, &block->memory) == VK_SUCCESS);
+    if (memory_properties_.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        void* mapped = nullptr;
+        KK_VERIFY(vkMapMemory(device_, block->memory, 0, VK_WHOLE_SIZE, 0, &mapped) == VK_SUCCESS);
+        block->mapped = static_cast<std::uint8_t*>(mapped);
+    }
+
+    // Block offset 0 satisfies any alignment.
+    KK_VERIFY(VulkanMemory_TryAllocate(*block, requirements, allocation));
+    block_list_.push_back(std::move(block));
+    return allocation;
+}
+
+void VulkanMemory::free(VulkanMemory_Allocation& allocation)
+{
+    VulkanMemory_Block* block = allocation.block;
+    if (!block)
+        return;
+    KK_VERIFY(block->allocation_count > 0);
+    block->allocation_count -= 1;
+    block->used_bytes -= allocation.size;
+    block->wasted_bytes -= (allocation.range_size - allocation.size);
+
+    std::vector<VulkanMemory_Range>& free_list = block->free_list;
+    auto it = std::lower_bound(free_list.begin(), free_list.end(), allocation.range_offset
+        , [](const VulkanMemory_Range& range, VkDeviceSize offset)
+    {
+        return (range.offset < offset);
+    });
+    it = free_list.insert(it, VulkanMemory_Range{allocation.range_offset, allocation.range_size});
+    // Merge with next, then with previous.
+    if (((it + 1) != free_list.end()) && ((it->offset + it->size) == (it + 1)->offset))
+    {
+        it->size += (it + 1)->size;
+        free_list.erase(it + 1);
+    }
+    if ((it != free_list.begin()) && (((it - 1)->offset + (it - 1)->size) == it->offset))
+    {
+        (it - 1)->size += it->size;
+        free_list.erase(it);
+    }
+    allocation = VulkanMemory_Allocation{};
+
+    if (block->allocation_count > 0)
+        return;
+    const bool keep = !block->dedicated
+        && std::none_of(block_list_.begin(), block_list_.end()
+            , [block](const std::unique_ptr<VulkanMemory_Block>& other)
+        {
+            return (other.get() != block)
+                && (other->allocation_count == 0)
+                && !other->dedicated
+                && (other->memory_type == block->memory_type)
+                && (other->kind == block->kind);
+        });
+    if (keep)
+        return;
+    VulkanMemory_FreeBlock(device_, *block);
+    block_list_.erase(std::find_if(block_list_.begin(), block_list_.end()
+        , [block](const std::unique_ptr<VulkanMemory_Block>& other)
+    {
+        return (other.get() == block);
+    }));
+}
+
+VulkanMemory_Stats VulkanMemory::stats() const
+{
+    VulkanMemory_Stats stats{};
+    stats.block_count = block_list_.size();
+    for (const std::unique_ptr<VulkanMemory_Block>& block : block_list_)
+    {
+        stats.allocation_count += block->allocation_count;
+        stats.block_bytes += block->size;
+        stats.used_bytes += block->used_bytes;
+        stats.wasted_bytes += block->wasted_bytes;
+    }
+    return stats;
+}
+
+} // namespace kr
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+#include "KR_kids_config.hh"
+
+#if (KK_RENDER_VULKAN())
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace kr
+{
+
+struct VulkanMemory_Block;
+
+// Aligned sub-range of VkDeviceMemory block, see VulkanMemory::allocate().
+struct VulkanMemory_Allocation
+{
+    VkDeviceMemory memory{};
+    VkDeviceSize offset = 0; // To bind buffer/image at.
+    VkDeviceSize size = 0;
+    // Host-visible blocks are mapped once, for their lifetime; points at `offset`.
+    void* mapped = nullptr;
+// private:
+    VulkanMemory_Block* block = nullptr;
+    VkDeviceSize range_offset = 0; // Including alignment padding.
+    VkDeviceSize range_size = 0;
+};
+
+struct VulkanMemory_Stats
+{
+    std::size_t block_count = 0;
+    std::size_t allocation_count = 0;
+    VkDeviceSize block_bytes = 0;  // Total vkAllocateMemory() size.
+    VkDeviceSize used_bytes = 0;   // Requested by allocations.
+    VkDeviceSize wasted_bytes = 0; // Alignment padding.
+    // Free: (block_bytes - used_bytes - wasted_bytes).
+};
+
+enum class VulkanMemory_Kind
+{
+    // Buffers and optimal-tiling images never share a block,
+    // so there is no need to care about bufferImageGranularity.
+    Buffer,
+    Image,
+};
+
+// Hands out ranges of few big vkAllocateMemory() blocks
+// (first fit; freed ranges are merged with neighbours).
+// Requests bigger than half of the block get block of their own.
+// Empty blocks are freed, except one per memory type/kind, to not thrash.
+// Shared by KidsRender and ImageRefs, which may outlive the render.
+struct VulkanMemory
+{
+    static constexpr VkDeviceSize kDefaultBlockSize = (16 * 1024 * 1024);
+
+    explicit VulkanMemory(VkPhysicalDevice physical_device
+        , VkDevice device
+        , VkDeviceSize block_size = kDefaultBlockSize);
+    ~VulkanMemory() noexcept;
+    VulkanMemory(const VulkanMemory&) = delete;
+    VulkanMemory& operator=(const VulkanMemory&) = delete;
+    VulkanMemory(VulkanMemory&&) = delete;
+    VulkanMemory& operator=(VulkanMemory&&) = delete;
+
+    VulkanMemory_Allocation allocate(const VkMemoryRequirements& requirements
+        , VkMemoryPropertyFlags properties
+        , VulkanMemory_Kind kind);
+    // Resets `allocation`; no-op for empty one.
+    void free(VulkanMemory_Allocation& allocation);
+
+    VulkanMemory_Stats stats() const;
+
+// private:
+    VkDevice device_{};
+    VkDeviceSize block_size_ = 0;
+    VkPhysicalDeviceMemoryProperties memory_properties_{};
+    std::vector<std::unique_ptr<VulkanMemory_Block>> block_list_;
+};
+
+} // namespace kr
+#endif
@@ -0,0 +1,97 @@
+#include "KS_thread_pool.hh"
+#include "KS_asserts.hh"
+
+namespace kk
+{
+
+ThreadPool::ThreadPool(unsigned workers_count)
+{
+    workers_.reserve(workers_count);
+    for (unsigned i = 0; i < workers_count; ++i)
+        workers_.emplace_back([this]() { worker_loop(); });
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_)
+        worker.join();
+}
+
+/*static*/ unsigned ThreadPool::DefaultWorkersCount()
+{
+    const unsigned count = std::thread::hardware_concurrency();
+    return (count > 1) ? (count - 1) : 0;
+}
+
+void ThreadPool::run_tasks(const std::function<void (std::size_t)>& task, std::size_t count)
+{
+    for (std::size_t i = next_.fetch_add(1); i < count; i = next_.fetch_add(1))
+        task(i);
+}
+
+void ThreadPool::worker_loop()
+{
+    std::uint64_t seen_generation = 0;
+    while (true)
+    {
+        const std::function<void (std::size_t)>* task = nullptr;
+        std::size_t count = 0;
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [&]() { return stop_ || (generation_ != seen_generation); });
+            if (stop_)
+                return;
+            seen_generation = generation_;
+            if (!task_)
+                continue; // Woke up too late, parallel_for() is done.
+            task = task_;
+            count = count_;
+            ++active_;
+        }
+
+        run_tasks(*task, count);
+
+        {
+            std::lock_guard lock(mutex_);
+            --active_;
+        }
+        done_.notify_one();
+    }
+}
+
+void ThreadPool::parallel_for(std::size_t count, const std::function<void (std::size_t)>& task)
+{
+    if (count == 0)
+        return;
+    if (workers_.empty() || (count == 1))
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    {
+        std::unique_lock lock(mutex_);
+        // Late worker from the previous call may still be around.
+        done_.wait(lock, [&]() { return (active_ == 0); });
+        task_ = &task;
+        count_ = count;
+        next_.store(0);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    run_tasks(task, count);
+
+    std::unique_lock lock(mutex_);
+    // All indices are taken; wait for the ones still running.
+    done_.wait(lock, [&]() { return (active_ == 0); });
+    task_ = nullptr;
+}
+
+} // namespace kk
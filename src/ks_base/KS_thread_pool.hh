@@ -0,0 +1,54 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace kk
+{
+
+// Fixed set of worker threads for fork-join loops.
+// Calling thread takes part in the work, so ThreadPool(0) runs everything inline.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned workers_count = DefaultWorkersCount());
+    ~ThreadPool() noexcept;
+    ThreadPool(ThreadPool&& rhs) noexcept = delete;
+    ThreadPool(const ThreadPool&) noexcept = delete;
+    ThreadPool& operator=(const ThreadPool&) noexcept = delete;
+    ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+    // Hardware threads minus the calling one.
+    static unsigned DefaultWorkersCount();
+
+    unsigned workers_count() const { return unsigned(workers_.size()); }
+
+    // Calls task(i) for every i in [0; count), returns once all are done.
+    // Not reentrant: do not call from within a task.
+    void parallel_for(std::size_t count, const std::function<void (std::size_t)>& task);
+
+private:
+    void worker_loop();
+    void run_tasks(const std::function<void (std::size_t)>& task, std::size_t count);
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    // Guarded by mutex_.
+    const std::function<void (std::size_t)>* task_ = nullptr;
+    std::size_t count_ = 0;
+    std::uint64_t generation_ = 0;
+    unsigned active_ = 0;
+    bool stop_ = false;
+    // Next task index to pick.
+    std::atomic<std::size_t> next_{0};
+};
+
+} // namespace kk